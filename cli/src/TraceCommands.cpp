@@ -0,0 +1,79 @@
+/*
+ * TraceCommands.cpp - implementation of TraceCommands class
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QFile>
+
+#include "CommandLineIO.h"
+#include "TraceCommands.h"
+#include "Tracer.h"
+
+
+TraceCommands::TraceCommands( QObject* parent ) :
+	QObject( parent ),
+	m_commands( {
+		{ QStringLiteral("convert"), tr( "Convert trace file to Chrome trace event format (JSON)" ) },
+		} )
+{
+}
+
+
+
+QStringList TraceCommands::commands() const
+{
+	return m_commands.keys();
+}
+
+
+
+QString TraceCommands::commandHelp( const QString& command ) const
+{
+	return m_commands.value( command );
+}
+
+
+
+CommandLinePluginInterface::RunResult TraceCommands::handle_convert( const QStringList& arguments )
+{
+	if( arguments.isEmpty() )
+	{
+		return NotEnoughArguments;
+	}
+
+	const auto traceFileName = arguments.value( 0 );
+	if( QFile::exists( traceFileName ) == false )
+	{
+		CommandLineIO::error( tr( "File \"%1\" does not exist!" ).arg( traceFileName ) );
+		return Failed;
+	}
+
+	const auto outputFileName = arguments.value( 1, traceFileName + QStringLiteral(".json") );
+
+	if( Tracer::convertToChromeTrace( traceFileName, outputFileName ) == false )
+	{
+		CommandLineIO::error( tr( "Could not convert trace file \"%1\"!" ).arg( traceFileName ) );
+		return Failed;
+	}
+
+	return Successful;
+}
@@ -33,6 +33,7 @@
 #include "PluginManager.h"
 #include "ServiceControlCommands.h"
 #include "ShellCommands.h"
+#include "TraceCommands.h"
 
 
 int main( int argc, char **argv )
@@ -90,6 +91,7 @@ int main( int argc, char **argv )
 	VeyonCore::pluginManager().registerExtraPluginInterface( new PluginCommands( core ) );
 	VeyonCore::pluginManager().registerExtraPluginInterface( new ServiceControlCommands( core ) );
 	VeyonCore::pluginManager().registerExtraPluginInterface( new ShellCommands( core ) );
+	VeyonCore::pluginManager().registerExtraPluginInterface( new TraceCommands( core ) );
 
 	QHash<CommandLinePluginInterface *, QObject *> commandLinePluginInterfaces;
 	const auto pluginObjects = VeyonCore::pluginManager().pluginObjects();
@@ -0,0 +1,11 @@
+# BuildVeyonTest.cmake - Copyright (c) 2024 Tobias Junghans
+#
+# description: build unit test or benchmark for Veyon component
+# usage: build_veyon_test(<NAME> <SOURCES>)
+
+macro(build_veyon_test TEST_NAME)
+	add_executable(${TEST_NAME} ${ARGN})
+	set_default_target_properties(${TEST_NAME})
+	target_link_libraries(${TEST_NAME} veyon-core Qt${QT_MAJOR_VERSION}::Test)
+	add_test(NAME ${TEST_NAME} COMMAND ${TEST_NAME})
+endmacro()
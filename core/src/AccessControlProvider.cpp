@@ -51,6 +51,8 @@ AccessControlProvider::AccessControlProvider() :
 	{
 		m_accessControlRules.append( AccessControlRule( accessControlRule ) );
 	}
+
+	m_decisionCacheTimer.start();
 }
 
 
@@ -133,12 +135,43 @@ AccessControlProvider::Access AccessControlProvider::checkAccess( const QString&
 	}
 	else if( VeyonCore::config().isAccessControlRulesProcessingEnabled() )
 	{
-		auto action = processAccessControlRules( accessingUser,
-												 accessingComputer,
-												 VeyonCore::platform().userFunctions().currentUser(),
-												 HostAddress::localFQDN(),
-												 connectedUsers,
-												 authMethodUid );
+		const auto localUser = VeyonCore::platform().userFunctions().currentUser();
+		const auto localComputer = HostAddress::localFQDN();
+
+		const auto decisionCacheKey = QStringList{
+			accessingUser, accessingComputer, localUser, localComputer, authMethodUid.toString(),
+			connectedUsers.contains( accessingUser ) ? QStringLiteral("1") : QStringLiteral("0")
+		}.join( QChar::Null );
+
+		auto action = AccessControlRule::Action::None;
+
+		const auto decision = m_decisionCache.constFind( decisionCacheKey );
+		if( decision != m_decisionCache.constEnd() &&
+			m_decisionCacheTimer.elapsed() - decision->timestamp < DecisionCacheLifetime )
+		{
+			action = decision->action;
+		}
+		else
+		{
+			action = processAccessControlRules( accessingUser,
+												accessingComputer,
+												localUser,
+												localComputer,
+												connectedUsers,
+												authMethodUid );
+
+			// decisions depending on session or login states must not be reused, neither
+			// must decisions based on lookups which may have failed only temporarily
+			if( m_localState.isEmpty() && m_lookupFailed == false )
+			{
+				if( m_decisionCache.size() >= MaximumDecisionCacheSize )
+				{
+					m_decisionCache.clear();
+				}
+				m_decisionCache[decisionCacheKey] = { action, m_decisionCacheTimer.elapsed() };
+			}
+		}
+
 		switch( action )
 		{
 		case AccessControlRule::Action::Allow:
@@ -195,6 +228,8 @@ AccessControlRule::Action AccessControlProvider::processAccessControlRules( cons
 {
 	vDebug() << "processing rules for" << accessingUser << accessingComputer << localUser << localComputer << connectedUsers << authMethodUid;
 
+	resetEvaluationCache();
+
 	for( const auto& rule : std::as_const( m_accessControlRules ) )
 	{
 		// rule disabled?
@@ -228,10 +263,14 @@ bool AccessControlProvider::isAccessToLocalComputerDenied() const
 		return false;
 	}
 
+	resetEvaluationCache();
+
+	const auto localUser = VeyonCore::platform().userFunctions().currentUser();
+	const auto localComputer = HostAddress::localFQDN();
+
 	for( const auto& rule : std::as_const( m_accessControlRules ) )
 	{
-		if( matchConditions( rule, {}, {},
-							 VeyonCore::platform().userFunctions().currentUser(), HostAddress::localFQDN(), {}, {} ) )
+		if( matchConditions( rule, {}, {}, localUser, localComputer, {}, {} ) )
 		{
 			switch( rule.action() )
 			{
@@ -251,32 +290,141 @@ bool AccessControlProvider::isAccessToLocalComputerDenied() const
 
 
 
+bool AccessControlProvider::dependsOnConnectedUsers() const
+{
+	if( VeyonCore::config().isAccessRestrictedToUserGroups() ||
+		VeyonCore::config().isAccessControlRulesProcessingEnabled() == false )
+	{
+		return false;
+	}
+
+	for( const auto& rule : m_accessControlRules )
+	{
+		if( rule.action() != AccessControlRule::Action::None &&
+			rule.areConditionsIgnored() == false &&
+			rule.isConditionEnabled( AccessControlRule::Condition::AccessFromAlreadyConnectedUser ) )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+
+void AccessControlProvider::resetEvaluationCache() const
+{
+	m_groupsOfUser.clear();
+	m_locationsOfComputer.clear();
+	m_localState.clear();
+	m_lookupFailed = false;
+}
+
+
+
+QStringList AccessControlProvider::lookupGroupsOfUser( const QString& user ) const
+{
+	const auto it = m_groupsOfUser.constFind( user );
+	if( it != m_groupsOfUser.constEnd() )
+	{
+		return *it;
+	}
+
+	const auto groups = m_userGroupsBackend->groupsOfUser( user, m_useDomainUserGroups );
+	m_groupsOfUser[user] = groups;
+
+	// failed lookups (e.g. LDAP server not reachable) can't be distinguished from users without groups
+	m_lookupFailed |= groups.isEmpty();
+
+	return groups;
+}
+
+
+
+QStringList AccessControlProvider::lookupLocationsOfComputer( const QString& computer ) const
+{
+	const auto it = m_locationsOfComputer.constFind( computer );
+	if( it != m_locationsOfComputer.constEnd() )
+	{
+		return *it;
+	}
+
+	const auto locations = locationsOfComputer( computer );
+	m_locationsOfComputer[computer] = locations;
+
+	m_lookupFailed |= locations.isEmpty();
+
+	return locations;
+}
+
+
+
+bool AccessControlProvider::lookupLocalState( AccessControlRule::Condition condition ) const
+{
+	const auto it = m_localState.constFind( condition );
+	if( it != m_localState.constEnd() )
+	{
+		return *it;
+	}
+
+	bool state = false;
+
+	switch( condition )
+	{
+	case AccessControlRule::Condition::AccessedUserLoggedInLocally:
+		state = VeyonCore::platform().sessionFunctions().currentSessionIsRemote();
+		break;
+	case AccessControlRule::Condition::NoUserLoggedInLocally:
+		state = isNoUserLoggedInLocally();
+		break;
+	case AccessControlRule::Condition::NoUserLoggedInRemotely:
+		state = isNoUserLoggedInRemotely();
+		break;
+	case AccessControlRule::Condition::UserSession:
+		state = VeyonCore::platform().sessionFunctions().currentSessionHasUser();
+		break;
+	default:
+		break;
+	}
+
+	m_localState[condition] = state;
+
+	return state;
+}
+
+
+
 bool AccessControlProvider::isMemberOfUserGroup( const QString &user,
 												 const QString &groupName ) const
 {
-	const QRegularExpression groupNameRX( groupName );
+	auto groupNameRX = m_groupNameRegularExpressions.find( groupName );
+	if( groupNameRX == m_groupNameRegularExpressions.end() )
+	{
+		groupNameRX = m_groupNameRegularExpressions.insert( groupName, QRegularExpression( groupName ) );
+	}
 
-	if( groupNameRX.isValid() )
+	if( groupNameRX->isValid() )
 	{
-		return m_userGroupsBackend->groupsOfUser( user, m_useDomainUserGroups ).indexOf( groupNameRX ) >= 0;
+		return lookupGroupsOfUser( user ).indexOf( *groupNameRX ) >= 0;
 	}
 
-	return m_userGroupsBackend->groupsOfUser( user, m_useDomainUserGroups ).contains( groupName );
+	return lookupGroupsOfUser( user ).contains( groupName );
 }
 
 
 
 bool AccessControlProvider::isLocatedAt( const QString &computer, const QString &locationName ) const
 {
-	return locationsOfComputer( computer ).contains( locationName );
+	return lookupLocationsOfComputer( computer ).contains( locationName );
 }
 
 
 
 bool AccessControlProvider::haveGroupsInCommon( const QString &userOne, const QString &userTwo ) const
 {
-	const auto userOneGroups = m_userGroupsBackend->groupsOfUser( userOne, m_useDomainUserGroups );
-	const auto userTwoGroups = m_userGroupsBackend->groupsOfUser( userTwo, m_useDomainUserGroups );
+	const auto userOneGroups = lookupGroupsOfUser( userOne );
+	const auto userTwoGroups = lookupGroupsOfUser( userTwo );
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
 	const auto userOneGroupSet = QSet<QString>{ userOneGroups.begin(), userOneGroups.end() };
@@ -293,8 +441,8 @@ bool AccessControlProvider::haveGroupsInCommon( const QString &userOne, const QS
 
 bool AccessControlProvider::haveSameLocations( const QString &computerOne, const QString &computerTwo ) const
 {
-	const auto computerOneLocations = locationsOfComputer( computerOne );
-	const auto computerTwoLocations = locationsOfComputer( computerTwo );
+	const auto computerOneLocations = lookupLocationsOfComputer( computerOne );
+	const auto computerTwoLocations = lookupLocationsOfComputer( computerTwo );
 
 	return computerOneLocations.isEmpty() == false &&
 			computerOneLocations == computerTwoLocations;
@@ -456,7 +604,7 @@ bool AccessControlProvider::matchConditions( const AccessControlRule &rule,
 	{
 		condition = AccessControlRule::Condition::AccessedUserLoggedInLocally;
 
-		if( VeyonCore::platform().sessionFunctions().currentSessionIsRemote() == rule.isConditionInverted(condition) )
+		if( lookupLocalState( condition ) == rule.isConditionInverted(condition) )
 		{
 			return false;
 		}
@@ -466,7 +614,7 @@ bool AccessControlProvider::matchConditions( const AccessControlRule &rule,
 	{
 		condition = AccessControlRule::Condition::NoUserLoggedInLocally;
 
-		if( isNoUserLoggedInLocally() == rule.isConditionInverted(condition) )
+		if( lookupLocalState( condition ) == rule.isConditionInverted(condition) )
 		{
 			return false;
 		}
@@ -476,7 +624,7 @@ bool AccessControlProvider::matchConditions( const AccessControlRule &rule,
 	{
 		condition = AccessControlRule::Condition::NoUserLoggedInRemotely;
 
-		if( isNoUserLoggedInRemotely() == rule.isConditionInverted(condition) )
+		if( lookupLocalState( condition ) == rule.isConditionInverted(condition) )
 		{
 			return false;
 		}
@@ -486,7 +634,7 @@ bool AccessControlProvider::matchConditions( const AccessControlRule &rule,
 	{
 		condition = AccessControlRule::Condition::UserSession;
 
-		if( VeyonCore::platform().sessionFunctions().currentSessionHasUser() == rule.isConditionInverted(condition) )
+		if( lookupLocalState( condition ) == rule.isConditionInverted(condition) )
 		{
 			return false;
 		}
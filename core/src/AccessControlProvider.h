@@ -24,6 +24,9 @@
 
 #pragma once
 
+#include <QElapsedTimer>
+#include <QRegularExpression>
+
 #include "AccessControlRule.h"
 #include "NetworkObject.h"
 #include "Plugin.h"
@@ -40,6 +43,11 @@ public:
 		ToBeConfirmed,
 	} ;
 
+	// decisions are reused for this time without looking up group memberships and locations
+	// again, i.e. changes of these take effect with this delay at most
+	static constexpr int DecisionCacheLifetime = 10000;
+	static constexpr int MaximumDecisionCacheSize = 1024;
+
 	AccessControlProvider();
 
 	QStringList userGroups() const;
@@ -60,7 +68,20 @@ public:
 
 	bool isAccessToLocalComputerDenied() const;
 
+	bool dependsOnConnectedUsers() const;
+
 private:
+	struct Decision
+	{
+		AccessControlRule::Action action;
+		qint64 timestamp;
+	};
+
+	void resetEvaluationCache() const;
+	QStringList lookupGroupsOfUser( const QString& user ) const;
+	QStringList lookupLocationsOfComputer( const QString& computer ) const;
+	bool lookupLocalState( AccessControlRule::Condition condition ) const;
+
 	bool isMemberOfUserGroup( const QString& user, const QString& groupName ) const;
 	bool isLocatedAt( const QString& computer, const QString& locationName ) const;
 	bool haveGroupsInCommon( const QString& userOne, const QString& userTwo ) const;
@@ -87,4 +108,15 @@ private:
 	NetworkObjectDirectory* m_networkObjectDirectory;
 	bool m_useDomainUserGroups;
 
+	// results of rule processing keyed by all inputs except the local state
+	QHash<QString, Decision> m_decisionCache{};
+	QElapsedTimer m_decisionCacheTimer{};
+	mutable QHash<QString, QRegularExpression> m_groupNameRegularExpressions{};
+
+	// inputs of conditions fetched during the current evaluation
+	mutable QHash<QString, QStringList> m_groupsOfUser{};
+	mutable QHash<QString, QStringList> m_locationsOfComputer{};
+	mutable QMap<AccessControlRule::Condition, bool> m_localState{};
+	mutable bool m_lookupFailed{false};
+
 } ;
@@ -95,6 +95,16 @@ void ComputerControlInterface::start( QSize scaledFramebufferSize, UpdateMode up
 			++m_timestamp;
 			Q_EMIT scaledFramebufferUpdated();
 		} );
+		connect( vncConnection, &VncConnection::framebufferSizeChanged, this, [this]( int w, int h ) {
+			const QSize nativeSize{ w * m_framebufferScale, h * m_framebufferScale };
+			// ignore rounding differences of framebuffers scaled by the server
+			if( qAbs( nativeSize.width() - m_nativeFramebufferSize.width() ) >= m_framebufferScale ||
+				qAbs( nativeSize.height() - m_nativeFramebufferSize.height() ) >= m_framebufferScale )
+			{
+				m_nativeFramebufferSize = nativeSize;
+			}
+			updateFramebufferScale();
+		} );
 
 		connect( vncConnection, &VncConnection::stateChanged, this, &ComputerControlInterface::updateState );
 		connect(vncConnection, &VncConnection::stateChanged, this, &ComputerControlInterface::setMinimumFramebufferUpdateInterval);
@@ -164,6 +174,8 @@ void ComputerControlInterface::setScaledFramebufferSize( QSize scaledFramebuffer
 		vncConnection()->setScaledSize( m_scaledFramebufferSize );
 	}
 
+	updateFramebufferScale();
+
 	++m_timestamp;
 
 	Q_EMIT scaledFramebufferUpdated();
@@ -204,6 +216,7 @@ void ComputerControlInterface::setServerVersion(VeyonCore::ApplicationVersion ve
 	const auto statePollingInterval = VeyonCore::config().computerStatePollingInterval();
 
 	setQuality();
+	updateFramebufferScale();
 
 	if (m_serverVersion >= VeyonCore::ApplicationVersion::Version_4_7 &&
 		statePollingInterval <= 0)
@@ -305,6 +318,7 @@ void ComputerControlInterface::setUpdateMode( UpdateMode updateMode )
 
 	setMinimumFramebufferUpdateInterval();
 	setQuality();
+	updateFramebufferScale();
 
 	if (vncConnection())
 	{
@@ -427,6 +441,37 @@ void ComputerControlInterface::setQuality()
 
 
 
+void ComputerControlInterface::updateFramebufferScale()
+{
+	if (vncConnection() == nullptr || state() != State::Connected ||
+		m_serverVersion < VeyonCore::ApplicationVersion::Version_5_0)
+	{
+		return;
+	}
+
+	auto scale = 1;
+
+	// in thumbnail mode let the server send a framebuffer which is scaled down as
+	// far as possible while still being larger than the scaled framebuffer size
+	if (VeyonCore::config().computerMonitoringServerSideScaling() &&
+		(m_updateMode == UpdateMode::Basic || m_updateMode == UpdateMode::Monitoring) &&
+		m_scaledFramebufferSize.isEmpty() == false &&
+		m_nativeFramebufferSize.isEmpty() == false)
+	{
+		scale = qBound(1, qMin(m_nativeFramebufferSize.width() / m_scaledFramebufferSize.width(),
+							   m_nativeFramebufferSize.height() / m_scaledFramebufferSize.height()),
+					   MaximumFramebufferScale);
+	}
+
+	if (scale != m_framebufferScale)
+	{
+		m_framebufferScale = scale;
+		VeyonCore::builtinFeatures().monitoringMode().setFramebufferScale({weakPointer()}, scale);
+	}
+}
+
+
+
 void ComputerControlInterface::resetWatchdog()
 {
 	if( state() == State::Connected )
@@ -473,6 +518,12 @@ void ComputerControlInterface::updateState()
 		m_state = State::Disconnected;
 	}
 
+	// a new server connection always starts with an unscaled framebuffer
+	if( m_state != State::Connected )
+	{
+		m_framebufferScale = 1;
+	}
+
 	unlock();
 }
 
@@ -196,6 +196,7 @@ private:
 	void ping();
 	void setMinimumFramebufferUpdateInterval();
 	void setQuality();
+	void updateFramebufferScale();
 	void resetWatchdog();
 	void restartConnection();
 
@@ -212,6 +213,7 @@ private:
 	static constexpr int ConnectionWatchdogTimeout = ConnectionWatchdogPingDelay*2;
 	static constexpr int ServerVersionQueryTimeout = 5000;
 	static constexpr int UpdateIntervalDisabled = 5000;
+	static constexpr int MaximumFramebufferScale = 8;
 
 	const Computer m_computer;
 	const int m_port;
@@ -227,6 +229,8 @@ private:
 	Feature::Uid m_designatedModeFeature;
 
 	QSize m_scaledFramebufferSize{};
+	QSize m_nativeFramebufferSize{};
+	int m_framebufferScale{1};
 	int m_timestamp{0};
 
 	VeyonConnection* m_connection{nullptr};
@@ -24,6 +24,7 @@
 
 #include "FeatureManager.h"
 #include "FeatureMessage.h"
+#include "Tracer.h"
 #include "VariantArrayMessage.h"
 
 
@@ -31,6 +32,8 @@ bool FeatureMessage::send( QIODevice* ioDevice ) const
 {
 	if( ioDevice )
 	{
+		Tracer::Scope traceScope( Tracer::Event::FeatureMessageSend, m_featureUid.data1, m_command, m_arguments.size() );
+
 		VariantArrayMessage message( ioDevice );
 
 		message.write( m_featureUid );
@@ -59,6 +62,8 @@ bool FeatureMessage::receive( QIODevice* ioDevice )
 {
 	if( ioDevice != nullptr )
 	{
+		Tracer::Scope traceScope( Tracer::Event::FeatureMessageReceive );
+
 		VariantArrayMessage message( ioDevice );
 
 		if( message.receive() )
@@ -66,6 +71,7 @@ bool FeatureMessage::receive( QIODevice* ioDevice )
 			m_featureUid = message.read().toUuid(); // Flawfinder: ignore
 			m_command = message.read().value<Command>(); // Flawfinder: ignore
 			m_arguments = message.read().toMap(); // Flawfinder: ignore
+			traceScope.setEndArguments( m_featureUid.data1, m_command, m_arguments.size() );
 			return true;
 		}
 
@@ -81,6 +87,25 @@ bool FeatureMessage::receive( QIODevice* ioDevice )
 
 
 
+bool FeatureMessage::receiveAll( QIODevice* ioDevice, const Handler& handler )
+{
+	FeatureMessage message;
+
+	while( message.isReadyForReceive( ioDevice ) )
+	{
+		if( message.receive( ioDevice ) == false )
+		{
+			return false;
+		}
+
+		handler( message );
+	}
+
+	return true;
+}
+
+
+
 QDebug operator<<(QDebug stream, const FeatureMessage& message)
 {
 	stream << QStringLiteral("FeatureMessage(%1,%2,%3)")
@@ -24,6 +24,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include <QVariant>
 
 #include "EnumHelper.h"
@@ -37,6 +39,7 @@ public:
 	using FeatureUid = Feature::Uid;
 	using Command = qint32;
 	using Arguments = QVariantMap;
+	using Handler = std::function<void(const FeatureMessage&)>;
 
 	static constexpr unsigned char RfbMessageType = 41;
 
@@ -45,6 +48,7 @@ public:
 		DefaultCommand = 0,
 		InvalidCommand = -1,
 		InitCommand = -2,
+		AssignFeatureCommand = -3,
 	};
 
 	FeatureMessage() = default;
@@ -112,6 +116,11 @@ public:
 
 	bool receive( QIODevice* ioDevice );
 
+	// peers may send multiple messages at once while readyRead() is emitted only once, so handle all
+	// complete messages and leave incomplete ones in the device's buffer until the remaining data
+	// has arrived - returns false if an invalid message has been received
+	static bool receiveAll( QIODevice* ioDevice, const Handler& handler );
+
 private:
 	FeatureUid m_featureUid{};
 	Command m_command{InvalidCommand};
@@ -27,6 +27,14 @@
 #include <QThread>
 #include <QTimer>
 
+#ifdef Q_OS_LINUX
+#include <array>
+#include <cerrno>
+#include <pwd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
 #include "FeatureManager.h"
 #include "FeatureWorkerManager.h"
 #include "Filesystem.h"
@@ -40,7 +48,10 @@
 FeatureWorkerManager::FeatureWorkerManager( VeyonServerInterface& server, QObject* parent ) :
 	QObject( parent ),
 	m_server( server ),
-	m_tcpServer( this )
+	m_tcpServer( this ),
+	m_localServer( this ),
+	m_workerPoolSize( qMax( 0, VeyonCore::config().featureWorkerPoolSize() ) ),
+	m_workerPoolIdleTimeout( VeyonCore::config().featureWorkerPoolIdleTimeout() * 1000 )
 {
 	connect( &m_tcpServer, &QTcpServer::newConnection,
 			 this, &FeatureWorkerManager::acceptConnection );
@@ -51,10 +62,30 @@ FeatureWorkerManager::FeatureWorkerManager( VeyonServerInterface& server, QObjec
 		vCritical() << "can't listen on localhost!";
 	}
 
-	auto pendingMessagesTimer = new QTimer( this );
-	connect( pendingMessagesTimer, &QTimer::timeout, this, &FeatureWorkerManager::sendPendingMessages );
+	// workers prefer the local socket and fall back to TCP if it's not available
+	if( isLocalSocketEnabled() )
+	{
+		connect( &m_localServer, &QLocalServer::newConnection,
+				 this, &FeatureWorkerManager::acceptLocalConnection );
+
+#if defined(Q_OS_LINUX) && QT_VERSION >= QT_VERSION_CHECK(6, 2, 0)
+		m_localServer.setSocketOptions( LocalServerSocketOptions );
+#endif
+
+		if( m_localServer.listen( localServerName() ) == false )
+		{
+			vWarning() << "can't listen on local socket" << m_localServer.errorString();
+		}
+	}
+
+	if( m_workerPoolSize > 0 )
+	{
+		auto idleWorkersTimer = new QTimer( this );
+		connect( idleWorkersTimer, &QTimer::timeout, this, &FeatureWorkerManager::checkIdleWorkers );
+		idleWorkersTimer->start( IdleWorkerCheckInterval );
 
-	pendingMessagesTimer->start( 100 );
+		QTimer::singleShot( 0, this, [this]() { fillWorkerPool( WorkerType::ManagedSystem ); } );
+	}
 }
 
 
@@ -62,12 +93,18 @@ FeatureWorkerManager::FeatureWorkerManager( VeyonServerInterface& server, QObjec
 FeatureWorkerManager::~FeatureWorkerManager()
 {
 	m_tcpServer.close();
+	m_localServer.close();
 
 	// properly shutdown all worker processes
 	while( m_workers.isEmpty() == false )
 	{
 		stopWorker( m_workers.firstKey() );
 	}
+
+	for( const auto& idleWorker : std::as_const(m_idleWorkers) + std::as_const(m_startingIdleWorkers) )
+	{
+		stopIdleWorker( idleWorker );
+	}
 }
 
 
@@ -83,32 +120,21 @@ bool FeatureWorkerManager::startManagedSystemWorker( Feature::Uid featureUid )
 	stopWorker( featureUid );
 
 	Worker worker;
+	worker.startTimer.start();
 
-	worker.process = new QProcess;
-	worker.process->setProcessChannelMode( QProcess::ForwardedChannels );
-
-	connect( worker.process, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
-			 worker.process, &QProcess::deleteLater );
-
-	vDebug() << "Starting managed system worker for feature" << VeyonCore::featureManager().feature(featureUid).name();
-	if( qEnvironmentVariableIsSet("VEYON_VALGRIND_WORKERS") )
+	if( assignIdleWorker( featureUid, WorkerType::ManagedSystem, worker ) == false )
 	{
-		worker.process->start( QStringLiteral("valgrind"),
-							   { QStringLiteral("--error-limit=no"),
-								 QStringLiteral("--leak-check=full"),
-								 QStringLiteral("--show-leak-kinds=all"),
-								 QStringLiteral("--log-file=valgrind-%1.log").arg(VeyonCore::formattedUuid(featureUid)),
-								 VeyonCore::filesystem().workerFilePath(), featureUid.toString() } );
-	}
-	else
-	{
-		worker.process->start( VeyonCore::filesystem().workerFilePath(), { featureUid.toString() } );
+		vDebug() << "Starting managed system worker for feature" << VeyonCore::featureManager().feature(featureUid).name();
+
+		worker.process = startWorkerProcess( { featureUid.toString() } );
 	}
 
 	m_workersMutex.lock();
 	m_workers[featureUid] = worker;
 	m_workersMutex.unlock();
 
+	fillWorkerPool( WorkerType::ManagedSystem );
+
 	return true;
 }
 
@@ -125,30 +151,25 @@ bool FeatureWorkerManager::startUnmanagedSessionWorker( Feature::Uid featureUid
 	stopWorker( featureUid );
 
 	Worker worker;
+	worker.startTimer.start();
 
-	vDebug() << "Starting worker (unmanaged session process) for feature" << featureUid;
-
-	const auto currentUser = VeyonCore::platform().userFunctions().currentUser();
-	if( currentUser.isEmpty() )
+	if( assignIdleWorker( featureUid, WorkerType::UnmanagedSession, worker ) == false )
 	{
-		vDebug() << "could not determine current user - probably a console session with logon screen";
-		return false;
-	}
+		vDebug() << "Starting worker (unmanaged session process) for feature" << featureUid;
 
-	const auto ret = VeyonCore::platform().coreFunctions().
-					 runProgramAsUser( VeyonCore::filesystem().workerFilePath(), { featureUid.toString() },
-									   currentUser,
-									   VeyonCore::platform().coreFunctions().activeDesktopName() );
-	if( ret == false )
-	{
-		vWarning() << "failed to start worker for feature" << featureUid;
-		return false;
+		if( startSessionWorkerProcess( { featureUid.toString() } ) == false )
+		{
+			vWarning() << "failed to start worker for feature" << featureUid;
+			return false;
+		}
 	}
 
 	m_workersMutex.lock();
 	m_workers[featureUid] = worker;
 	m_workersMutex.unlock();
 
+	fillWorkerPool( WorkerType::UnmanagedSession );
+
 	return true;
 }
 
@@ -179,14 +200,7 @@ bool FeatureWorkerManager::stopWorker( Feature::Uid featureUid )
 			worker.socket->deleteLater();
 		}
 
-		if( worker.process )
-		{
-			auto killTimer = new QTimer;
-			connect( killTimer, &QTimer::timeout, worker.process, &QProcess::terminate );
-			connect( killTimer, &QTimer::timeout, worker.process, &QProcess::kill );
-			connect( killTimer, &QTimer::timeout, killTimer, &QTimer::deleteLater );
-			killTimer->start( 5000 );
-		}
+		terminateWorkerProcess( worker.process );
 
 		m_workers.remove( featureUid );
 	}
@@ -242,6 +256,20 @@ bool FeatureWorkerManager::isWorkerRunning( Feature::Uid featureUid )
 
 
 
+bool FeatureWorkerManager::isLocalSocketEnabled()
+{
+#if defined(Q_OS_LINUX) && QT_VERSION >= QT_VERSION_CHECK(6, 2, 0)
+	return VeyonCore::config().featureWorkerLocalSocketEnabled();
+#else
+	// socket files (Linux with Qt < 6.2) would have to be world-accessible and be created in a
+	// world-writable directory and named pipes (Windows) can be created by any user in advance, so
+	// other local users could squat the name and managed workers would connect to them - use TCP only
+	return false;
+#endif
+}
+
+
+
 void FeatureWorkerManager::acceptConnection()
 {
 	vDebug() << "accepting connection";
@@ -258,19 +286,136 @@ void FeatureWorkerManager::acceptConnection()
 
 
 
-void FeatureWorkerManager::processConnection( QTcpSocket* socket )
+void FeatureWorkerManager::acceptLocalConnection()
+{
+	vDebug() << "accepting local connection";
+
+	QLocalSocket* socket = m_localServer.nextPendingConnection();
+
+	if( isAuthorizedPeer( socket ) == false )
+	{
+		vWarning() << "rejecting local connection from unauthorized process";
+		socket->abort();
+		socket->deleteLater();
+		return;
+	}
+
+	connect( socket, &QLocalSocket::readyRead,
+			 this, [=] () { processConnection( socket ); } );
+
+	connect( socket, &QLocalSocket::disconnected,
+			 this, [=] () { closeConnection( socket ); } );
+}
+
+
+
+bool FeatureWorkerManager::isAuthorizedPeer( QLocalSocket* socket )
 {
-	FeatureMessage message;
-	message.receive( socket );
+#ifdef Q_OS_LINUX
+	struct ucred credentials{};
+	socklen_t length = sizeof(credentials);
+	if( getsockopt( int( socket->socketDescriptor() ), SOL_SOCKET, SO_PEERCRED, &credentials, &length ) != 0 )
+	{
+		vWarning() << "could not determine credentials of peer" << errno;
+		return false;
+	}
+
+	// managed workers run with the same privileges as we do
+	if( credentials.uid == 0 || credentials.uid == getuid() )
+	{
+		return true;
+	}
+
+	// session workers run as the user logged in to the session
+	const auto currentUser = VeyonCore::platform().userFunctions().currentUser().toUtf8();
+	if( currentUser.isEmpty() )
+	{
+		return false;
+	}
+
+	struct passwd entry{};
+	struct passwd* result = nullptr;
+	std::array<char, 4096> buffer{};
+	if( getpwnam_r( currentUser.constData(), &entry, buffer.data(), buffer.size(), &result ) != 0 || result == nullptr )
+	{
+		return false;
+	}
+
+	return credentials.uid == entry.pw_uid;
+#else
+	Q_UNUSED(socket)
+
+	return true;
+#endif
+}
+
+
+
+qint64 FeatureWorkerManager::localPeerProcessId( QIODevice* socket )
+{
+#ifdef Q_OS_LINUX
+	const auto localSocket = qobject_cast<QLocalSocket *>( socket );
+	if( localSocket )
+	{
+		struct ucred credentials{};
+		socklen_t length = sizeof(credentials);
+		if( getsockopt( int( localSocket->socketDescriptor() ), SOL_SOCKET, SO_PEERCRED, &credentials, &length ) == 0 )
+		{
+			return credentials.pid;
+		}
+	}
+#else
+	Q_UNUSED(socket)
+#endif
+
+	return -1;
+}
+
+
+
+void FeatureWorkerManager::processConnection( QIODevice* socket )
+{
+	// workers may send multiple messages at once (e.g. status and reply)
+	const auto success = FeatureMessage::receiveAll( socket, [=]( const FeatureMessage& message ) {
+		processMessage( socket, message );
+	} );
+
+	if( success == false )
+	{
+		vCritical() << "invalid message from worker - closing connection";
+		socket->close();
+	}
+}
+
+
+
+void FeatureWorkerManager::processMessage( QIODevice* socket, const FeatureMessage& message )
+{
+	if( message.featureUid().isNull() )
+	{
+		if( message.command() == FeatureMessage::InitCommand )
+		{
+			registerIdleWorker( socket, message );
+		}
+		return;
+	}
 
 	m_workersMutex.lock();
 
 	// set socket information
 	if( m_workers.contains( message.featureUid() ) )
 	{
-		if( m_workers[message.featureUid()].socket.isNull() )
+		auto& worker = m_workers[message.featureUid()];
+		if( message.command() == FeatureMessage::InitCommand )
 		{
-			m_workers[message.featureUid()].socket = socket;
+			// activation latency of pooled workers vs. workers started on demand
+			vDebug() << "worker for feature" << message.featureUid() << "ready after" << worker.startTimer.elapsed() << "ms"
+					 << ( worker.pooled ? "(pooled start)" : "(cold start)" );
+		}
+
+		if( worker.socket.isNull() )
+		{
+			worker.socket = socket;
 			sendPendingMessages();
 		}
 
@@ -291,7 +436,7 @@ void FeatureWorkerManager::processConnection( QTcpSocket* socket )
 
 
 
-void FeatureWorkerManager::closeConnection( QTcpSocket* socket )
+void FeatureWorkerManager::closeConnection( QIODevice* socket )
 {
 	m_workersMutex.lock();
 
@@ -310,6 +455,18 @@ void FeatureWorkerManager::closeConnection( QTcpSocket* socket )
 
 	m_workersMutex.unlock();
 
+	for( auto it = m_idleWorkers.begin(); it != m_idleWorkers.end(); )
+	{
+		if( it->socket == socket )
+		{
+			it = m_idleWorkers.erase( it );
+		}
+		else
+		{
+			++it;
+		}
+	}
+
 	socket->deleteLater();
 }
 
@@ -321,7 +478,15 @@ void FeatureWorkerManager::sendMessage( const FeatureMessage& message )
 
 	if( m_workers.contains( message.featureUid() ) )
 	{
-		m_workers[message.featureUid()].pendingMessages.append( message );
+		auto& worker = m_workers[message.featureUid()];
+		worker.pendingMessages.append( message );
+
+		// deliver immediately if the worker already is connected, otherwise the message
+		// gets sent as soon as the worker has connected
+		if( worker.socket )
+		{
+			sendPendingMessagesQueued();
+		}
 	}
 	else
 	{
@@ -333,6 +498,21 @@ void FeatureWorkerManager::sendMessage( const FeatureMessage& message )
 
 
 
+void FeatureWorkerManager::sendPendingMessagesQueued()
+{
+	// sockets must only be accessed from the thread they live in
+	if( thread() == QThread::currentThread() )
+	{
+		sendPendingMessages();
+	}
+	else
+	{
+		QMetaObject::invokeMethod( this, &FeatureWorkerManager::sendPendingMessages, Qt::QueuedConnection );
+	}
+}
+
+
+
 void FeatureWorkerManager::sendPendingMessages()
 {
 	m_workersMutex.lock();
@@ -350,3 +530,252 @@ void FeatureWorkerManager::sendPendingMessages()
 
 	m_workersMutex.unlock();
 }
+
+
+
+QProcess* FeatureWorkerManager::startWorkerProcess( const QStringList& arguments, const QStringList& extraEnvironment )
+{
+	auto process = new QProcess;
+	process->setProcessChannelMode( QProcess::ForwardedChannels );
+
+	if( extraEnvironment.isEmpty() == false )
+	{
+		process->setEnvironment( QProcess::systemEnvironment() + extraEnvironment );
+	}
+
+	connect( process, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+			 process, &QProcess::deleteLater );
+
+	if( qEnvironmentVariableIsSet("VEYON_VALGRIND_WORKERS") )
+	{
+		process->start( QStringLiteral("valgrind"),
+						QStringList{ QStringLiteral("--error-limit=no"),
+						  QStringLiteral("--leak-check=full"),
+						  QStringLiteral("--show-leak-kinds=all"),
+						  QStringLiteral("--log-file=valgrind-%1.log").arg( arguments.value( 0 ) == idleWorkerArgument() ?
+																				QStringLiteral("idle-%p") :
+																				VeyonCore::formattedUuid( Feature::Uid{arguments.value( 0 )} ) ),
+						  VeyonCore::filesystem().workerFilePath() } + arguments );
+	}
+	else
+	{
+		process->start( VeyonCore::filesystem().workerFilePath(), arguments );
+	}
+
+	return process;
+}
+
+
+
+bool FeatureWorkerManager::startSessionWorkerProcess( const QStringList& arguments, const QStringList& extraEnvironment,
+													qint64* processId )
+{
+	const auto currentUser = VeyonCore::platform().userFunctions().currentUser();
+	if( currentUser.isEmpty() )
+	{
+		vDebug() << "could not determine current user - probably a console session with logon screen";
+		return false;
+	}
+
+	return VeyonCore::platform().coreFunctions().
+			runProgramAsUser( VeyonCore::filesystem().workerFilePath(), arguments,
+							  currentUser,
+							  VeyonCore::platform().coreFunctions().activeDesktopName(),
+							  extraEnvironment, processId );
+}
+
+
+
+void FeatureWorkerManager::terminateWorkerProcess( QProcess* process )
+{
+	if( process )
+	{
+		auto killTimer = new QTimer;
+		connect( killTimer, &QTimer::timeout, process, &QProcess::terminate );
+		connect( killTimer, &QTimer::timeout, process, &QProcess::kill );
+		connect( killTimer, &QTimer::timeout, killTimer, &QTimer::deleteLater );
+		killTimer->start( 5000 );
+	}
+}
+
+
+
+bool FeatureWorkerManager::assignIdleWorker( Feature::Uid featureUid, WorkerType type, Worker& worker )
+{
+	const auto currentUser = type == WorkerType::UnmanagedSession ?
+								 VeyonCore::platform().userFunctions().currentUser() : QString{};
+
+	for( auto it = m_idleWorkers.begin(); it != m_idleWorkers.end(); )
+	{
+		if( it->type != type )
+		{
+			++it;
+			continue;
+		}
+
+		const auto idleWorker = *it;
+		it = m_idleWorkers.erase( it );
+
+		// session workers must not be reused after a different user has logged in
+		if( idleWorker.socket.isNull() ||
+			idleWorker.socket->isOpen() == false ||
+			idleWorker.user != currentUser )
+		{
+			stopIdleWorker( idleWorker );
+			continue;
+		}
+
+		vDebug() << "Assigning idle worker to feature" << VeyonCore::featureManager().feature(featureUid).name();
+
+		FeatureMessage{ Feature::Uid{}, FeatureMessage::AssignFeatureCommand }
+			.addArgument( Argument::FeatureUid, featureUid )
+			.send( idleWorker.socket );
+
+		worker.socket = idleWorker.socket;
+		worker.process = idleWorker.process;
+		worker.pooled = true;
+
+		return true;
+	}
+
+	return false;
+}
+
+
+
+void FeatureWorkerManager::fillWorkerPool( WorkerType type )
+{
+	if( m_workerPoolSize <= 0 )
+	{
+		return;
+	}
+
+	const auto countWorkers = [type]( const QList<IdleWorker>& workers ) {
+		return std::count_if( workers.begin(), workers.end(), [type]( const IdleWorker& worker ) {
+			return worker.type == type;
+		} );
+	};
+
+	auto workerCount = countWorkers( m_idleWorkers ) + countWorkers( m_startingIdleWorkers );
+
+	while( workerCount < m_workerPoolSize )
+	{
+		IdleWorker idleWorker;
+		idleWorker.type = type;
+		idleWorker.token = QUuid::createUuid().toString( QUuid::WithoutBraces );
+		idleWorker.timer.start();
+
+		const QStringList environment{ QStringLiteral("%1=%2").arg( QLatin1String(IdleWorkerTokenEnvironmentVariable),
+																	idleWorker.token ) };
+
+		if( type == WorkerType::ManagedSystem )
+		{
+			idleWorker.process = startWorkerProcess( { idleWorkerArgument() }, environment );
+			idleWorker.processId = idleWorker.process->processId();
+		}
+		else
+		{
+			idleWorker.user = VeyonCore::platform().userFunctions().currentUser();
+			if( startSessionWorkerProcess( { idleWorkerArgument() }, environment, &idleWorker.processId ) == false )
+			{
+				return;
+			}
+		}
+
+		m_startingIdleWorkers.append( idleWorker );
+		++workerCount;
+	}
+}
+
+
+
+void FeatureWorkerManager::registerIdleWorker( QIODevice* socket, const FeatureMessage& message )
+{
+	const auto token = message.argument( Argument::IdleWorkerToken ).toString();
+
+	// prefer the actual process ID of the peer over the one reported by it whenever available
+	auto processId = localPeerProcessId( socket );
+	if( processId <= 0 )
+	{
+		processId = message.argument( Argument::ProcessId ).toLongLong();
+	}
+
+	auto startingWorker = std::find_if( m_startingIdleWorkers.begin(), m_startingIdleWorkers.end(),
+										[&token]( const IdleWorker& worker ) {
+											return token.isEmpty() == false && worker.token == token;
+										} );
+	if( startingWorker == m_startingIdleWorkers.end() )
+	{
+		vWarning() << "got registration from unknown idle worker" << processId;
+		socket->close();
+		return;
+	}
+
+	// the worker additionally has to be the process we started - if not, the token
+	// has been leaked so don't use the worker at all
+	if( startingWorker->processId <= 0 || startingWorker->processId != processId )
+	{
+		vWarning() << "process ID" << processId << "does not match idle worker" << startingWorker->processId;
+		socket->close();
+		terminateWorkerProcess( startingWorker->process );
+		m_startingIdleWorkers.erase( startingWorker );
+		return;
+	}
+
+	auto idleWorker = *startingWorker;
+	m_startingIdleWorkers.erase( startingWorker );
+
+	vDebug() << "idle worker ready after" << idleWorker.timer.elapsed() << "ms";
+
+	idleWorker.socket = socket;
+	idleWorker.timer.restart();
+
+	m_idleWorkers.append( idleWorker );
+}
+
+
+
+void FeatureWorkerManager::stopIdleWorker( const IdleWorker& idleWorker )
+{
+	if( idleWorker.socket )
+	{
+		// workers exit as soon as the connection has been closed
+		idleWorker.socket->close();
+	}
+
+	terminateWorkerProcess( idleWorker.process );
+}
+
+
+
+void FeatureWorkerManager::checkIdleWorkers()
+{
+	for( auto it = m_idleWorkers.begin(); it != m_idleWorkers.end(); )
+	{
+		if( m_workerPoolIdleTimeout > 0 && it->timer.elapsed() > m_workerPoolIdleTimeout )
+		{
+			vDebug() << "stopping idle worker after timeout";
+			const auto idleWorker = *it;
+			it = m_idleWorkers.erase( it );
+			stopIdleWorker( idleWorker );
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	for( auto it = m_startingIdleWorkers.begin(); it != m_startingIdleWorkers.end(); )
+	{
+		if( it->timer.elapsed() > IdleWorkerStartTimeout )
+		{
+			vWarning() << "idle worker did not connect in time";
+			terminateWorkerProcess( it->process );
+			it = m_startingIdleWorkers.erase( it );
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
@@ -24,6 +24,9 @@
 
 #pragma once
 
+#include <QElapsedTimer>
+#include <QLocalServer>
+#include <QLocalSocket>
 #include <QPointer>
 #include <QProcess>
 #include <QTcpServer>
@@ -44,6 +47,14 @@ class VEYON_CORE_EXPORT FeatureWorkerManager : public QObject
 {
 	Q_OBJECT
 public:
+	enum class Argument
+	{
+		ProcessId,
+		FeatureUid,
+		IdleWorkerToken
+	};
+	Q_ENUM(Argument)
+
 	FeatureWorkerManager( VeyonServerInterface& server, QObject* parent = nullptr );
 	~FeatureWorkerManager() override;
 
@@ -57,30 +68,99 @@ public:
 
 	bool isWorkerRunning( Feature::Uid featureUid );
 
+	static QString idleWorkerArgument()
+	{
+		return QStringLiteral("--idle");
+	}
+
+	// passed through the environment as it is only readable by the worker's user and administrators
+	static constexpr auto IdleWorkerTokenEnvironmentVariable = "VEYON_IDLE_WORKER_TOKEN";
+
+	static QString localServerName()
+	{
+		return QStringLiteral("VeyonFeatureWorkerManager-%1").arg( VeyonCore::sessionId() );
+	}
+
+	static bool isLocalSocketEnabled();
+
+#if defined(Q_OS_LINUX) && QT_VERSION >= QT_VERSION_CHECK(6, 2, 0)
+	// use the abstract namespace so no socket files have to be managed - it doesn't provide
+	// any access control so both sides verify the credentials of their peer when connecting
+	static constexpr auto LocalServerSocketOptions = QLocalServer::AbstractNamespaceOption;
+	static constexpr auto LocalSocketOptions = QLocalSocket::AbstractNamespaceOption;
+#endif
+
 private:
+	enum class WorkerType
+	{
+		ManagedSystem,
+		UnmanagedSession
+	};
+
+	struct Worker
+	{
+		QPointer<QIODevice> socket;
+		QPointer<QProcess> process;
+		QList<FeatureMessage> pendingMessages;
+		QElapsedTimer startTimer;
+		bool pooled{false};
+	};
+
+	// feature-agnostic workers which have been started in advance and are waiting
+	// for being assigned to a feature - each one is passed a random one-time token
+	// which it has to present when registering along with the ID of the started
+	// process so that arbitrary local processes can't take its place
+	struct IdleWorker
+	{
+		WorkerType type{WorkerType::ManagedSystem};
+		QPointer<QIODevice> socket;
+		QPointer<QProcess> process;
+		qint64 processId{0};
+		QString user;
+		QString token;
+		QElapsedTimer timer;
+	};
+
+	QProcess* startWorkerProcess( const QStringList& arguments, const QStringList& extraEnvironment = {} );
+	bool startSessionWorkerProcess( const QStringList& arguments, const QStringList& extraEnvironment = {},
+									qint64* processId = nullptr );
+	static void terminateWorkerProcess( QProcess* process );
+
+	bool assignIdleWorker( Feature::Uid featureUid, WorkerType type, Worker& worker );
+	void fillWorkerPool( WorkerType type );
+	void registerIdleWorker( QIODevice* socket, const FeatureMessage& message );
+	void stopIdleWorker( const IdleWorker& idleWorker );
+	void checkIdleWorkers();
+
 	void acceptConnection();
-	void processConnection( QTcpSocket* socket );
-	void closeConnection( QTcpSocket* socket );
+	void acceptLocalConnection();
+	static bool isAuthorizedPeer( QLocalSocket* socket );
+	static qint64 localPeerProcessId( QIODevice* socket );
+	void processConnection( QIODevice* socket );
+	void processMessage( QIODevice* socket, const FeatureMessage& message );
+	void closeConnection( QIODevice* socket );
 
 	void sendMessage( const FeatureMessage& message );
+	void sendPendingMessagesQueued();
 
 	void sendPendingMessages();
 
 	static constexpr auto UnmanagedSessionProcessRetryInterval = 5000;
+	static constexpr auto IdleWorkerCheckInterval = 1000;
+	static constexpr auto IdleWorkerStartTimeout = 30000;
 
 	VeyonServerInterface& m_server;
 	QTcpServer m_tcpServer;
-
-	struct Worker
-	{
-		QPointer<QTcpSocket> socket;
-		QPointer<QProcess> process;
-		QList<FeatureMessage> pendingMessages;
-	};
+	QLocalServer m_localServer;
 
 	using WorkerMap = QMap<Feature::Uid, Worker>;
 	WorkerMap m_workers;
 
+	const int m_workerPoolSize;
+	const int m_workerPoolIdleTimeout;
+	QList<IdleWorker> m_idleWorkers;
+	QList<IdleWorker> m_startingIdleWorkers;
+
 #if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
 	QRecursiveMutex m_workersMutex;
 #else
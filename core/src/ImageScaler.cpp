@@ -0,0 +1,453 @@
+/*
+ * ImageScaler.cpp - implementation of ImageScaler class
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "ImageScaler.h"
+
+
+ImageScaler::Implementation ImageScaler::nativeImplementation()
+{
+#if defined(__SSE2__)
+	static const auto implementation = isAVX2Supported() ? Implementation::AVX2 : Implementation::SSE2;
+	return implementation;
+#elif defined(__ARM_NEON)
+	return Implementation::NEON;
+#else
+	return Implementation::Scalar;
+#endif
+}
+
+
+
+bool ImageScaler::isAvailable( Implementation implementation )
+{
+	switch( implementation )
+	{
+	case Implementation::Scalar:
+		return true;
+#if defined(__SSE2__)
+	case Implementation::SSE2:
+		return true;
+	case Implementation::AVX2:
+		return nativeImplementation() == Implementation::AVX2;
+#elif defined(__ARM_NEON)
+	case Implementation::NEON:
+		return true;
+#endif
+	default:
+		break;
+	}
+
+	return false;
+}
+
+
+
+bool ImageScaler::canScale( const QImage& image, QSize size )
+{
+	return image.isNull() == false &&
+			size.isEmpty() == false &&
+			( image.format() == QImage::Format_RGB32 ||
+			  image.format() == QImage::Format_ARGB32_Premultiplied ) &&
+			size.width() <= image.width() &&
+			size.height() <= image.height();
+}
+
+
+
+QImage ImageScaler::scaled( const QImage& image, QSize size )
+{
+	if( canScale( image, size ) == false )
+	{
+		return image.scaled( size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
+	}
+
+	QImage target( size, image.format() );
+	scale( image, target, target.rect() );
+
+	return target;
+}
+
+
+
+void ImageScaler::scale( const QImage& image, QImage& target, QRect targetRect, Implementation implementation )
+{
+	targetRect = targetRect.intersected( target.rect() );
+
+	if( targetRect.isEmpty() || canScale( image, target.size() ) == false || target.format() != image.format() ||
+		isAvailable( implementation ) == false )
+	{
+		return;
+	}
+
+	const auto horizontalFilter = createFilter( image.width(), target.width(), targetRect.left(), targetRect.right() + 1 );
+	const auto verticalFilter = createFilter( image.height(), target.height(), targetRect.top(), targetRect.bottom() + 1 );
+
+	const auto valueCount = targetRect.width() * ChannelCount;
+
+	QVector<uint16_t> row( valueCount );
+	QVector<uint32_t> accumulator( valueCount );
+
+	for( int y = 0; y < verticalFilter.contributions.size(); ++y )
+	{
+		const auto& contribution = verticalFilter.contributions[y];
+		const auto weights = verticalFilter.weights.constData() + contribution.weightsOffset;
+
+		accumulator.fill( 0 );
+
+		for( int i = 0; i < contribution.count; ++i )
+		{
+			scaleRow( reinterpret_cast<const QRgb *>( image.constScanLine( contribution.first + i ) ),
+					  horizontalFilter, row.data(), implementation );
+			accumulateRow( row.constData(), weights[i], accumulator.data(), valueCount, implementation );
+		}
+
+		storeRow( accumulator.constData(),
+				  reinterpret_cast<QRgb *>( target.scanLine( targetRect.top() + y ) ) + targetRect.left(),
+				  targetRect.width() );
+	}
+}
+
+
+
+ImageScaler::Filter ImageScaler::createFilter( int sourceSize, int targetSize, int begin, int end )
+{
+	static constexpr int WeightSum = 1 << WeightBits;
+
+	Filter filter;
+	filter.contributions.reserve( end - begin );
+
+	const auto factor = double(sourceSize) / targetSize;
+
+	for( int t = begin; t < end; ++t )
+	{
+		// each target pixel covers the source range [spanBegin, spanEnd)
+		const auto spanBegin = t * factor;
+		const auto spanEnd = qMin( ( t + 1 ) * factor, double(sourceSize) );
+
+		const auto first = qMin( int(spanBegin), sourceSize - 1 );
+		const auto last = qBound( first + 1, int( std::ceil( spanEnd ) ), sourceSize );
+
+		const auto weightsOffset = filter.weights.size();
+		const auto span = spanEnd - spanBegin;
+
+		// derive weights from rounded cumulative coverage so that they add up exactly
+		// without any compensation, even if a target pixel covers hundreds of source pixels
+		int weightSum = 0;
+
+		for( int i = first; i < last; ++i )
+		{
+			const auto coverage = qMin( double(i + 1), spanEnd ) - spanBegin;
+			const auto cumulativeWeight = qBound( weightSum, int( coverage / span * WeightSum + 0.5 ), WeightSum );
+
+			filter.weights.append( uint16_t( cumulativeWeight - weightSum ) );
+			weightSum = cumulativeWeight;
+		}
+
+		filter.contributions.append( { first, last - first, weightsOffset } );
+	}
+
+	return filter;
+}
+
+
+
+void ImageScaler::scaleRow( const QRgb* source, const Filter& filter, uint16_t* row, Implementation implementation )
+{
+	switch( implementation )
+	{
+#if defined(__SSE2__)
+	case Implementation::SSE2:
+		scaleRowSSE2( source, filter, row );
+		break;
+	case Implementation::AVX2:
+		scaleRowAVX2( source, filter, row );
+		break;
+#elif defined(__ARM_NEON)
+	case Implementation::NEON:
+		scaleRowNEON( source, filter, row );
+		break;
+#endif
+	default:
+		scaleRowScalar( source, filter, row );
+		break;
+	}
+}
+
+
+
+void ImageScaler::scaleRowScalar( const QRgb* source, const Filter& filter, uint16_t* row )
+{
+	static constexpr uint32_t Rounding = 1 << ( HorizontalShift - 1 );
+
+	for( const auto& contribution : filter.contributions )
+	{
+		const auto pixels = source + contribution.first;
+		const auto weights = filter.weights.constData() + contribution.weightsOffset;
+
+		uint32_t sum[ChannelCount] = {};
+
+		for( int i = 0; i < contribution.count; ++i )
+		{
+			const auto channels = reinterpret_cast<const uint8_t *>( pixels + i );
+			for( int c = 0; c < ChannelCount; ++c )
+			{
+				sum[c] += uint32_t(channels[c]) * weights[i];
+			}
+		}
+
+		for( int c = 0; c < ChannelCount; ++c )
+		{
+			row[c] = uint16_t( ( sum[c] + Rounding ) >> HorizontalShift );
+		}
+
+		row += ChannelCount;
+	}
+}
+
+
+
+void ImageScaler::accumulateRow( const uint16_t* row, uint16_t weight, uint32_t* accumulator, int count,
+								 Implementation implementation )
+{
+	int i = 0;
+
+	switch( implementation )
+	{
+#if defined(__SSE2__)
+	case Implementation::SSE2:
+		i = accumulateRowSSE2( row, weight, accumulator, count );
+		break;
+	case Implementation::AVX2:
+		i = accumulateRowAVX2( row, weight, accumulator, count );
+		break;
+#elif defined(__ARM_NEON)
+	case Implementation::NEON:
+		i = accumulateRowNEON( row, weight, accumulator, count );
+		break;
+#endif
+	default:
+		break;
+	}
+
+	// remaining values not processed by vectorized implementations
+	for( ; i < count; ++i )
+	{
+		accumulator[i] += uint32_t(row[i]) * weight;
+	}
+}
+
+
+
+#if defined(__SSE2__)
+void ImageScaler::scaleRowSSE2( const QRgb* source, const Filter& filter, uint16_t* row )
+{
+	static constexpr uint32_t Rounding = 1 << ( HorizontalShift - 1 );
+
+	const auto zero = _mm_setzero_si128();
+
+	for( const auto& contribution : filter.contributions )
+	{
+		const auto pixels = source + contribution.first;
+		const auto weights = filter.weights.constData() + contribution.weightsOffset;
+
+		auto sum = _mm_setzero_si128();
+
+		for( int i = 0; i < contribution.count; ++i )
+		{
+			const auto pixel = _mm_unpacklo_epi8( _mm_cvtsi32_si128( int(pixels[i]) ), zero );
+			const auto weight = _mm_set1_epi16( short(weights[i]) );
+			// assemble 32 bit products from low and high parts of 16 bit multiplications
+			sum = _mm_add_epi32( sum, _mm_unpacklo_epi16( _mm_mullo_epi16( pixel, weight ),
+														   _mm_mulhi_epu16( pixel, weight ) ) );
+		}
+
+		sum = _mm_srli_epi32( _mm_add_epi32( sum, _mm_set1_epi32( Rounding ) ), HorizontalShift );
+		_mm_storel_epi64( reinterpret_cast<__m128i *>( row ), _mm_packs_epi32( sum, sum ) );
+
+		row += ChannelCount;
+	}
+}
+
+
+
+int ImageScaler::accumulateRowSSE2( const uint16_t* row, uint16_t weight, uint32_t* accumulator, int count )
+{
+	const auto weights = _mm_set1_epi16( short(weight) );
+
+	int i = 0;
+
+	for( ; i + 8 <= count; i += 8 )
+	{
+		const auto values = _mm_loadu_si128( reinterpret_cast<const __m128i *>( row + i ) );
+		const auto low = _mm_mullo_epi16( values, weights );
+		const auto high = _mm_mulhi_epu16( values, weights );
+
+		const auto accumulator0 = reinterpret_cast<__m128i *>( accumulator + i );
+		const auto accumulator1 = reinterpret_cast<__m128i *>( accumulator + i + 4 );
+
+		_mm_storeu_si128( accumulator0, _mm_add_epi32( _mm_loadu_si128( accumulator0 ), _mm_unpacklo_epi16( low, high ) ) );
+		_mm_storeu_si128( accumulator1, _mm_add_epi32( _mm_loadu_si128( accumulator1 ), _mm_unpackhi_epi16( low, high ) ) );
+	}
+
+	return i;
+}
+
+
+
+bool ImageScaler::isAVX2Supported()
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports( "avx2" );
+}
+
+
+
+__attribute__((target("avx2")))
+void ImageScaler::scaleRowAVX2( const QRgb* source, const Filter& filter, uint16_t* row )
+{
+	static constexpr uint32_t Rounding = 1 << ( HorizontalShift - 1 );
+
+	for( const auto& contribution : filter.contributions )
+	{
+		const auto pixels = source + contribution.first;
+		const auto weights = filter.weights.constData() + contribution.weightsOffset;
+
+		auto sum2 = _mm256_setzero_si256();
+
+		int i = 0;
+
+		// channels of two adjacent pixels widened to 32 bit per iteration
+		for( ; i + 2 <= contribution.count; i += 2 )
+		{
+			const auto pixel = _mm256_cvtepu8_epi32( _mm_loadl_epi64( reinterpret_cast<const __m128i *>( pixels + i ) ) );
+			const auto weight = _mm256_inserti128_si256( _mm256_castsi128_si256( _mm_set1_epi32( weights[i] ) ),
+														 _mm_set1_epi32( weights[i + 1] ), 1 );
+			sum2 = _mm256_add_epi32( sum2, _mm256_mullo_epi32( pixel, weight ) );
+		}
+
+		auto sum = _mm_add_epi32( _mm256_castsi256_si128( sum2 ), _mm256_extracti128_si256( sum2, 1 ) );
+
+		if( i < contribution.count )
+		{
+			const auto pixel = _mm_cvtepu8_epi32( _mm_cvtsi32_si128( int(pixels[i]) ) );
+			sum = _mm_add_epi32( sum, _mm_mullo_epi32( pixel, _mm_set1_epi32( weights[i] ) ) );
+		}
+
+		sum = _mm_srli_epi32( _mm_add_epi32( sum, _mm_set1_epi32( Rounding ) ), HorizontalShift );
+		_mm_storel_epi64( reinterpret_cast<__m128i *>( row ), _mm_packus_epi32( sum, sum ) );
+
+		row += ChannelCount;
+	}
+}
+
+
+
+__attribute__((target("avx2")))
+int ImageScaler::accumulateRowAVX2( const uint16_t* row, uint16_t weight, uint32_t* accumulator, int count )
+{
+	// products of 16 bit values and weights always fit into 32 bits
+	const auto weights = _mm256_set1_epi32( weight );
+
+	int i = 0;
+
+	for( ; i + 16 <= count; i += 16 )
+	{
+		const auto values0 = _mm256_cvtepu16_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i *>( row + i ) ) );
+		const auto values1 = _mm256_cvtepu16_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i *>( row + i + 8 ) ) );
+
+		const auto accumulator0 = reinterpret_cast<__m256i *>( accumulator + i );
+		const auto accumulator1 = reinterpret_cast<__m256i *>( accumulator + i + 8 );
+
+		_mm256_storeu_si256( accumulator0, _mm256_add_epi32( _mm256_loadu_si256( accumulator0 ),
+															   _mm256_mullo_epi32( values0, weights ) ) );
+		_mm256_storeu_si256( accumulator1, _mm256_add_epi32( _mm256_loadu_si256( accumulator1 ),
+															   _mm256_mullo_epi32( values1, weights ) ) );
+	}
+
+	// remaining values are processed by the scalar fallback
+	return i;
+}
+#elif defined(__ARM_NEON)
+void ImageScaler::scaleRowNEON( const QRgb* source, const Filter& filter, uint16_t* row )
+{
+	static constexpr uint32_t Rounding = 1 << ( HorizontalShift - 1 );
+
+	for( const auto& contribution : filter.contributions )
+	{
+		const auto pixels = source + contribution.first;
+		const auto weights = filter.weights.constData() + contribution.weightsOffset;
+
+		auto sum = vdupq_n_u32( 0 );
+
+		for( int i = 0; i < contribution.count; ++i )
+		{
+			const auto pixel = vget_low_u16( vmovl_u8( vreinterpret_u8_u32( vdup_n_u32( pixels[i] ) ) ) );
+			sum = vmlal_n_u16( sum, pixel, weights[i] );
+		}
+
+		vst1_u16( row, vshrn_n_u32( vaddq_u32( sum, vdupq_n_u32( Rounding ) ), HorizontalShift ) );
+
+		row += ChannelCount;
+	}
+}
+
+
+
+int ImageScaler::accumulateRowNEON( const uint16_t* row, uint16_t weight, uint32_t* accumulator, int count )
+{
+	int i = 0;
+
+	for( ; i + 8 <= count; i += 8 )
+	{
+		const auto values = vld1q_u16( row + i );
+
+		vst1q_u32( accumulator + i, vmlal_n_u16( vld1q_u32( accumulator + i ), vget_low_u16( values ), weight ) );
+		vst1q_u32( accumulator + i + 4, vmlal_n_u16( vld1q_u32( accumulator + i + 4 ), vget_high_u16( values ), weight ) );
+	}
+
+	return i;
+}
+#endif
+
+
+
+void ImageScaler::storeRow( const uint32_t* accumulator, QRgb* target, int count )
+{
+	static constexpr uint32_t Rounding = 1 << ( VerticalShift - 1 );
+
+	auto channels = reinterpret_cast<uint8_t *>( target );
+
+	for( int i = 0; i < count * ChannelCount; ++i )
+	{
+		channels[i] = uint8_t( ( accumulator[i] + Rounding ) >> VerticalShift );
+	}
+}
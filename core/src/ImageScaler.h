@@ -0,0 +1,103 @@
+/*
+ * ImageScaler.h - header for ImageScaler class
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QImage>
+
+#include "VeyonCore.h"
+
+// area-averaging downscaler for 32 bit images, e.g. for generating thumbnails of
+// remote framebuffers - uses SSE2 or NEON instructions if available at compile time
+// and AVX2 instructions if supported by the CPU at runtime
+class VEYON_CORE_EXPORT ImageScaler
+{
+public:
+	// all implementations produce identical results
+	enum class Implementation
+	{
+		Scalar,
+		SSE2,
+		AVX2,
+		NEON
+	};
+
+	// returns fastest implementation available on the current CPU
+	static Implementation nativeImplementation();
+
+	static bool isAvailable( Implementation implementation );
+
+	// returns whether the image format is supported and the image gets downscaled
+	// (or keeps its size) in both directions
+	static bool canScale( const QImage& image, QSize size );
+
+	// returns image scaled to given size ignoring aspect ratio - falls back to a
+	// smooth QImage::scaled() if canScale() returns false
+	static QImage scaled( const QImage& image, QSize size );
+
+	// updates area of target image which has to be a scaled version of image in the
+	// same format - the result equals the corresponding area of scaled()
+	static void scale( const QImage& image, QImage& target, QRect targetRect,
+					   Implementation implementation = nativeImplementation() );
+
+private:
+	struct Contribution
+	{
+		int first;
+		int count;
+		int weightsOffset;
+	};
+
+	struct Filter
+	{
+		QVector<Contribution> contributions;
+		QVector<uint16_t> weights;
+	};
+
+	static Filter createFilter( int sourceSize, int targetSize, int begin, int end );
+
+	static void scaleRow( const QRgb* source, const Filter& filter, uint16_t* row, Implementation implementation );
+	static void scaleRowScalar( const QRgb* source, const Filter& filter, uint16_t* row );
+	static void accumulateRow( const uint16_t* row, uint16_t weight, uint32_t* accumulator, int count,
+							   Implementation implementation );
+#if defined(__SSE2__)
+	static void scaleRowSSE2( const QRgb* source, const Filter& filter, uint16_t* row );
+	static int accumulateRowSSE2( const uint16_t* row, uint16_t weight, uint32_t* accumulator, int count );
+	static bool isAVX2Supported();
+	static void scaleRowAVX2( const QRgb* source, const Filter& filter, uint16_t* row );
+	static int accumulateRowAVX2( const uint16_t* row, uint16_t weight, uint32_t* accumulator, int count );
+#elif defined(__ARM_NEON)
+	static void scaleRowNEON( const QRgb* source, const Filter& filter, uint16_t* row );
+	static int accumulateRowNEON( const uint16_t* row, uint16_t weight, uint32_t* accumulator, int count );
+#endif
+	static void storeRow( const uint32_t* accumulator, QRgb* target, int count );
+
+	static constexpr int ChannelCount = 4;
+
+	// weights of all source pixels contributing to a target pixel add up to 1 << WeightBits
+	static constexpr int WeightBits = 15;
+	static constexpr int HorizontalShift = 8;
+	static constexpr int VerticalShift = 2 * WeightBits - HorizontalShift;
+
+} ;
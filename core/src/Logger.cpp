@@ -26,6 +26,7 @@
 #include <QDateTime>
 #include <QDir>
 #include <QFile>
+#include <QThread>
 
 #include "VeyonConfiguration.h"
 #include "Filesystem.h"
@@ -34,18 +35,15 @@
 #include "PlatformFilesystemFunctions.h"
 
 QAtomicPointer<Logger> Logger::s_instance = nullptr;
-QMutex Logger::s_instanceMutex;
+QAtomicInt Logger::s_activeCalls = 0;
 
 
 Logger::Logger( const QString &appName ) :
 	m_appName( QStringLiteral( "Veyon" ) + appName )
 {
-	s_instanceMutex.lock();
-
-	Q_ASSERT(s_instance == nullptr);
-
-	s_instance = this;
-	s_instanceMutex.unlock();
+	const auto previousInstance = s_instance.fetchAndStoreOrdered( this );
+	Q_ASSERT(previousInstance == nullptr);
+	Q_UNUSED(previousInstance)
 
 	m_logToSystem = VeyonCore::config().logToSystem();
 	m_logToStdErr = VeyonCore::config().logToStdErr();
@@ -67,6 +65,8 @@ Logger::Logger( const QString &appName ) :
 	if( m_logLevel > LogLevel::Nothing )
 	{
 		initLogFile();
+
+		m_writerThread = std::thread( [this]() { runWriter(); } );
 	}
 
 	qInstallMessageHandler( qtMsgHandler );
@@ -91,13 +91,22 @@ Logger::~Logger()
 {
 	vDebug() << "Shutdown";
 
-	QMutexLocker l( &m_logMutex );
-
 	qInstallMessageHandler(nullptr);
 
-	s_instanceMutex.lock();
-	s_instance = nullptr;
-	s_instanceMutex.unlock();
+	s_instance.fetchAndStoreOrdered( nullptr );
+
+	// wait for message handlers still running in other threads
+	while( s_activeCalls.loadAcquire() > 0 )
+	{
+		QThread::yieldCurrentThread();
+	}
+
+	if( m_writerThread.joinable() )
+	{
+		m_requestStop = 1;
+		m_writerWaitCondition.wakeAll();
+		m_writerThread.join();
+	}
 
 	delete m_logFile;
 }
@@ -255,7 +264,7 @@ void Logger::rotateLogFile()
 
 
 
-QString Logger::formatMessage( LogLevel ll, const QString& message )
+QString Logger::formatMessage( LogLevel ll, qint64 timestamp, const QString& message )
 {
 	QString messageType;
 	switch( ll )
@@ -268,9 +277,11 @@ QString Logger::formatMessage( LogLevel ll, const QString& message )
 	default: break;
 	}
 
+	const auto dateTime = QDateTime::fromMSecsSinceEpoch( timestamp );
+
 	return QStringLiteral( "%1.%2: [%3] [%4] %5\n" ).arg(
-				QDateTime::currentDateTime().toString( Qt::ISODate ),
-				QDateTime::currentDateTime().toString( QStringLiteral( "zzz" ) ),
+				dateTime.toString( Qt::ISODate ),
+				dateTime.toString( QStringLiteral( "zzz" ) ),
 				QString::number( VeyonCore::instance()->sessionId() ),
 				messageType,
 				message.trimmed() );
@@ -281,12 +292,13 @@ QString Logger::formatMessage( LogLevel ll, const QString& message )
 
 void Logger::qtMsgHandler( QtMsgType messageType, const QMessageLogContext& context, const QString& message )
 {
-	QMutexLocker instanceLocker( &s_instanceMutex );
+	s_activeCalls.ref();
 
 	const auto instance = s_instance.loadAcquire();
 
 	if( instance == nullptr || message.size() > MaximumMessageSize )
 	{
+		s_activeCalls.deref();
 		return;
 	}
 
@@ -309,6 +321,8 @@ void Logger::qtMsgHandler( QtMsgType messageType, const QMessageLogContext& cont
 	{
 		instance->log( logLevel, message );
 	}
+
+	s_activeCalls.deref();
 }
 
 
@@ -318,40 +332,135 @@ void Logger::log( LogLevel logLevel, const QString& message )
 {
 	if( m_logLevel >= logLevel )
 	{
-		QMutexLocker l( &m_logMutex );
-		if( message == m_lastMessage && logLevel == m_lastMessageLevel )
+		enqueue( new LogEntry{ nullptr, QDateTime::currentMSecsSinceEpoch(), logLevel, message } );
+
+		// fatal messages are followed by an abort so write them out immediately
+		if( logLevel == LogLevel::Critical )
 		{
-			++m_lastMessageCount;
+			processQueue();
 		}
-		else
-		{
-			if( m_lastMessageCount )
-			{
-				outputMessage( formatMessage( m_lastMessageLevel, QStringLiteral( "---" ) ) );
-				outputMessage( formatMessage( m_lastMessageLevel, QStringLiteral( "Last message repeated %1 times" ).arg( m_lastMessageCount ) ) );
-				outputMessage( formatMessage( m_lastMessageLevel, QStringLiteral( "---" ) ) );
-				m_lastMessageCount = 0;
-			}
-			outputMessage( formatMessage( logLevel, message ) );
+	}
+}
 
-			if( m_logToSystem )
-			{
-				VeyonCore::platform().coreFunctions().writeToNativeLoggingSystem( message, logLevel );
-			}
 
-			m_lastMessage = message;
-			m_lastMessageLevel = logLevel;
+
+void Logger::enqueue( LogEntry* entry )
+{
+	entry->next = m_queueHead.load( std::memory_order_relaxed );
+	while( m_queueHead.compare_exchange_weak( entry->next, entry,
+											  std::memory_order_release, std::memory_order_relaxed ) == false )
+	{
+	}
+
+	const auto queueSize = m_queueSize.fetchAndAddRelaxed( 1 ) + 1;
+	if( queueSize == WriterWakeUpQueueSize || entry->level <= LogLevel::Error )
+	{
+		m_writerWaitCondition.wakeOne();
+	}
+}
+
+
+
+void Logger::runWriter()
+{
+	while( m_requestStop.loadAcquire() == 0 )
+	{
+		m_writerWaitMutex.lock();
+		m_writerWaitCondition.wait( &m_writerWaitMutex, FlushInterval );
+		m_writerWaitMutex.unlock();
+
+		processQueue();
+	}
+
+	processQueue();
+}
+
+
+
+void Logger::processQueue()
+{
+	QMutexLocker l( &m_outputMutex );
+
+	auto entry = m_queueHead.exchange( nullptr, std::memory_order_acquire );
+	if( entry == nullptr )
+	{
+		return;
+	}
+
+	// entries have been pushed in reverse order
+	LogEntry* entries = nullptr;
+	int entryCount = 0;
+	while( entry )
+	{
+		const auto next = entry->next;
+		entry->next = entries;
+		entries = entry;
+		entry = next;
+		++entryCount;
+	}
+
+	m_queueSize.fetchAndSubRelaxed( entryCount );
+
+	QByteArray output;
+
+	while( entries )
+	{
+		processEntry( entries, output );
+
+		if( output.size() >= MaximumBatchBytes )
+		{
+			outputMessages( output );
+			output.clear();
 		}
+
+		const auto next = entries->next;
+		delete entries;
+		entries = next;
 	}
+
+	if( output.isEmpty() == false )
+	{
+		outputMessages( output );
+	}
+}
+
+
+
+void Logger::processEntry( const LogEntry* entry, QByteArray& output )
+{
+	if( entry->message == m_lastMessage && entry->level == m_lastMessageLevel )
+	{
+		++m_lastMessageCount;
+		return;
+	}
+
+	if( m_lastMessageCount )
+	{
+		output += formatMessage( m_lastMessageLevel, entry->timestamp, QStringLiteral( "---" ) ).toUtf8();
+		output += formatMessage( m_lastMessageLevel, entry->timestamp,
+								 QStringLiteral( "Last message repeated %1 times" ).arg( m_lastMessageCount ) ).toUtf8();
+		output += formatMessage( m_lastMessageLevel, entry->timestamp, QStringLiteral( "---" ) ).toUtf8();
+		m_lastMessageCount = 0;
+	}
+
+	output += formatMessage( entry->level, entry->timestamp, entry->message ).toUtf8();
+
+	if( m_logToSystem )
+	{
+		VeyonCore::platform().coreFunctions().writeToNativeLoggingSystem( entry->message, entry->level );
+	}
+
+	m_lastMessage = entry->message;
+	m_lastMessageLevel = entry->level;
 }
 
 
 
-void Logger::outputMessage( const QString& message )
+void Logger::outputMessages( const QByteArray& messages )
 {
 	if( m_logFile )
 	{
-		m_logFile->write( message.toUtf8() );
+		m_logFile->write( messages );
 		m_logFile->flush();
 
 		if( m_logFileSizeLimit > 0 &&
@@ -370,7 +479,7 @@ void Logger::outputMessage( const QString& message )
 
 	if (m_logToStdErr)
 	{
-		fprintf( stderr, "%s", message.toUtf8().constData() );
+		fwrite( messages.constData(), 1, size_t(messages.size()), stderr );
 		fflush( stderr );
 	}
 }
@@ -24,8 +24,12 @@
 
 #pragma once
 
+#include <atomic>
+#include <thread>
+
 #include <QMutex>
 #include <QTextStream>
+#include <QWaitCondition>
 
 #include "VeyonCore.h"
 
@@ -55,6 +59,9 @@ public:
 	static constexpr int DefaultFileSizeLimit = 100;
 	static constexpr int DefaultFileRotationCount = 10;
 	static constexpr int MaximumMessageSize = 16384;
+	static constexpr int FlushInterval = 100;
+	static constexpr int WriterWakeUpQueueSize = 256;
+	static constexpr int MaximumBatchBytes = 65536;
 	static constexpr const char* DefaultLogFileDirectory = "%TEMP%";
 
 	explicit Logger( const QString &appName );
@@ -73,6 +80,14 @@ public:
 	static LogLevel logLevelFromString(const QString& logLevelString);
 
 private:
+	struct LogEntry
+	{
+		LogEntry* next{nullptr};
+		qint64 timestamp{0};
+		LogLevel level{LogLevel::Nothing};
+		QString message{};
+	};
+
 	void initLogFile();
 	void openLogFile();
 	void closeLogFile();
@@ -80,16 +95,32 @@ private:
 	void rotateLogFile();
 
 	void log( LogLevel logLevel, const QString& message );
-	void outputMessage( const QString& message );
+	void enqueue( LogEntry* entry );
+
+	void runWriter();
+	void processQueue();
+	void processEntry( const LogEntry* entry, QByteArray& output );
+	void outputMessages( const QByteArray& messages );
 
-	static QString formatMessage( LogLevel ll, const QString &msg );
+	static QString formatMessage( LogLevel ll, qint64 timestamp, const QString &msg );
 	static void qtMsgHandler( QtMsgType msgType, const QMessageLogContext &, const QString& msg );
 
 	static QAtomicPointer<Logger> s_instance;
-	static QMutex s_instanceMutex;
+	static QAtomicInt s_activeCalls;
 
 	LogLevel m_logLevel{LogLevel::Default};
-	QMutex m_logMutex{};
+
+	// lock-free multi-producer single-consumer queue - producers push onto the head,
+	// the writer takes the whole list at once and restores the chronological order
+	std::atomic<LogEntry*> m_queueHead{nullptr};
+	QAtomicInt m_queueSize{0};
+
+	// serializes queue consumers and guards all output state below
+	QMutex m_outputMutex{};
+	QMutex m_writerWaitMutex{};
+	QWaitCondition m_writerWaitCondition{};
+	QAtomicInt m_requestStop{0};
+	std::thread m_writerThread{};
 
 	LogLevel m_lastMessageLevel{LogLevel::Nothing};
 	QString m_lastMessage{};
@@ -101,6 +101,15 @@ void MonitoringMode::setMinimumFramebufferUpdateInterval(const ComputerControlIn
 
 
 
+void MonitoringMode::setFramebufferScale(const ComputerControlInterfaceList& computerControlInterfaces, int scale)
+{
+	sendFeatureMessage(FeatureMessage{m_monitoringModeFeature.uid(), Command::SetFramebufferScale}
+					   .addArgument(Argument::FramebufferScale, scale),
+					   computerControlInterfaces);
+}
+
+
+
 void MonitoringMode::queryApplicationVersion(const ComputerControlInterfaceList& computerControlInterfaces)
 {
 	sendFeatureMessage(FeatureMessage{m_queryApplicationVersionFeature.uid()}, computerControlInterfaces);
@@ -235,6 +244,12 @@ bool MonitoringMode::handleFeatureMessage(VeyonServerInterface& server,
 													   message.argument(Argument::MinimumFramebufferUpdateInterval).toInt());
 			return true;
 		}
+
+		if (message.command() == Command::SetFramebufferScale)
+		{
+			server.setFramebufferScale(messageContext, message.argument(Argument::FramebufferScale).toInt());
+			return true;
+		}
 	}
 
 	if (message.featureUid() == m_queryApplicationVersionFeature.uid())
@@ -46,6 +46,7 @@ public:
 		SessionHostName,
 		SessionClientAddress,
 		SessionClientName,
+		FramebufferScale,
 		ActiveFeaturesList = 0 // for compatibility after migration from FeatureControl
 	};
 	Q_ENUM(Argument)
@@ -97,6 +98,8 @@ public:
 	void setMinimumFramebufferUpdateInterval(const ComputerControlInterfaceList& computerControlInterfaces,
 											 int interval);
 
+	void setFramebufferScale(const ComputerControlInterfaceList& computerControlInterfaces, int scale);
+
 	void queryApplicationVersion(const ComputerControlInterfaceList& computerControlInterfaces);
 
 	void queryActiveFeatures(const ComputerControlInterfaceList& computerControlInterfaces);
@@ -161,7 +164,8 @@ private:
 	enum Command
 	{
 		Ping,
-		SetMinimumFramebufferUpdateInterval
+		SetMinimumFramebufferUpdateInterval,
+		SetFramebufferScale
 	};
 
 	static constexpr int ActiveFeaturesUpdateInterval = 250;
@@ -22,12 +22,20 @@
  *
  */
 
+#include <QTimer>
+
 #include "NestedNetworkObjectDirectory.h"
 
 
 NestedNetworkObjectDirectory::NestedNetworkObjectDirectory( QObject* parent ) :
-    NetworkObjectDirectory( tr("All directories"), parent )
+	NetworkObjectDirectory( tr("All directories"), parent ),
+	m_subDirectoryChangesTimer( new QTimer( this ) )
 {
+	m_subDirectoryChangesTimer->setInterval( SubDirectoryChangesUpdateDelay );
+	m_subDirectoryChangesTimer->setSingleShot( true );
+
+	connect( m_subDirectoryChangesTimer, &QTimer::timeout,
+			 this, &NestedNetworkObjectDirectory::updateChangedSubDirectories );
 }
 
 
@@ -35,6 +43,19 @@ NestedNetworkObjectDirectory::NestedNetworkObjectDirectory( QObject* parent ) :
 void NestedNetworkObjectDirectory::addSubDirectory( NetworkObjectDirectory* subDirectory )
 {
 	m_subDirectories.append( subDirectory );
+
+	// sub directories may change on their own (e.g. when updating in the background)
+	const auto scheduleUpdate = [this, subDirectory]() {
+		if( m_changedSubDirectories.contains( subDirectory ) == false )
+		{
+			m_changedSubDirectories.append( subDirectory );
+		}
+		m_subDirectoryChangesTimer->start();
+	};
+
+	connect( subDirectory, &NetworkObjectDirectory::objectsInserted, this, scheduleUpdate );
+	connect( subDirectory, &NetworkObjectDirectory::objectsRemoved, this, scheduleUpdate );
+	connect( subDirectory, &NetworkObjectDirectory::objectChanged, this, scheduleUpdate );
 }
 
 
@@ -74,13 +95,24 @@ void NestedNetworkObjectDirectory::update()
 	for( auto* subDirectory : std::as_const(m_subDirectories) )
 	{
 		subDirectoryNames.append( subDirectory->name() );
-		NetworkObject subDirectoryObject{this, NetworkObject::Type::SubDirectory, subDirectory->name(), {},
-											{}, rootObject().uid() };
+		const auto subDirectoryObject = this->subDirectoryObject( subDirectory );
 		addOrUpdateObject( subDirectoryObject, rootObject() );
 
 		subDirectory->update();
 
+		// deliver deferred change signals now so they only refer to changes mirrored below
+		subDirectory->propagateChildObjectChanges();
+
 		replaceObjectsRecursively( subDirectory, subDirectoryObject );
+
+		// the sub directory has just been mirrored completely so don't mirror it again
+		// due to signals emitted while updating it
+		m_changedSubDirectories.removeAll( subDirectory );
+	}
+
+	if( m_changedSubDirectories.isEmpty() )
+	{
+		m_subDirectoryChangesTimer->stop();
 	}
 
 	removeObjects( rootObject(), [subDirectoryNames]( const NetworkObject& object ) {
@@ -106,6 +138,14 @@ void NestedNetworkObjectDirectory::fetchObjects( const NetworkObject& parent )
 
 
 
+NetworkObject NestedNetworkObjectDirectory::subDirectoryObject( const NetworkObjectDirectory* subDirectory ) const
+{
+	return NetworkObject{const_cast<NestedNetworkObjectDirectory *>( this ), NetworkObject::Type::SubDirectory,
+						 subDirectory->name(), {}, {}, rootObject().uid()};
+}
+
+
+
 void NestedNetworkObjectDirectory::replaceObjectsRecursively( NetworkObjectDirectory* directory,
 															   const NetworkObject& parent )
 {
@@ -120,3 +160,20 @@ void NestedNetworkObjectDirectory::replaceObjectsRecursively( NetworkObjectDirec
 	}
 	replaceObjects( objects, parent );
 }
+
+
+
+void NestedNetworkObjectDirectory::updateChangedSubDirectories()
+{
+	const auto changedSubDirectories = m_changedSubDirectories;
+	m_changedSubDirectories.clear();
+
+	for( auto* subDirectory : changedSubDirectories )
+	{
+		const auto subDirectoryObject = this->subDirectoryObject( subDirectory );
+		if( index( rootId(), subDirectoryObject.modelId() ) >= 0 )
+		{
+			replaceObjectsRecursively( subDirectory, subDirectoryObject );
+		}
+	}
+}
@@ -42,9 +42,15 @@ public:
 	void fetchObjects( const NetworkObject& parent ) override;
 
 private:
+	static constexpr auto SubDirectoryChangesUpdateDelay = 100;
+
+	NetworkObject subDirectoryObject( const NetworkObjectDirectory* subDirectory ) const;
 	void replaceObjectsRecursively( NetworkObjectDirectory* directory,
 								   const NetworkObject& parent );
+	void updateChangedSubDirectories();
 
 	QList<NetworkObjectDirectory *> m_subDirectories;
+	QList<NetworkObjectDirectory *> m_changedSubDirectories;
+	QTimer* m_subDirectoryChangesTimer;
 
 };
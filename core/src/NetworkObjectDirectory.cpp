@@ -22,6 +22,11 @@
  *
  */
 
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSaveFile>
+#include <QSet>
 #include <QTimer>
 
 #include "NetworkObjectDirectory.h"
@@ -84,16 +89,10 @@ const NetworkObject& NetworkObjectDirectory::object( NetworkObject::ModelId pare
 		return m_rootObject;
 	}
 
-	const auto it = m_objects.constFind( parent );
-	if( it != m_objects.end() )
+	const auto index = objectIndex( parent, object );
+	if( index >= 0 )
 	{
-		for( const auto& entry : *it )
-		{
-			if( entry.modelId() == object )
-			{
-				return entry;
-			}
-		}
+		return m_objects.constFind( parent )->at( index );
 	}
 
 	return m_invalidObject;
@@ -103,21 +102,7 @@ const NetworkObject& NetworkObjectDirectory::object( NetworkObject::ModelId pare
 
 int NetworkObjectDirectory::index( NetworkObject::ModelId parent, NetworkObject::ModelId child ) const
 {
-	const auto it = m_objects.constFind( parent );
-	if( it != m_objects.end() )
-	{
-		int index = 0;
-		for( const auto& entry : *it )
-		{
-			if( entry.modelId() == child )
-			{
-				return index;
-			}
-			++index;
-		}
-	}
-
-	return -1;
+	return objectIndex( parent, child );
 }
 
 
@@ -158,20 +143,7 @@ NetworkObject::ModelId NetworkObjectDirectory::parentId( NetworkObject::ModelId
 		return 0;
 	}
 
-	for( auto it = m_objects.constBegin(); it != m_objects.constEnd(); ++it )
-	{
-		const auto& objectList = it.value();
-
-		for( const auto& object : objectList )
-		{
-			if( object.modelId() == child )
-			{
-				return it.key();
-			}
-		}
-	}
-
-	return 0;
+	return m_parentIndex.value( child, 0 );
 }
 
 
@@ -192,6 +164,16 @@ NetworkObjectList NetworkObjectDirectory::queryObjects( NetworkObject::Type type
 		update();
 	}
 
+	if( property == NetworkObject::Property::Uid && value.userType() == QMetaType::QUuid )
+	{
+		return queryObjectsByUid( type, value.toUuid() );
+	}
+
+	if( property == NetworkObject::Property::HostAddress && value.userType() == QMetaType::QString )
+	{
+		return queryObjectsByHostAddress( type, value.toString() );
+	}
+
 	NetworkObjectList objects;
 
 	for( auto it = m_objects.constBegin(); it != m_objects.constEnd(); ++it )
@@ -226,20 +208,32 @@ NetworkObjectList NetworkObjectDirectory::queryParents( const NetworkObject& chi
 		return {};
 	}
 
-	for( auto it = m_objects.constBegin(); it != m_objects.constEnd(); ++it )
+	NetworkObjectList parents;
+
+	auto parentUid = child.parentUid();
+
+	// the number of indexed objects limits the depth in case of (invalid) cyclic references
+	while( parents.size() < m_uidIndex.size() )
 	{
-		const auto& objectList = it.value();
+		const auto it = m_uidIndex.constFind( parentUid );
+		if( it == m_uidIndex.constEnd() )
+		{
+			break;
+		}
 
-		for( const auto& object : objectList )
+		const auto& parentObject = object( parentId( it.value() ), it.value() );
+		if( parentObject.isValid() == false )
 		{
-			if( object.uid() == child.parentUid() )
-			{
-				return queryParents( object ) + NetworkObjectList( { object } );
-			}
+			break;
 		}
+
+		parents.append( parentObject );
+		parentUid = parentObject.parentUid();
 	}
 
-	return {};
+	std::reverse( parents.begin(), parents.end() );
+
+	return parents;
 }
 
 
@@ -257,6 +251,221 @@ void NetworkObjectDirectory::fetchObjects( const NetworkObject& object )
 
 
 
+/*!
+ * \brief Populates the directory with the objects stored in a snapshot file
+ * \param fileName The snapshot file written by saveSnapshot() before
+ * \param etag Identifies the configuration the snapshot has been created with - snapshots
+ * with a different etag are ignored
+ * \return Whether the snapshot has been loaded
+ */
+bool NetworkObjectDirectory::loadSnapshot( const QString& fileName, const QByteArray& etag )
+{
+	QFile file( fileName );
+	if( file.open( QFile::ReadOnly ) == false || file.size() <= 0 )
+	{
+		return false;
+	}
+
+	const auto fileData = file.map( 0, file.size() );
+	if( fileData == nullptr )
+	{
+		vWarning() << "could not map snapshot file" << fileName;
+		return false;
+	}
+
+	const auto data = QByteArray::fromRawData( reinterpret_cast<const char *>( fileData ), int( file.size() ) );
+
+	QDataStream stream( data );
+	stream.setVersion( QDataStream::Qt_5_5 );
+
+	quint32 magic = 0;
+	quint32 version = 0;
+	QByteArray snapshotEtag;
+	quint32 count = 0;
+
+	stream >> magic >> version >> snapshotEtag >> count;
+
+	if( stream.status() != QDataStream::Ok ||
+		magic != SnapshotMagic || version != SnapshotVersion || snapshotEtag != etag )
+	{
+		vDebug() << "ignoring outdated or invalid snapshot" << fileName;
+		return false;
+	}
+
+	QElapsedTimer loadTimer;
+	loadTimer.start();
+
+	// objects are stored breadth-first so all children of a parent are stored consecutively
+	// and can be appended at once
+	NetworkObjectList children;
+	NetworkObject::Uid childrenParentUid;
+	int restoredCount = 0;
+
+	for( quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i )
+	{
+		qint32 type = 0;
+		NetworkObject::Name name;
+		NetworkObject::Uid uid;
+		NetworkObject::Uid parentUid;
+		NetworkObject::Properties properties;
+
+		stream >> type >> name >> uid >> parentUid >> properties;
+
+		if( stream.status() != QDataStream::Ok )
+		{
+			break;
+		}
+
+		if( children.isEmpty() == false && parentUid != childrenParentUid )
+		{
+			restoredCount += restoreObjects( children, childrenParentUid );
+			children.clear();
+		}
+
+		childrenParentUid = parentUid;
+		children.append( NetworkObject{this, NetworkObject::Type(type), name, properties, uid, parentUid} );
+	}
+
+	if( children.isEmpty() == false )
+	{
+		restoredCount += restoreObjects( children, childrenParentUid );
+	}
+
+	file.unmap( fileData );
+
+	if( stream.status() != QDataStream::Ok )
+	{
+		vWarning() << "snapshot" << fileName << "is truncated";
+	}
+
+	vDebug() << "restored" << restoredCount << "of" << count << "objects from snapshot"
+			 << fileName << "in" << loadTimer.elapsed() << "ms";
+
+	return true;
+}
+
+
+
+/*!
+ * \brief Writes all objects of the directory to a snapshot file which can be loaded via loadSnapshot()
+ */
+bool NetworkObjectDirectory::saveSnapshot( const QString& fileName, const QByteArray& etag ) const
+{
+	QSaveFile file( fileName );
+	if( file.open( QFile::WriteOnly ) == false )
+	{
+		vWarning() << "could not write snapshot file" << fileName;
+		return false;
+	}
+
+	// store objects breadth-first so parents always precede their children
+	NetworkObjectList objects;
+	objects.reserve( m_uidIndex.size() );
+
+	QList<NetworkObject::ModelId> containerIds{ rootId() };
+
+	while( containerIds.isEmpty() == false )
+	{
+		const auto objectList = m_objects.value( containerIds.takeFirst() );
+		for( const auto& networkObject : objectList )
+		{
+			objects.append( networkObject );
+
+			if( networkObject.isContainer() )
+			{
+				containerIds.append( networkObject.modelId() );
+			}
+		}
+	}
+
+	QDataStream stream( &file );
+	stream.setVersion( QDataStream::Qt_5_5 );
+
+	stream << SnapshotMagic << SnapshotVersion << etag << quint32( objects.count() );
+
+	for( const auto& networkObject : std::as_const(objects) )
+	{
+		stream << qint32( networkObject.type() ) << networkObject.name()
+			   << networkObject.uid() << networkObject.parentUid() << networkObject.properties();
+	}
+
+	return file.commit();
+}
+
+
+
+int NetworkObjectDirectory::restoreObjects( const NetworkObjectList& objects, const NetworkObject::Uid& parentUid )
+{
+	NetworkObject parent{m_invalidObject};
+	if( parentUid == m_rootObject.uid() )
+	{
+		parent = m_rootObject;
+	}
+	else
+	{
+		const auto parentModelId = m_uidIndex.constFind( parentUid );
+		if( parentModelId != m_uidIndex.constEnd() )
+		{
+			parent = object( parentId( *parentModelId ), *parentModelId );
+		}
+	}
+
+	if( parent.isValid() == false || m_objects.contains( parent.modelId() ) == false )
+	{
+		return 0;
+	}
+
+	const auto parentModelId = parent.modelId();
+
+	NetworkObjectList newObjects;
+	newObjects.reserve( objects.count() );
+	QSet<NetworkObject::ModelId> newObjectIds;
+
+	for( const auto& networkObject : objects )
+	{
+		if( indexedPosition( parentModelId, networkObject.modelId() ) >= 0 )
+		{
+			addOrUpdateObject( networkObject, parent );
+		}
+		else if( newObjectIds.contains( networkObject.modelId() ) == false )
+		{
+			newObjectIds.insert( networkObject.modelId() );
+			newObjects.append( networkObject );
+		}
+	}
+
+	if( newObjects.isEmpty() == false )
+	{
+		auto& objectList = m_objects[parentModelId]; // clazy:exclude=detaching-member
+
+		Q_EMIT objectsAboutToBeInserted( parentModelId, objectList.count(), newObjects.count() );
+
+		objectList.reserve( objectList.count() + newObjects.count() );
+		for( const auto& networkObject : std::as_const(newObjects) )
+		{
+			objectList.append( networkObject );
+			addToIndex( networkObject, parentModelId, objectList.count() - 1 );
+		}
+
+		// insert separately as inserting into m_objects may invalidate objectList
+		for( const auto& networkObject : std::as_const(newObjects) )
+		{
+			if( networkObject.isContainer() && m_objects.contains( networkObject.modelId() ) == false )
+			{
+				m_objects[networkObject.modelId()] = {};
+			}
+		}
+
+		Q_EMIT objectsInserted();
+
+		propagateChildObjectChange( parentModelId );
+	}
+
+	return objects.count();
+}
+
+
+
 bool NetworkObjectDirectory::hasObjects() const
 {
 	return m_objects.size() > 1;
@@ -279,13 +488,14 @@ void NetworkObjectDirectory::addOrUpdateObject( const NetworkObject& networkObje
 	}
 
 	auto& objectList = m_objects[parent.modelId()]; // clazy:exclude=detaching-member
-	const auto index = objectList.indexOf( completeNetworkObject );
+	const auto index = indexedPosition( parent.modelId(), completeNetworkObject.modelId() );
 
 	if( index < 0 )
 	{
 		Q_EMIT objectsAboutToBeInserted(parent.modelId(), objectList.count(), 1);
 
 		objectList.append( completeNetworkObject );
+		addToIndex( completeNetworkObject, parent.modelId(), objectList.count() - 1 );
 		if( completeNetworkObject.isContainer() )
 		{
 			m_objects[completeNetworkObject.modelId()] = {};
@@ -297,7 +507,9 @@ void NetworkObjectDirectory::addOrUpdateObject( const NetworkObject& networkObje
 	}
 	else if( objectList[index].exactMatch( completeNetworkObject ) == false )
 	{
+		removeFromIndex( objectList[index], parent.modelId() );
 		objectList.replace( index, completeNetworkObject );
+		addToIndex( completeNetworkObject, parent.modelId(), index );
 		propagateChildObjectChange(parent.modelId());
 	}
 }
@@ -313,6 +525,7 @@ void NetworkObjectDirectory::removeObjects( const NetworkObject& parent, const N
 
 	auto& objectList = m_objects[parent.modelId()]; // clazy:exclude=detaching-member
 	int index = 0;
+	int firstRemovedIndex = -1;
 	QList<NetworkObject::ModelId> objectsToRemove;
 
 	for( auto it = objectList.begin(); it != objectList.end(); )
@@ -324,7 +537,13 @@ void NetworkObjectDirectory::removeObjects( const NetworkObject& parent, const N
 				objectsToRemove.append( it->modelId() );
 			}
 
+			if( firstRemovedIndex < 0 )
+			{
+				firstRemovedIndex = index;
+			}
+
 			Q_EMIT objectsAboutToBeRemoved(parent.modelId(), index, 1);
+			removeFromIndex( *it, parent.modelId() );
 			it = objectList.erase( it );
 			Q_EMIT objectsRemoved();
 			propagateChildObjectChange(parent.modelId());
@@ -336,8 +555,14 @@ void NetworkObjectDirectory::removeObjects( const NetworkObject& parent, const N
 		}
 	}
 
+	if( firstRemovedIndex >= 0 )
+	{
+		updateIndexPositions( parent.modelId(), firstRemovedIndex );
+	}
+
 	for( const auto& groupId : objectsToRemove )
 	{
+		removeChildObjects( groupId );
 		m_objects.remove( groupId );
 	}
 }
@@ -359,18 +584,12 @@ void NetworkObjectDirectory::replaceObjects( const NetworkObjectList& objects, c
 void NetworkObjectDirectory::setObjectPopulated( const NetworkObject& networkObject )
 {
 	const auto objectModelId = networkObject.modelId();
+	const auto objectParentId = parentId( objectModelId );
 
-	auto it = m_objects.find( parentId( objectModelId ) ); // clazy:exclude=detaching-member
-	if( it != m_objects.end() )
+	const auto index = objectIndex( objectParentId, objectModelId );
+	if( index >= 0 )
 	{
-		for( auto& entry : *it )
-		{
-			if( entry.modelId() == objectModelId )
-			{
-				entry.setPopulated();
-				break;
-			}
-		}
+		m_objects[objectParentId][index].setPopulated(); // clazy:exclude=detaching-member
 	}
 }
 
@@ -412,3 +631,178 @@ void NetworkObjectDirectory::propagateChildObjectChanges()
 
 	m_changedObjectIds.clear();
 }
+
+
+
+int NetworkObjectDirectory::objectIndex( NetworkObject::ModelId parent, NetworkObject::ModelId object ) const
+{
+	const auto it = m_objects.constFind( parent );
+	if( it == m_objects.constEnd() )
+	{
+		return -1;
+	}
+
+	const auto position = m_positionIndex.value( ObjectKey( parent, object ), -1 );
+	if( position >= 0 &&
+		position < it->count() &&
+		it->at( position ).modelId() == object )
+	{
+		return position;
+	}
+
+	// positions are not up to date while objects are being removed in removeObjects()
+	// and signals emitted from there cause model lookups, so search as usual then
+	int index = 0;
+	for( const auto& entry : *it )
+	{
+		if( entry.modelId() == object )
+		{
+			return index;
+		}
+		++index;
+	}
+
+	return -1;
+}
+
+
+
+int NetworkObjectDirectory::indexedPosition( NetworkObject::ModelId parent, NetworkObject::ModelId object ) const
+{
+	// only valid outside removeObjects() - use objectIndex() for lookups which may happen there
+	return m_positionIndex.value( ObjectKey( parent, object ), -1 );
+}
+
+
+
+NetworkObjectList NetworkObjectDirectory::queryObjectsByUid( NetworkObject::Type type, const NetworkObject::Uid& uid ) const
+{
+	NetworkObjectList objects;
+
+	const auto it = m_uidIndex.constFind( uid );
+	if( it != m_uidIndex.constEnd() )
+	{
+		const auto parents = m_parentIndex.values( it.value() );
+		for( const auto parent : parents )
+		{
+			const auto& networkObject = object( parent, it.value() );
+			if( networkObject.isValid() &&
+				( type == NetworkObject::Type::None || networkObject.type() == type ) )
+			{
+				objects.append( networkObject );
+			}
+		}
+	}
+
+	return objects;
+}
+
+
+
+NetworkObjectList NetworkObjectDirectory::queryObjectsByHostAddress( NetworkObject::Type type,
+																	 const QString& hostAddress ) const
+{
+	NetworkObjectList objects;
+
+	const HostAddress address( hostAddress );
+
+	// host addresses are compared in the format they're stored in so convert the queried
+	// address once per format in use instead of once per object
+	for( auto it = m_hostAddressIndex.constBegin(), end = m_hostAddressIndex.constEnd(); it != end; ++it )
+	{
+		const auto objectKeys = it.value().value( address.convert( it.key() ).toLower() );
+		for( const auto& objectKey : objectKeys )
+		{
+			const auto& networkObject = object( objectKey.first, objectKey.second );
+			if( networkObject.isValid() &&
+				( type == NetworkObject::Type::None || networkObject.type() == type ) )
+			{
+				objects.append( networkObject );
+			}
+		}
+	}
+
+	return objects;
+}
+
+
+
+void NetworkObjectDirectory::addToIndex( const NetworkObject& object, NetworkObject::ModelId parent, int index )
+{
+	const auto modelId = object.modelId();
+
+	m_uidIndex[object.uid()] = modelId;
+	m_parentIndex.insert( modelId, parent );
+	m_positionIndex[ObjectKey( parent, modelId )] = index;
+
+	const auto hostAddress = object.property( NetworkObject::Property::HostAddress );
+	if( hostAddress.userType() == QMetaType::QString && hostAddress.toString().isEmpty() == false )
+	{
+		const auto addressType = HostAddress( hostAddress.toString() ).type();
+		m_hostAddressIndex[addressType][hostAddress.toString().toLower()].append( ObjectKey( parent, modelId ) );
+	}
+}
+
+
+
+void NetworkObjectDirectory::removeFromIndex( const NetworkObject& object, NetworkObject::ModelId parent )
+{
+	const auto modelId = object.modelId();
+
+	// keep other copies of the object indexed
+	m_parentIndex.remove( modelId, parent );
+	if( m_parentIndex.contains( modelId ) == false )
+	{
+		m_uidIndex.remove( object.uid() );
+	}
+	m_positionIndex.remove( ObjectKey( parent, modelId ) );
+
+	const auto hostAddress = object.property( NetworkObject::Property::HostAddress );
+	if( hostAddress.userType() == QMetaType::QString && hostAddress.toString().isEmpty() == false )
+	{
+		const auto addressType = HostAddress( hostAddress.toString() ).type();
+		const auto key = hostAddress.toString().toLower();
+
+		auto& addresses = m_hostAddressIndex[addressType];
+		auto& objectKeys = addresses[key];
+		objectKeys.removeAll( ObjectKey( parent, modelId ) );
+		if( objectKeys.isEmpty() )
+		{
+			addresses.remove( key );
+		}
+		if( addresses.isEmpty() )
+		{
+			m_hostAddressIndex.remove( addressType );
+		}
+	}
+}
+
+
+
+void NetworkObjectDirectory::removeChildObjects( NetworkObject::ModelId parent )
+{
+	const auto children = m_objects.value( parent );
+
+	for( const auto& child : children )
+	{
+		removeFromIndex( child, parent );
+
+		if( child.isContainer() )
+		{
+			removeChildObjects( child.modelId() );
+			m_objects.remove( child.modelId() );
+		}
+	}
+}
+
+
+
+void NetworkObjectDirectory::updateIndexPositions( NetworkObject::ModelId parent, int startIndex )
+{
+	const auto& objectList = m_objects[parent]; // clazy:exclude=detaching-member
+
+	for( int index = startIndex, count = objectList.count(); index < count; ++index )
+	{
+		m_positionIndex[ObjectKey( parent, objectList.at( index ).modelId() )] = index;
+	}
+}
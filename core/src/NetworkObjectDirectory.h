@@ -25,8 +25,10 @@
 #pragma once
 
 #include <QHash>
+#include <QMap>
 #include <QObject>
 
+#include "HostAddress.h"
 #include "NetworkObject.h"
 
 class QTimer;
@@ -72,6 +74,12 @@ public:
 	virtual void update() = 0;
 	virtual void fetchObjects( const NetworkObject& object );
 
+	// emits pending objectChanged() signals immediately instead of after ObjectChangePropagationTimeout
+	void propagateChildObjectChanges();
+
+	bool loadSnapshot( const QString& fileName, const QByteArray& etag );
+	bool saveSnapshot( const QString& fileName, const QByteArray& etag ) const;
+
 protected:
 	using NetworkObjectFilter = std::function<bool (const NetworkObject &)>;
 
@@ -81,10 +89,26 @@ protected:
 	void replaceObjects( const NetworkObjectList& objects, const NetworkObject& parent );
 	void setObjectPopulated( const NetworkObject& networkObject );
 	void propagateChildObjectChange(NetworkObject::ModelId objectId, int depth = 0);
-	void propagateChildObjectChanges();
 
 private:
 	static constexpr auto ObjectChangePropagationTimeout = 100;
+	static constexpr quint32 SnapshotMagic = 0x564e4f44; // "VNOD"
+	static constexpr quint32 SnapshotVersion = 1;
+
+	using ObjectKey = QPair<NetworkObject::ModelId, NetworkObject::ModelId>; // parent, object
+	using ObjectKeyList = QVector<ObjectKey>;
+
+	int objectIndex( NetworkObject::ModelId parent, NetworkObject::ModelId object ) const;
+	int indexedPosition( NetworkObject::ModelId parent, NetworkObject::ModelId object ) const;
+	NetworkObjectList queryObjectsByUid( NetworkObject::Type type, const NetworkObject::Uid& uid ) const;
+	NetworkObjectList queryObjectsByHostAddress( NetworkObject::Type type, const QString& hostAddress ) const;
+
+	int restoreObjects( const NetworkObjectList& objects, const NetworkObject::Uid& parentUid );
+
+	void addToIndex( const NetworkObject& object, NetworkObject::ModelId parent, int index );
+	void removeFromIndex( const NetworkObject& object, NetworkObject::ModelId parent );
+	void removeChildObjects( NetworkObject::ModelId parent );
+	void updateIndexPositions( NetworkObject::ModelId parent, int startIndex );
 
 	const QString m_name;
 	QTimer* m_updateTimer = nullptr;
@@ -95,6 +119,13 @@ private:
 	NetworkObjectList m_defaultObjectList{};
 	QList<NetworkObject::ModelId> m_changedObjectIds;
 
+	// secondary indexes for all objects stored in m_objects, maintained in addOrUpdateObject() and removeObjects() -
+	// the same object (i.e. model ID) can be stored in multiple parents, e.g. a computer in multiple locations
+	QHash<NetworkObject::Uid, NetworkObject::ModelId> m_uidIndex{};
+	QMultiHash<NetworkObject::ModelId, NetworkObject::ModelId> m_parentIndex{};
+	QHash<ObjectKey, int> m_positionIndex{};
+	QMap<HostAddress::Type, QHash<QString, ObjectKeyList>> m_hostAddressIndex{};
+
 Q_SIGNALS:
 	void objectsAboutToBeInserted(NetworkObject::ModelId parentId, int index, int count);
 	void objectsInserted();
@@ -22,6 +22,12 @@
  *
  */
 
+#include <QCryptographicHash>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "Filesystem.h"
 #include "VeyonConfiguration.h"
 #include "NetworkObjectDirectoryManager.h"
 #include "NetworkObjectDirectoryPluginInterface.h"
@@ -71,6 +77,37 @@ NetworkObjectDirectory* NetworkObjectDirectoryManager::configuredDirectory()
 
 
 
+/*!
+ * \brief Populates the configured directory with the objects known from the last run so they
+ * can be shown immediately while the directory is being updated
+ */
+bool NetworkObjectDirectoryManager::loadSnapshot()
+{
+	const auto directory = configuredDirectory();
+
+	// objects of nested directories refer to their sub directories which can't be restored
+	if( directory == nullptr || qobject_cast<NestedNetworkObjectDirectory *>( directory ) )
+	{
+		return false;
+	}
+
+	return directory->loadSnapshot( snapshotFilePath(), snapshotEtag() );
+}
+
+
+
+bool NetworkObjectDirectoryManager::saveSnapshot()
+{
+	if( m_configuredDirectory == nullptr || qobject_cast<NestedNetworkObjectDirectory *>( m_configuredDirectory ) )
+	{
+		return false;
+	}
+
+	return m_configuredDirectory->saveSnapshot( snapshotFilePath(), snapshotEtag() );
+}
+
+
+
 NetworkObjectDirectory* NetworkObjectDirectoryManager::createDirectory( Plugin::Uid uid, QObject* parent )
 {
 	const auto plugin = m_plugins.value( uid );
@@ -156,3 +193,23 @@ bool NetworkObjectDirectoryManager::isEnabled( NetworkObjectDirectoryPluginInter
 
 	return false;
 }
+
+
+
+QString NetworkObjectDirectoryManager::snapshotFilePath() const
+{
+	const auto path = VeyonCore::filesystem().expandPath( VeyonCore::config().userConfigurationDirectory() );
+
+	VeyonCore::filesystem().ensurePathExists( path );
+
+	return QDir( path ).absoluteFilePath( QStringLiteral("NetworkObjectDirectory.snapshot") );
+}
+
+
+
+QByteArray NetworkObjectDirectoryManager::snapshotEtag()
+{
+	// invalidate snapshots whenever the configuration changes
+	return QCryptographicHash::hash( QJsonDocument( QJsonObject::fromVariantMap( VeyonCore::config().data() ) ).toJson(),
+									 QCryptographicHash::Sha1 );
+}
@@ -46,6 +46,9 @@ public:
 
 	NetworkObjectDirectory* configuredDirectory();
 
+	bool loadSnapshot();
+	bool saveSnapshot();
+
 	NetworkObjectDirectory* createDirectory( Plugin::Uid uid, QObject* parent );
 
 	void setEnabled( Plugin::Uid uid, bool enabled );
@@ -55,6 +58,9 @@ public:
 	bool isEnabled( NetworkObjectDirectoryPluginInterface* plugin ) const;
 
 private:
+	QString snapshotFilePath() const;
+	static QByteArray snapshotEtag();
+
 	Plugins m_plugins{};
 	NetworkObjectDirectory* m_configuredDirectory{nullptr};
 
@@ -58,10 +58,14 @@ public:
 	virtual bool isRunningAsAdmin() const = 0;
 	virtual bool runProgramAsAdmin( const QString& program, const QStringList& parameters ) = 0;
 
+	// extraEnvironment holds additional variables in "NAME=value" format and processId
+	// receives the ID of the started process if given
 	virtual bool runProgramAsUser( const QString& program,
 								   const QStringList& parameters,
 								   const QString& username,
-								   const QString& desktop ) = 0;
+								   const QString& desktop,
+								   const QStringList& extraEnvironment = {},
+								   qint64* processId = nullptr ) = 0;
 
 	virtual QString genericUrlHandler() const = 0;
 
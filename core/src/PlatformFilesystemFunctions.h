@@ -37,6 +37,10 @@ public:
 	virtual QString globalAppDataPath() const = 0;
 	virtual QString globalTempPath() const = 0;
 
+	// returns a directory on the local host which is only accessible by the account running the
+	// current process and creates it if necessary - returns an empty string on failure
+	virtual QString privateHostDataPath() = 0;
+
 	virtual QString fileOwnerGroup( const QString& filePath ) = 0;
 	virtual bool setFileOwnerGroup( const QString& filePath, const QString& ownerGroup ) = 0;
 	virtual bool setFileOwnerGroupPermissions( const QString& filePath, QFile::Permissions permissions ) = 0;
@@ -45,4 +45,9 @@ public:
 
 	virtual bool configureSocketKeepalive( Socket socket, bool enabled, int idleTime, int interval, int probes ) = 0;
 
+	// write as much data of the given buffers as possible to a non-blocking socket with
+	// a single system call, starting at offset in buffers[firstBuffer]; returns the
+	// number of bytes written, 0 if the socket would block or -1 on errors
+	virtual qint64 writeGathered( Socket socket, const QVector<QByteArray>& buffers, int firstBuffer, qint64 offset ) = 0;
+
 };
@@ -0,0 +1,450 @@
+/*
+ * Tracer.cpp - low-overhead binary event tracing
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <csignal>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "Tracer.h"
+
+namespace {
+
+struct EventInfo
+{
+	const char* name;
+	std::array<const char*, Tracer::MaximumArgumentCount> argumentNames;
+};
+
+const std::array<EventInfo, int(Tracer::Event::Count)> eventInfos{ {
+	{ "VncConnection::handleMessages", { "messageCount", "success", nullptr } },
+	{ "VncClientProtocol::receiveMessage", { "messageType", "bufferedBytes", nullptr } },
+	{ "DemoServerStream::enqueueFramebufferUpdateMessage", { "messageSize", "isKeyFrame", "queueSize" } },
+	{ "FeatureMessage::send", { "feature", "command", "argumentCount" } },
+	{ "FeatureMessage::receive", { "feature", "command", "argumentCount" } },
+	{ "ComputerControlServer::handleFeatureMessage", { "feature", "command", nullptr } },
+} };
+
+
+struct ThreadBuffer
+{
+	std::atomic<bool> inUse{true};
+	std::atomic<quint64> writeIndex{0};
+	std::array<Tracer::Record, Tracer::RingBufferSize> records{};
+};
+
+// buffers are never freed but handed over to new threads once their owning thread has finished;
+// the list is fixed-size and lock-free so it can be walked from a signal handler
+constexpr int MaximumThreadBufferCount = 256;
+std::array<std::atomic<ThreadBuffer*>, MaximumThreadBufferCount> threadBuffers{};
+std::atomic<int> threadBufferCount{0};
+std::atomic<quint32> nextThreadId{1};
+
+// built once in Tracer::init() so dumping from a signal handler does not have to allocate memory
+QByteArray traceFileName;
+qint64 processId = 0;
+
+
+ThreadBuffer* acquireThreadBuffer()
+{
+	const auto count = qMin( threadBufferCount.load( std::memory_order_acquire ), MaximumThreadBufferCount );
+	for( int i = 0; i < count; ++i )
+	{
+		const auto buffer = threadBuffers[size_t(i)].load( std::memory_order_acquire );
+		bool inUse = false;
+		if( buffer && buffer->inUse.compare_exchange_strong( inUse, true ) )
+		{
+			return buffer;
+		}
+	}
+
+	const auto index = threadBufferCount.fetch_add( 1 );
+	if( index >= MaximumThreadBufferCount )
+	{
+		return nullptr;
+	}
+
+	const auto buffer = new ThreadBuffer;
+	threadBuffers[size_t(index)].store( buffer, std::memory_order_release );
+
+	return buffer;
+}
+
+
+class ThreadBufferHandle
+{
+public:
+	ThreadBufferHandle() :
+		m_buffer( acquireThreadBuffer() ),
+		m_threadId( nextThreadId.fetch_add( 1, std::memory_order_relaxed ) )
+	{
+	}
+
+	~ThreadBufferHandle()
+	{
+		if( m_buffer )
+		{
+			m_buffer->inUse.store( false, std::memory_order_release );
+		}
+	}
+
+	Q_DISABLE_COPY(ThreadBufferHandle)
+
+	ThreadBuffer* buffer() const
+	{
+		return m_buffer;
+	}
+
+	quint32 threadId() const
+	{
+		return m_threadId;
+	}
+
+private:
+	ThreadBuffer* const m_buffer;
+	const quint32 m_threadId;
+};
+
+
+// only async-signal-safe functions are used for writing trace files since Tracer::dump()
+// is called from signal handlers - stdio functions may deadlock or corrupt their state there
+int openTraceFile()
+{
+#ifdef Q_OS_WIN
+	return _open( traceFileName.constData(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE );
+#else
+	return open( traceFileName.constData(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR );
+#endif
+}
+
+
+
+bool writeTraceData( int fd, const void* data, size_t size )
+{
+	auto bytes = static_cast<const char *>( data );
+
+	while( size > 0 )
+	{
+#ifdef Q_OS_WIN
+		const auto written = _write( fd, bytes, unsigned( qMin<size_t>( size, INT_MAX ) ) );
+#else
+		const auto written = write( fd, bytes, size );
+		if( written < 0 && errno == EINTR )
+		{
+			continue;
+		}
+#endif
+		if( written <= 0 )
+		{
+			return false;
+		}
+
+		bytes += written;
+		size -= size_t(written);
+	}
+
+	return true;
+}
+
+
+
+bool closeTraceFile( int fd )
+{
+#ifdef Q_OS_WIN
+	return _close( fd ) == 0;
+#else
+	return close( fd ) == 0;
+#endif
+}
+
+
+
+void handleSignal( int signalNumber )
+{
+	Tracer::dump();
+
+#ifdef Q_OS_LINUX
+	if( signalNumber == SIGUSR1 )
+	{
+		return;
+	}
+#endif
+
+	std::signal( signalNumber, SIG_DFL );
+	std::raise( signalNumber );
+}
+
+}
+
+
+std::atomic<bool> Tracer::s_enabled{false};
+
+
+void Tracer::init( const QString& appName )
+{
+	const auto traceDirectory = QString::fromLocal8Bit( qgetenv( traceDirectoryEnvironmentVariable() ) );
+	if( traceDirectory.isEmpty() )
+	{
+		return;
+	}
+
+	processId = QCoreApplication::applicationPid();
+
+	// multiple instances of the same component (e.g. feature workers) may run at the same time
+	traceFileName = QFile::encodeName( QDir( traceDirectory ).absoluteFilePath(
+										   QStringLiteral( "Veyon%1-%2.trace" ).arg( appName ).arg( processId ) ) );
+
+	std::signal( SIGABRT, handleSignal );
+	std::signal( SIGSEGV, handleSignal );
+#ifdef Q_OS_LINUX
+	std::signal( SIGUSR1, handleSignal );
+#endif
+
+	s_enabled = true;
+}
+
+
+
+void Tracer::record( Event event, Phase phase, qint64 arg0, qint64 arg1, qint64 arg2 )
+{
+	thread_local const ThreadBufferHandle threadBuffer;
+
+	const auto buffer = threadBuffer.buffer();
+	if( buffer == nullptr )
+	{
+		return;
+	}
+
+	// each buffer has exactly one writer so there's no need for an atomic increment
+	const auto index = buffer->writeIndex.load( std::memory_order_relaxed );
+
+	auto& record = buffer->records[index % RingBufferSize];
+	record.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+						   std::chrono::steady_clock::now().time_since_epoch() ).count();
+	record.threadId = threadBuffer.threadId();
+	record.event = quint16(event);
+	record.phase = quint8(phase);
+	record.reserved = 0;
+	record.arguments[0] = arg0;
+	record.arguments[1] = arg1;
+	record.arguments[2] = arg2;
+
+	buffer->writeIndex.store( index + 1, std::memory_order_release );
+}
+
+
+
+bool Tracer::dump()
+{
+	if( isEnabled() == false )
+	{
+		return false;
+	}
+
+	const auto fd = openTraceFile();
+	if( fd < 0 )
+	{
+		return false;
+	}
+
+	const auto count = qMin( threadBufferCount.load( std::memory_order_acquire ), MaximumThreadBufferCount );
+
+	std::array<quint64, MaximumThreadBufferCount> writeIndexes{};
+	FileHeader header{ FileMagic, FileVersion, quint32(sizeof(Record)), quint32(processId), 0 };
+
+	for( int i = 0; i < count; ++i )
+	{
+		const auto buffer = threadBuffers[size_t(i)].load( std::memory_order_acquire );
+		if( buffer )
+		{
+			writeIndexes[size_t(i)] = buffer->writeIndex.load( std::memory_order_acquire );
+			header.recordCount += qMin<quint64>( writeIndexes[size_t(i)], quint64(RingBufferSize) );
+		}
+	}
+
+	auto success = writeTraceData( fd, &header, sizeof(header) );
+
+	for( int i = 0; i < count && success; ++i )
+	{
+		const auto buffer = threadBuffers[size_t(i)].load( std::memory_order_acquire );
+		const auto writeIndex = writeIndexes[size_t(i)];
+		if( buffer == nullptr || writeIndex == 0 )
+		{
+			continue;
+		}
+
+		if( writeIndex <= quint64(RingBufferSize) )
+		{
+			success = writeTraceData( fd, buffer->records.data(), sizeof(Record) * writeIndex );
+		}
+		else
+		{
+			// write oldest records first
+			const auto start = writeIndex % RingBufferSize;
+			success = writeTraceData( fd, buffer->records.data() + start, sizeof(Record) * ( RingBufferSize - start ) ) &&
+					  writeTraceData( fd, buffer->records.data(), sizeof(Record) * start );
+		}
+	}
+
+	return closeTraceFile( fd ) && success;
+}
+
+
+
+const char* Tracer::eventName( Event event )
+{
+	if( event < Event::Count )
+	{
+		return eventInfos[size_t(event)].name;
+	}
+
+	return "Unknown";
+}
+
+
+
+QStringList Tracer::argumentNames( Event event )
+{
+	QStringList names;
+
+	if( event < Event::Count )
+	{
+		for( const auto name : eventInfos[size_t(event)].argumentNames )
+		{
+			if( name )
+			{
+				names.append( QLatin1String(name) );
+			}
+		}
+	}
+
+	return names;
+}
+
+
+
+bool Tracer::convertToChromeTrace( const QString& traceFileName, const QString& outputFileName )
+{
+	QFile traceFile( traceFileName );
+	if( traceFile.open( QFile::ReadOnly ) == false )
+	{
+		vCritical() << "could not open trace file" << traceFileName;
+		return false;
+	}
+
+	FileHeader header{};
+	if( traceFile.read( reinterpret_cast<char *>( &header ), sizeof(header) ) != sizeof(header) ||
+		header.magic != FileMagic ||
+		header.version != FileVersion ||
+		header.recordSize != sizeof(Record) )
+	{
+		vCritical() << "invalid trace file" << traceFileName;
+		return false;
+	}
+
+	const auto data = traceFile.readAll();
+	const auto recordCount = qMin<quint64>( header.recordCount, quint64(data.size()) / sizeof(Record) );
+
+	QVector<Record> records( int(recordCount) );
+	memcpy( records.data(), data.constData(), recordCount * sizeof(Record) ); // Flawfinder: ignore
+
+	std::stable_sort( records.begin(), records.end(), []( const Record& a, const Record& b ) {
+		return a.timestamp < b.timestamp;
+	} );
+
+	const auto startTimestamp = records.isEmpty() ? 0 : records.constFirst().timestamp;
+
+	QJsonArray traceEvents;
+
+	for( const auto& record : std::as_const(records) )
+	{
+		const auto event = Event(record.event);
+		if( event >= Event::Count )
+		{
+			continue;
+		}
+
+		QJsonObject traceEvent{
+			{ QStringLiteral("name"), QLatin1String( eventName( event ) ) },
+			{ QStringLiteral("cat"), QStringLiteral("veyon") },
+			{ QStringLiteral("ts"), double( record.timestamp - startTimestamp ) / 1000 },
+			{ QStringLiteral("pid"), qint64(header.processId) },
+			{ QStringLiteral("tid"), qint64(record.threadId) }
+		};
+
+		switch( Phase(record.phase) )
+		{
+		case Phase::Begin: traceEvent[QStringLiteral("ph")] = QStringLiteral("B"); break;
+		case Phase::End: traceEvent[QStringLiteral("ph")] = QStringLiteral("E"); break;
+		default:
+			traceEvent[QStringLiteral("ph")] = QStringLiteral("i");
+			traceEvent[QStringLiteral("s")] = QStringLiteral("t");
+			break;
+		}
+
+		// arguments of begin and end events are merged so skip empty end arguments
+		const auto hasArguments = std::any_of( std::begin(record.arguments), std::end(record.arguments),
+											   []( qint64 argument ) { return argument != 0; } );
+		if( Phase(record.phase) != Phase::End || hasArguments )
+		{
+			QJsonObject arguments;
+			const auto names = argumentNames( event );
+			for( int i = 0; i < names.count(); ++i )
+			{
+				arguments[names[i]] = record.arguments[i];
+			}
+			traceEvent[QStringLiteral("args")] = arguments;
+		}
+
+		traceEvents.append( traceEvent );
+	}
+
+	QFile outputFile( outputFileName );
+	if( outputFile.open( QFile::WriteOnly | QFile::Truncate ) == false )
+	{
+		vCritical() << "could not write output file" << outputFileName;
+		return false;
+	}
+
+	outputFile.write( QJsonDocument( QJsonObject{ { QStringLiteral("traceEvents"), traceEvents } } ).toJson( QJsonDocument::Compact ) );
+
+	return true;
+}
@@ -0,0 +1,148 @@
+/*
+ * Tracer.h - low-overhead binary event tracing
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include "VeyonCore.h"
+
+// Records compact binary events into per-thread ring buffers. Tracing is disabled unless the
+// environment variable returned by traceDirectoryEnvironmentVariable() is set. The buffers are
+// dumped into a file in this directory on exit, on crash and on request (SIGUSR1 on Linux). Dumped
+// files can be converted to the Chrome trace event format (readable by Perfetto) via
+// "veyon-cli trace convert".
+class VEYON_CORE_EXPORT Tracer
+{
+public:
+	enum class Event : quint16
+	{
+		VncConnectionHandleMessages,
+		VncClientProtocolReceiveMessage,
+		DemoServerEnqueueFramebufferUpdate,
+		FeatureMessageSend,
+		FeatureMessageReceive,
+		ComputerControlServerHandleFeatureMessage,
+		Count
+	};
+
+	enum class Phase : quint8
+	{
+		Begin,
+		End,
+		Instant
+	};
+
+	static constexpr int MaximumArgumentCount = 3;
+	static constexpr int RingBufferSize = 2048;
+	static constexpr quint32 FileMagic = 0x43525456; // "VTRC"
+	static constexpr quint32 FileVersion = 1;
+
+	struct Record
+	{
+		qint64 timestamp;
+		quint32 threadId;
+		quint16 event;
+		quint8 phase;
+		quint8 reserved;
+		qint64 arguments[MaximumArgumentCount];
+	};
+
+	struct FileHeader
+	{
+		quint32 magic;
+		quint32 version;
+		quint32 recordSize;
+		quint32 processId;
+		quint64 recordCount;
+	};
+
+	class Scope
+	{
+	public:
+		explicit Scope( Event event, qint64 arg0 = 0, qint64 arg1 = 0, qint64 arg2 = 0 ) :
+			m_event( event )
+		{
+			if( isEnabled() )
+			{
+				record( m_event, Phase::Begin, arg0, arg1, arg2 );
+			}
+		}
+
+		~Scope()
+		{
+			if( isEnabled() )
+			{
+				record( m_event, Phase::End, m_endArguments[0], m_endArguments[1], m_endArguments[2] );
+			}
+		}
+
+		Q_DISABLE_COPY(Scope)
+
+		// attach arguments which are only known at the end of the scope
+		void setEndArguments( qint64 arg0, qint64 arg1 = 0, qint64 arg2 = 0 )
+		{
+			m_endArguments[0] = arg0;
+			m_endArguments[1] = arg1;
+			m_endArguments[2] = arg2;
+		}
+
+	private:
+		const Event m_event;
+		qint64 m_endArguments[MaximumArgumentCount]{};
+	};
+
+	static const char* traceDirectoryEnvironmentVariable()
+	{
+		return "VEYON_TRACE_DIRECTORY";
+	}
+
+	static void init( const QString& appName );
+
+	static bool isEnabled()
+	{
+		return s_enabled.load( std::memory_order_relaxed );
+	}
+
+	static void record( Event event, Phase phase, qint64 arg0 = 0, qint64 arg1 = 0, qint64 arg2 = 0 );
+
+	static void trace( Event event, qint64 arg0 = 0, qint64 arg1 = 0, qint64 arg2 = 0 )
+	{
+		if( isEnabled() )
+		{
+			record( event, Phase::Instant, arg0, arg1, arg2 );
+		}
+	}
+
+	static bool dump();
+
+	static const char* eventName( Event event );
+	static QStringList argumentNames( Event event );
+
+	static bool convertToChromeTrace( const QString& traceFileName, const QString& outputFileName );
+
+private:
+	static std::atomic<bool> s_enabled;
+
+};
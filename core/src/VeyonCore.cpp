@@ -34,6 +34,7 @@
 #include <QLibraryInfo>
 #include <QProcessEnvironment>
 #include <QRegularExpression>
+#include <QSaveFile>
 #include <QSslConfiguration>
 #include <QSslKey>
 #include <QStyleFactory>
@@ -53,6 +54,7 @@
 #include "PlatformSessionFunctions.h"
 #include "PluginManager.h"
 #include "QmlCore.h"
+#include "Tracer.h"
 #include "TranslationLoader.h"
 #include "UserGroupsBackendManager.h"
 #include "VeyonConfiguration.h"
@@ -98,8 +100,6 @@ VeyonCore::VeyonCore( QCoreApplication* application, Component component, const
 
 	initCryptoCore();
 
-	initTlsConfiguration();
-
 	initQmlCore();
 
 	initAuthenticationCredentials();
@@ -134,6 +134,8 @@ VeyonCore::~VeyonCore()
 	delete m_builtinFeatures;
 	m_builtinFeatures = nullptr;
 
+	Tracer::dump();
+
 	delete m_logger;
 	m_logger = nullptr;
 
@@ -588,14 +590,13 @@ void VeyonCore::initLogging( const QString& appComponentName )
 {
 	const auto currentSessionId = sessionId();
 
-	if( currentSessionId != PlatformSessionFunctions::DefaultSessionId )
-	{
-		m_logger = new Logger( QStringLiteral("%1-%2").arg( appComponentName ).arg( currentSessionId ) );
-	}
-	else
-	{
-		m_logger = new Logger( appComponentName );
-	}
+	const auto appName = currentSessionId != PlatformSessionFunctions::DefaultSessionId ?
+							 QStringLiteral("%1-%2").arg( appComponentName ).arg( currentSessionId ) :
+							 appComponentName;
+
+	m_logger = new Logger( appName );
+
+	Tracer::init( appName );
 
 	m_debugging = ( m_logger->logLevel() >= Logger::LogLevel::Debug );
 
@@ -705,8 +706,26 @@ void VeyonCore::initSystemInfo()
 
 
 
+VeyonCore::TlsConfiguration VeyonCore::tlsConfiguration()
+{
+	instance()->initTlsConfiguration();
+
+	return TlsConfiguration::defaultConfiguration();
+}
+
+
+
 void VeyonCore::initTlsConfiguration()
 {
+	QMutexLocker locker( &m_tlsConfigurationMutex );
+
+	if( m_tlsConfigurationInitialized )
+	{
+		return;
+	}
+
+	m_tlsConfigurationInitialized = true;
+
 	auto tlsConfig{TlsConfiguration::defaultConfiguration()};
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
@@ -826,18 +845,46 @@ bool VeyonCore::loadCertificateAuthorityFiles( TlsConfiguration* tlsConfig )
 
 bool VeyonCore::addSelfSignedHostCertificate( TlsConfiguration* tlsConfig )
 {
-	const auto privateKey = cryptoCore().createPrivateKey();
+	// creating a key pair is expensive so reuse the key and certificate created by previous processes
+	const auto privateKeyFilePath = tlsHostIdentityFilePath( QStringLiteral("TlsHostPrivateKey.pem") );
+	const auto certFilePath = tlsHostIdentityFilePath( QStringLiteral("TlsHostCertificate.pem") );
+
+	QFile privateKeyFile( privateKeyFilePath );
+	auto privateKey = privateKeyFile.open( QFile::ReadOnly ) ?
+						  CryptoCore::PrivateKey::fromPEM( QString::fromUtf8( privateKeyFile.readAll() ) ) :
+						  CryptoCore::PrivateKey{};
 	if( privateKey.isNull() )
 	{
-		vCritical() << "failed to create private key for host certificate";
-		return false;
+		privateKey = cryptoCore().createPrivateKey();
+		if( privateKey.isNull() )
+		{
+			vCritical() << "failed to create private key for host certificate";
+			return false;
+		}
+
+		writeTlsHostIdentityFile( privateKeyFilePath, privateKey.toPEM() );
 	}
 
-	const auto cert = cryptoCore().createSelfSignedHostCertificate( privateKey );
-	if( cert.isNull() )
+	QFile certFile( certFilePath );
+	auto cert = certFile.open( QFile::ReadOnly ) ?
+					CryptoCore::Certificate::fromPEM( QString::fromUtf8( certFile.readAll() ) ) :
+					CryptoCore::Certificate{};
+
+	// renew certificates which are about to expire, have been created for a different host name
+	// or do not belong to the private key
+	if( cert.isNull() ||
+		cert.notValidAfter() < QDateTime::currentDateTime().addDays( 1 ) ||
+		cert.commonName() != HostAddress::localFQDN() ||
+		cert.subjectPublicKey() != privateKey.toPublicKey() )
 	{
-		vCritical() << "failed to create host certificate";
-		return false;
+		cert = cryptoCore().createSelfSignedHostCertificate( privateKey );
+		if( cert.isNull() )
+		{
+			vCritical() << "failed to create host certificate";
+			return false;
+		}
+
+		writeTlsHostIdentityFile( certFilePath, cert.toPEM() );
 	}
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
@@ -850,3 +897,42 @@ bool VeyonCore::addSelfSignedHostCertificate( TlsConfiguration* tlsConfig )
 
 	return true;
 }
+
+
+
+QString VeyonCore::tlsHostIdentityFilePath( const QString& fileName ) const
+{
+	// the identity belongs to the host and the account using it, so it must not be stored in
+	// a configurable, possibly roaming or shared location like the user configuration directory
+	const auto path = platform().filesystemFunctions().privateHostDataPath();
+	if( path.isEmpty() )
+	{
+		return {};
+	}
+
+	return QDir( path ).absoluteFilePath( fileName );
+}
+
+
+
+bool VeyonCore::writeTlsHostIdentityFile( const QString& filePath, const QString& data )
+{
+	if( filePath.isEmpty() )
+	{
+		return false;
+	}
+
+	// write to a temporary file and rename it afterwards so concurrently starting processes
+	// never read incomplete files
+	QSaveFile file( filePath );
+	if( file.open( QFile::WriteOnly ) == false ||
+		file.setPermissions( QFile::ReadOwner | QFile::WriteOwner ) == false )
+	{
+		vWarning() << "could not write" << filePath;
+		return false;
+	}
+
+	file.write( data.toUtf8() );
+
+	return file.commit();
+}
@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <QMutex>
 #include <QObject>
 #include <QtEndian>
 #include <QVersionNumber>
@@ -183,6 +184,10 @@ public:
 		return *( instance()->m_filesystem );
 	}
 
+	// initializes the TLS configuration on first use so components without TLS connections
+	// do not have to load or create any keys and certificates
+	static TlsConfiguration tlsConfiguration();
+
 	static void setupApplicationParameters();
 
 	static int sessionId()
@@ -225,6 +230,9 @@ private:
 	bool loadCertificateAuthorityFiles( TlsConfiguration* tlsConfig );
 	bool addSelfSignedHostCertificate( TlsConfiguration* tlsConfig );
 
+	QString tlsHostIdentityFilePath( const QString& fileName ) const;
+	static bool writeTlsHostIdentityFile( const QString& filePath, const QString& data );
+
 	static VeyonCore* s_instance;
 
 	Filesystem* m_filesystem;
@@ -248,6 +256,9 @@ private:
 
 	int m_sessionId{0};
 
+	QMutex m_tlsConfigurationMutex;
+	bool m_tlsConfigurationInitialized{false};
+
 Q_SIGNALS:
 	void initialized();
 	void applicationLoaded();
@@ -50,4 +50,6 @@ public:
 
 	virtual void setMinimumFramebufferUpdateInterval(const MessageContext& context, int interval) = 0;
 
+	virtual void setFramebufferScale(const MessageContext& context, int scale) = 0;
+
 };
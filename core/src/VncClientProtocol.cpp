@@ -33,6 +33,7 @@ extern "C"
 #include <QRegularExpression>
 #include <QTcpSocket>
 
+#include "Tracer.h"
 #include "VncClientProtocol.h"
 
 
@@ -82,6 +83,10 @@ VncClientProtocol::VncClientProtocol( QIODevice* socket, const Password& vncPass
 void VncClientProtocol::start()
 {
 	m_state = State::Protocol;
+
+	m_receiveBuffer.clear();
+	m_messageOffset = 0;
+	m_framebufferUpdate = {};
 }
 
 
@@ -157,6 +162,22 @@ bool VncClientProtocol::setEncodings( const QVector<uint32_t>& encodings )
 
 
 
+bool VncClientProtocol::setScale( int scale )
+{
+	if( scale < 1 || scale > 255 )
+	{
+		return false;
+	}
+
+	rfbSetScaleMsg setScaleMsg{};
+	setScaleMsg.type = rfbSetScale;
+	setScaleMsg.scale = static_cast<uint8_t>( scale );
+
+	return m_socket->write( reinterpret_cast<const char *>( &setScaleMsg ), sz_rfbSetScaleMsg ) == sz_rfbSetScaleMsg;
+}
+
+
+
 void VncClientProtocol::requestFramebufferUpdate( bool incremental )
 {
 	rfbFramebufferUpdateRequestMsg updateRequest;
@@ -177,9 +198,50 @@ void VncClientProtocol::requestFramebufferUpdate( bool incremental )
 
 
 
+int VncClientProtocol::forwardMessages( QIODevice* target )
+{
+	int messageCount = 0;
+
+	m_forwardMessages = true;
+	while( receiveMessage() )
+	{
+		++messageCount;
+	}
+	m_forwardMessages = false;
+
+	if( m_messageOffset > 0 )
+	{
+		// write all complete messages at once and keep data of incomplete message only
+		if( target->write( m_receiveBuffer.constData(), m_messageOffset ) != m_messageOffset )
+		{
+			vWarning() << "could not forward" << m_messageOffset << "bytes";
+		}
+
+		m_receiveBuffer.remove( 0, m_messageOffset );
+
+		if( m_framebufferUpdate.rectCount >= 0 )
+		{
+			m_framebufferUpdate.offset -= m_messageOffset;
+		}
+
+		m_messageOffset = 0;
+	}
+
+	return messageCount;
+}
+
+
+
 bool VncClientProtocol::receiveMessage()
 {
-	if( m_socket->bytesAvailable() > MaximumMessageSize )
+	// move all pending data into our own buffer once so that partially received
+	// messages do not have to be peeked from the socket over and over again
+	if( m_socket->bytesAvailable() > 0 )
+	{
+		m_receiveBuffer.append( m_socket->readAll() );
+	}
+
+	if( m_receiveBuffer.size() - m_messageOffset > MaximumMessageSize )
 	{
 		vCritical() << "Message too big or invalid";
 		m_socket->close();
@@ -187,11 +249,14 @@ bool VncClientProtocol::receiveMessage()
 	}
 
 	uint8_t messageType = 0;
-	if( m_socket->peek( reinterpret_cast<char *>( &messageType ), sizeof(messageType) ) != sizeof(messageType) )
+	if( peekMessage( &messageType, sizeof(messageType) ) == false )
 	{
 		return false;
 	}
 
+	Tracer::Scope traceScope( Tracer::Event::VncClientProtocolReceiveMessage,
+							  messageType, m_receiveBuffer.size() - m_messageOffset );
+
 	switch( messageType )
 	{
 	case rfbFramebufferUpdate:
@@ -416,39 +481,57 @@ bool VncClientProtocol::receiveServerInitMessage()
 
 bool VncClientProtocol::receiveFramebufferUpdateMessage()
 {
-	// peek all available data and work on a local buffer so we can continously read from it
-	auto data = m_socket->peek( m_socket->bytesAvailable() );
+	// work on the receive buffer directly and continue at the position where
+	// we stopped during the last call due to incomplete data
+	auto& progress = m_framebufferUpdate;
 
-	QBuffer buffer( &data );
-	buffer.open( QBuffer::ReadOnly ); // Flawfinder: ignore
-
-	rfbFramebufferUpdateMsg message;
-	if( buffer.read( reinterpret_cast<char *>( &message ), sz_rfbFramebufferUpdateMsg ) != sz_rfbFramebufferUpdateMsg )
+	if( progress.rectCount < 0 )
 	{
-		return false;
+		progress.offset = m_messageOffset;
 	}
 
-	QRegion updatedRegion;
-
-	const auto nRects = qFromBigEndian( message.nRects );
+	QBuffer buffer( &m_receiveBuffer );
+	buffer.open( QBuffer::ReadOnly ); // Flawfinder: ignore
+	buffer.seek( progress.offset );
 
-	for( int i = 0; i < nRects; ++i )
+	if( progress.rectCount < 0 )
 	{
-		rfbFramebufferUpdateRectHeader rectHeader;
-		if( buffer.read( reinterpret_cast<char *>( &rectHeader ), sz_rfbFramebufferUpdateRectHeader ) != sz_rfbFramebufferUpdateRectHeader )
+		rfbFramebufferUpdateMsg message;
+		if( buffer.read( reinterpret_cast<char *>( &message ), sz_rfbFramebufferUpdateMsg ) != sz_rfbFramebufferUpdateMsg )
 		{
 			return false;
 		}
 
-		rectHeader.encoding = qFromBigEndian( rectHeader.encoding );
-		rectHeader.r.w = qFromBigEndian( rectHeader.r.w );
-		rectHeader.r.h = qFromBigEndian( rectHeader.r.h );
-		rectHeader.r.x = qFromBigEndian( rectHeader.r.x );
-		rectHeader.r.y = qFromBigEndian( rectHeader.r.y );
+		progress.rectCount = qFromBigEndian( message.nRects );
+		progress.offset = buffer.pos();
+	}
 
-		if( rectHeader.encoding == rfbEncodingLastRect )
+	while( progress.rectIndex < progress.rectCount )
+	{
+		auto& rectHeader = progress.rectHeader;
+
+		if( progress.haveRectHeader == false )
 		{
-			break;
+			if( buffer.read( reinterpret_cast<char *>( &rectHeader ), sz_rfbFramebufferUpdateRectHeader ) != sz_rfbFramebufferUpdateRectHeader )
+			{
+				return false;
+			}
+
+			rectHeader.encoding = qFromBigEndian( rectHeader.encoding );
+			rectHeader.r.w = qFromBigEndian( rectHeader.r.w );
+			rectHeader.r.h = qFromBigEndian( rectHeader.r.h );
+			rectHeader.r.x = qFromBigEndian( rectHeader.r.x );
+			rectHeader.r.y = qFromBigEndian( rectHeader.r.y );
+
+			progress.offset = buffer.pos();
+
+			if( rectHeader.encoding == rfbEncodingLastRect )
+			{
+				break;
+			}
+
+			progress.haveRectHeader = true;
+			progress.hextileTile = 0;
 		}
 
 		if( handleRect( buffer, rectHeader ) == false )
@@ -456,18 +539,33 @@ bool VncClientProtocol::receiveFramebufferUpdateMessage()
 			return false;
 		}
 
-		if( isPseudoEncoding( rectHeader ) == false &&
+		if( rectHeader.encoding == rfbEncodingNewFBSize )
+		{
+			m_framebufferWidth = rectHeader.r.w;
+			m_framebufferHeight = rectHeader.r.h;
+		}
+
+		if( m_forwardMessages == false &&
+			isPseudoEncoding( rectHeader ) == false &&
 			rectHeader.r.x+rectHeader.r.w <= m_framebufferWidth &&
 			rectHeader.r.y+rectHeader.r.h <= m_framebufferHeight )
 		{
-			updatedRegion += QRect( rectHeader.r.x, rectHeader.r.y, rectHeader.r.w, rectHeader.r.h );
+			progress.updatedRegion += QRect( rectHeader.r.x, rectHeader.r.y, rectHeader.r.w, rectHeader.r.h );
 		}
+
+		progress.haveRectHeader = false;
+		progress.offset = buffer.pos();
+		++progress.rectIndex;
 	}
 
-	m_lastUpdatedRect = updatedRegion.boundingRect();
+	m_lastUpdatedRect = progress.updatedRegion.boundingRect();
+
+	const auto messageSize = static_cast<int>( progress.offset - m_messageOffset );
+
+	progress = {};
 
 	// save as much data as we read by processing rects
-	return readMessage( static_cast<int>( buffer.pos() ) );
+	return readMessage( messageSize );
 }
 
 
@@ -475,7 +573,7 @@ bool VncClientProtocol::receiveFramebufferUpdateMessage()
 bool VncClientProtocol::receiveColourMapEntriesMessage()
 {
 	rfbSetColourMapEntriesMsg message;
-	if( m_socket->peek( reinterpret_cast<char *>( &message ), sz_rfbSetColourMapEntriesMsg ) != sz_rfbSetColourMapEntriesMsg )
+	if( peekMessage( &message, sz_rfbSetColourMapEntriesMsg ) == false )
 	{
 		return false;
 	}
@@ -496,7 +594,7 @@ bool VncClientProtocol::receiveBellMessage()
 bool VncClientProtocol::receiveCutTextMessage()
 {
 	rfbServerCutTextMsg message;
-	if( m_socket->peek( reinterpret_cast<char *>( &message ), sz_rfbServerCutTextMsg ) != sz_rfbServerCutTextMsg )
+	if( peekMessage( &message, sz_rfbServerCutTextMsg ) == false )
 	{
 		return false;
 	}
@@ -508,11 +606,12 @@ bool VncClientProtocol::receiveCutTextMessage()
 
 bool VncClientProtocol::receiveResizeFramebufferMessage()
 {
-	if( readMessage( sz_rfbResizeFrameBufferMsg ) )
+	rfbResizeFrameBufferMsg message;
+	if( peekMessage( &message, sz_rfbResizeFrameBufferMsg ) &&
+		readMessage( sz_rfbResizeFrameBufferMsg ) )
 	{
-		const auto msg = reinterpret_cast<const rfbResizeFrameBufferMsg *>( m_lastMessage.constData() );
-		m_framebufferWidth = qFromBigEndian( msg->framebufferWidth );
-		m_framebufferHeight = qFromBigEndian( msg->framebufferHeigth );
+		m_framebufferWidth = qFromBigEndian( message.framebufferWidth );
+		m_framebufferHeight = qFromBigEndian( message.framebufferHeigth );
 
 		return true;
 	}
@@ -529,23 +628,59 @@ bool VncClientProtocol::receiveXvpMessage()
 
 
 
+bool VncClientProtocol::peekMessage( void* data, int size ) const
+{
+	if( m_receiveBuffer.size() - m_messageOffset < size )
+	{
+		return false;
+	}
+
+	memcpy( data, m_receiveBuffer.constData() + m_messageOffset, size_t(size) ); // Flawfinder: ignore
+
+	return true;
+}
+
+
+
 bool VncClientProtocol::readMessage( int size )
 {
-	if( m_socket->bytesAvailable() < size )
+	if( size < 0 || m_receiveBuffer.size() - m_messageOffset < size )
 	{
 		return false;
 	}
 
-	auto message = m_socket->read( size );
-	if( message.size() == size )
+	if( m_forwardMessages )
 	{
-		m_lastMessage = message;
+		// just advance message boundary - data is forwarded in forwardMessages() later
+		m_messageOffset += size;
 		return true;
 	}
 
-	vWarning() << "only received" << message.size() << "of" << size << "bytes";
+	if( m_receiveBuffer.size() == size )
+	{
+		// common case - take over the whole buffer without copying
+		m_lastMessage = std::move( m_receiveBuffer );
+		m_receiveBuffer = {};
+	}
+	else
+	{
+		m_lastMessage = m_receiveBuffer.left( size );
+		m_receiveBuffer.remove( 0, size );
+	}
 
-	return false;
+	return true;
+}
+
+
+
+bool VncClientProtocol::skipBytes( QBuffer& buffer, qint64 size )
+{
+	if( size < 0 || buffer.bytesAvailable() < size )
+	{
+		return false;
+	}
+
+	return buffer.seek( buffer.pos() + size );
 }
 
 
@@ -565,27 +700,25 @@ bool VncClientProtocol::handleRect( QBuffer& buffer, rfbFramebufferUpdateRectHea
 
 	case rfbEncodingXCursor:
 		return width * height == 0 ||
-				( buffer.read( sz_rfbXCursorColors ).size() == sz_rfbXCursorColors &&
-				  buffer.read( size_t(2) * bytesPerRow * height ).size() == static_cast<int>( 2 * bytesPerRow * height ) );
+				skipBytes( buffer, sz_rfbXCursorColors + qint64(2) * bytesPerRow * height );
 
 	case rfbEncodingRichCursor:
 		return width * height == 0 ||
-				( buffer.read( size_t(width) * height * bytesPerPixel ).size() == static_cast<int>( width * height * bytesPerPixel ) &&
-				  buffer.read( size_t(bytesPerRow) * height ).size() == static_cast<int>( bytesPerRow * height ) );
+				skipBytes( buffer, qint64(width) * height * bytesPerPixel + qint64(bytesPerRow) * height );
 
 	case rfbEncodingSupportedMessages:
-		return buffer.read( sz_rfbSupportedMessages ).size() == sz_rfbSupportedMessages;
+		return skipBytes( buffer, sz_rfbSupportedMessages );
 
 	case rfbEncodingSupportedEncodings:
 	case rfbEncodingServerIdentity:
 		// width = byte count
-		return buffer.read( width ).size() == static_cast<int>( width );
+		return skipBytes( buffer, width );
 
 	case rfbEncodingRaw:
-		return buffer.read( size_t(width) * height * bytesPerPixel ).size() == static_cast<int>( width * height * bytesPerPixel );
+		return skipBytes( buffer, qint64(width) * height * bytesPerPixel );
 
 	case rfbEncodingCopyRect:
-		return buffer.read( sz_rfbCopyRect ).size() == sz_rfbCopyRect;
+		return skipBytes( buffer, sz_rfbCopyRect );
 
 	case rfbEncodingRRE:
 		return handleRectEncodingRRE( buffer, bytesPerPixel );
@@ -640,7 +773,7 @@ bool VncClientProtocol::handleRectEncodingRRE( QBuffer& buffer, uint bytesPerPix
 	const auto rectDataSize = qFromBigEndian( hdr.nSubrects ) * ( bytesPerPixel + sz_rfbRectangle );
 	const auto totalDataSize = static_cast<int>( bytesPerPixel + rectDataSize );
 
-	return totalDataSize < MaxMessageSize && buffer.read( totalDataSize ).size() == totalDataSize;
+	return totalDataSize < MaxMessageSize && skipBytes( buffer, totalDataSize );
 }
 
 
@@ -657,7 +790,7 @@ bool VncClientProtocol::handleRectEncodingCoRRE( QBuffer& buffer, uint bytesPerP
 	const auto rectDataSize = qFromBigEndian( hdr.nSubrects ) * ( bytesPerPixel + 4 );
 	const auto totalDataSize = static_cast<int>( bytesPerPixel + rectDataSize );
 
-	return totalDataSize < MaxMessageSize && buffer.read( totalDataSize ).size() == totalDataSize;
+	return totalDataSize < MaxMessageSize && skipBytes( buffer, totalDataSize );
 
 }
 
@@ -667,88 +800,75 @@ bool VncClientProtocol::handleRectEncodingHextile( QBuffer& buffer,
 													const rfbFramebufferUpdateRectHeader rectHeader,
 													uint bytesPerPixel )
 {
-	const uint rx = rectHeader.r.x;
-	const uint ry = rectHeader.r.y;
 	const uint rw = rectHeader.r.w;
 	const uint rh = rectHeader.r.h;
 
-	for( uint y = ry; y < ry+rh; y += 16 )
+	const uint tilesPerRow = ( rw + 15 ) / 16;
+	const uint tileCount = tilesPerRow * ( ( rh + 15 ) / 16 );
+
+	// tiles are processed individually and progress is saved after each tile
+	// so we don't have to start over with the first tile of a large rect
+	for( auto tile = m_framebufferUpdate.hextileTile; tile < tileCount; ++tile )
 	{
-		for( uint x = rx; x < rx+rw; x += 16 )
+		const uint x = ( tile % tilesPerRow ) * 16;
+		const uint y = ( tile / tilesPerRow ) * 16;
+
+		if( handleHextileTile( buffer, qMin<uint>( 16, rw - x ), qMin<uint>( 16, rh - y ), bytesPerPixel ) == false )
 		{
-			uint w = 16;
-			uint h = 16;
-			if( rx+rw - x < 16 )
-			{
-				w = rx+rw - x;
-			}
-			if( ry+rh - y < 16 )
-			{
-				h = ry+rh - y;
-			}
+			return false;
+		}
 
-			uint8_t subEncoding = 0;
-			if( buffer.read( reinterpret_cast<char *>( &subEncoding ), 1 ) != 1 )
-			{
-				return false;
-			}
+		m_framebufferUpdate.hextileTile = tile + 1;
+		m_framebufferUpdate.offset = buffer.pos();
+	}
 
-			if( subEncoding & rfbHextileRaw )
-			{
-				const auto dataSize = static_cast<int>( w * h * bytesPerPixel );
-				if( buffer.read( dataSize ).size() != dataSize )
-				{
-					return false;
-				}
-				continue;
-			}
+	return true;
+}
 
-			if( subEncoding & rfbHextileBackgroundSpecified )
-			{
-				if( buffer.read( bytesPerPixel ).size() != static_cast<int>( bytesPerPixel ) )
-				{
-					return false;
-				}
-			}
 
-			if( subEncoding & rfbHextileForegroundSpecified )
-			{
-				if( buffer.read( bytesPerPixel ).size() != static_cast<int>( bytesPerPixel ) )
-				{
-					return false;
-				}
-			}
 
-			if( !( subEncoding & rfbHextileAnySubrects ) )
-			{
-				continue;
-			}
+bool VncClientProtocol::handleHextileTile( QBuffer& buffer, uint width, uint height, uint bytesPerPixel )
+{
+	uint8_t subEncoding = 0;
+	if( buffer.read( reinterpret_cast<char *>( &subEncoding ), 1 ) != 1 )
+	{
+		return false;
+	}
 
-			uint8_t nSubrects = 0;
-			if( buffer.read( reinterpret_cast<char *>( &nSubrects ), 1 ) != 1 )
-			{
-				return false;
-			}
+	if( subEncoding & rfbHextileRaw )
+	{
+		return skipBytes( buffer, qint64(width) * height * bytesPerPixel );
+	}
 
-			int subRectDataSize = 0;
+	if( ( subEncoding & rfbHextileBackgroundSpecified ) &&
+		skipBytes( buffer, bytesPerPixel ) == false )
+	{
+		return false;
+	}
 
-			if( subEncoding & rfbHextileSubrectsColoured )
-			{
-				subRectDataSize = static_cast<int>( nSubrects * ( 2 + bytesPerPixel ) );
-			}
-			else
-			{
-				subRectDataSize = nSubrects * 2;
-			}
+	if( ( subEncoding & rfbHextileForegroundSpecified ) &&
+		skipBytes( buffer, bytesPerPixel ) == false )
+	{
+		return false;
+	}
 
-			if( buffer.read( subRectDataSize ).size() != subRectDataSize )
-			{
-				return false;
-			}
-		}
+	if( !( subEncoding & rfbHextileAnySubrects ) )
+	{
+		return true;
 	}
 
-	return true;
+	uint8_t nSubrects = 0;
+	if( buffer.read( reinterpret_cast<char *>( &nSubrects ), 1 ) != 1 )
+	{
+		return false;
+	}
+
+	if( subEncoding & rfbHextileSubrectsColoured )
+	{
+		return skipBytes( buffer, nSubrects * ( 2 + bytesPerPixel ) );
+	}
+
+	return skipBytes( buffer, nSubrects * 2 );
 }
 
 
@@ -764,7 +884,7 @@ bool VncClientProtocol::handleRectEncodingZlib( QBuffer& buffer )
 
 	const auto n = qFromBigEndian( hdr.nBytes );
 
-	return n < MaxMessageSize && uint32_t(buffer.read(n).size()) == n;
+	return n < MaxMessageSize && skipBytes( buffer, n );
 }
 
 
@@ -780,7 +900,7 @@ bool VncClientProtocol::handleRectEncodingZRLE(QBuffer &buffer)
 
 	const auto n = qFromBigEndian( hdr.length );
 
-	return n < MaxMessageSize && uint32_t(buffer.read(n).size()) == n;
+	return n < MaxMessageSize && skipBytes( buffer, n );
 }
 
 
@@ -850,13 +970,12 @@ bool VncClientProtocol::handleRectEncodingTight(QBuffer& buffer,
 
 	if (compCtl == rfbTightFill)
 	{
-		return buffer.read(bytesPerPixel).size() == bytesPerPixel;
+		return skipBytes(buffer, bytesPerPixel);
 	}
 
 	if (compCtl == rfbTightJpeg)
 	{
-		const auto dataLength = readCompactLength(buffer);
-		return buffer.read(dataLength).size() == dataLength;
+		return skipBytes(buffer, readCompactLength(buffer));
 	}
 
 	if (compCtl > rfbTightMaxSubencoding)
@@ -890,7 +1009,7 @@ bool VncClientProtocol::handleRectEncodingTight(QBuffer& buffer,
 				return false;
 			}
 			const auto rectBytes = tightRectColors * bytesPerPixel;
-			if (buffer.read(rectBytes).size() != rectBytes)
+			if (skipBytes(buffer, rectBytes) == false)
 			{
 				return false;
 			}
@@ -911,7 +1030,7 @@ bool VncClientProtocol::handleRectEncodingTight(QBuffer& buffer,
 	const int uncompressedRectSize = rectHeader.r.h * rowSize;
 	if (uncompressedRectSize < MaximumUncompressedSize)
 	{
-		return buffer.read(uncompressedRectSize).size() == uncompressedRectSize;
+		return skipBytes(buffer, uncompressedRectSize);
 	}
 
 	const auto compressedLength = readCompactLength(buffer);
@@ -921,7 +1040,7 @@ bool VncClientProtocol::handleRectEncodingTight(QBuffer& buffer,
 		return false;
 	}
 
-	return buffer.read(compressedLength).size() == compressedLength;
+	return skipBytes(buffer, compressedLength);
 }
 
 
@@ -935,12 +1054,7 @@ bool VncClientProtocol::handleRectEncodingExtDesktopSize(QBuffer& buffer)
 	}
 
 	const auto totalMessageSize = sz_rfbExtDesktopSizeMsg + extDesktopSizeMsg.numberOfScreens * sz_rfbExtDesktopScreen;
-	if (buffer.bytesAvailable() >= totalMessageSize)
-	{
-		return buffer.read(totalMessageSize).size() == totalMessageSize;
-	}
-
-	return false;
+	return skipBytes(buffer, totalMessageSize);
 }
 
 
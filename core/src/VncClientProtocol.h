@@ -27,6 +27,7 @@
 #include "rfb/rfbproto.h"
 
 #include <QRect>
+#include <QRegion>
 
 #include "CryptoCore.h"
 
@@ -77,11 +78,16 @@ public:
 
 	bool setPixelFormat( rfbPixelFormat pixelFormat );
 	bool setEncodings( const QVector<uint32_t>& encodings );
+	bool setScale( int scale );
 
 	void requestFramebufferUpdate( bool incremental );
 
 	bool receiveMessage();
 
+	// only determine message boundaries and write all complete messages to
+	// target without copying them to lastMessage(), returns number of messages
+	int forwardMessages( QIODevice* target );
+
 	const QByteArray& lastMessage() const
 	{
 		return m_lastMessage;
@@ -119,14 +125,18 @@ private:
 	bool receiveResizeFramebufferMessage();
 	bool receiveXvpMessage();
 
+	bool peekMessage( void* data, int size ) const;
 	bool readMessage( int size );
 
+	static bool skipBytes( QBuffer& buffer, qint64 size );
+
 	bool handleRect( QBuffer& buffer, rfbFramebufferUpdateRectHeader rectHeader );
 	bool handleRectEncodingRRE( QBuffer& buffer, uint bytesPerPixel );
 	bool handleRectEncodingCoRRE( QBuffer& buffer, uint bytesPerPixel );
 	bool handleRectEncodingHextile( QBuffer& buffer,
 									const rfbFramebufferUpdateRectHeader rectHeader,
 									uint bytesPerPixel );
+	bool handleHextileTile( QBuffer& buffer, uint width, uint height, uint bytesPerPixel );
 	bool handleRectEncodingZlib( QBuffer& buffer );
 	bool handleRectEncodingZRLE( QBuffer& buffer );
 	bool handleRectEncodingTight(QBuffer& buffer,
@@ -149,6 +159,24 @@ private:
 	quint16 m_framebufferWidth{0};
 	quint16 m_framebufferHeight{0};
 
+	// all data received from the server which has not been processed as a complete message yet
+	QByteArray m_receiveBuffer;
+	int m_messageOffset{0};
+	bool m_forwardMessages{false};
+
+	// parser position within a partially received framebuffer update message so parsing
+	// can be resumed where it stopped when more data arrives
+	struct FramebufferUpdateProgress
+	{
+		int rectCount{-1};
+		int rectIndex{0};
+		qint64 offset{0};
+		bool haveRectHeader{false};
+		rfbFramebufferUpdateRectHeader rectHeader{};
+		uint hextileTile{0};
+		QRegion updatedRegion{};
+	} m_framebufferUpdate;
+
 	QByteArray m_lastMessage;
 	QRect m_lastUpdatedRect;
 
@@ -27,6 +27,9 @@
 
 #include <rfb/rfbclient.h>
 
+#include <cmath>
+#include <numeric>
+
 #include <QBitmap>
 #include <QHostAddress>
 #include <QMutexLocker>
@@ -35,11 +38,13 @@
 #include <QSslSocket>
 #include <QTime>
 
+#include "ImageScaler.h"
 #include "PlatformNetworkFunctions.h"
 #include "VeyonConfiguration.h"
 #include "VncConnection.h"
 #include "RfbClientCallback.h"
 #include "SocketDevice.h"
+#include "Tracer.h"
 #include "VncEvents.h"
 
 
@@ -302,16 +307,67 @@ void VncConnection::rescaleFramebuffer()
 		return;
 	}
 
+	// clear flag before fetching the dirty region so updates arriving in between are not lost
+	setControlFlag( ControlFlag::ScaledFramebufferNeedsUpdate, false );
+
+	m_dirtyRegionMutex.lock();
+	const auto dirtyRegion = m_dirtyRegion;
+	m_dirtyRegion = {};
+	m_dirtyRegionMutex.unlock();
+
 	QReadLocker locker( &m_imgLock );
 
-	if( m_image.size().isValid() == false )
+	const auto imageSize = m_image.size();
+	if( imageSize.isValid() == false )
 	{
 		return;
 	}
 
-	m_scaledFramebuffer = m_image.scaled( m_scaledSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
+	// only rescale changed areas if the scaled framebuffer layout did not change
+	const auto dirtyArea = std::accumulate( dirtyRegion.begin(), dirtyRegion.end(), qint64(0),
+											[]( qint64 area, const QRect& rect ) {
+												return area + qint64(rect.width()) * rect.height(); } );
 
-	setControlFlag( ControlFlag::ScaledFramebufferNeedsUpdate, false );
+	if( m_scaledFramebuffer.size() != m_scaledSize ||
+		ImageScaler::canScale( m_image, m_scaledSize ) == false ||
+		dirtyArea * 2 > qint64(imageSize.width()) * imageSize.height() )
+	{
+		m_scaledFramebuffer = ImageScaler::scaled( m_image, m_scaledSize );
+	}
+	else if( dirtyRegion.isEmpty() == false )
+	{
+		rescaleFramebufferRegion( dirtyRegion );
+	}
+}
+
+
+
+void VncConnection::rescaleFramebufferRegion( const QRegion& region )
+{
+	const auto imageSize = m_image.size();
+	const auto scaleX = qreal(imageSize.width()) / m_scaledSize.width();
+	const auto scaleY = qreal(imageSize.height()) / m_scaledSize.height();
+
+	// map changed areas to tiles of the scaled framebuffer
+	QRegion scaledRegion;
+	for( const auto& rect : region )
+	{
+		const auto left = int( rect.left() / scaleX ) / ScaledFramebufferTileSize;
+		const auto top = int( rect.top() / scaleY ) / ScaledFramebufferTileSize;
+		const auto right = int( std::ceil( ( rect.right() + 1 ) / scaleX ) - 1 ) / ScaledFramebufferTileSize;
+		const auto bottom = int( std::ceil( ( rect.bottom() + 1 ) / scaleY ) - 1 ) / ScaledFramebufferTileSize;
+
+		scaledRegion += QRect( left * ScaledFramebufferTileSize, top * ScaledFramebufferTileSize,
+							   ( right - left + 1 ) * ScaledFramebufferTileSize,
+							   ( bottom - top + 1 ) * ScaledFramebufferTileSize ).intersected( m_scaledFramebuffer.rect() );
+	}
+
+	// scaled pixels only depend on the framebuffer area they cover, so updated
+	// areas match the result of rescaling the whole framebuffer
+	for( const auto& targetRect : scaledRegion )
+	{
+		ImageScaler::scale( m_image, m_scaledFramebuffer, targetRect );
+	}
 }
 
 
@@ -412,7 +468,7 @@ void VncConnection::establishConnection()
 		m_client = rfbGetClient( RfbBitsPerSample, RfbSamplesPerPixel, RfbBytesPerPixel );
 		m_client->canHandleNewFBSize = true;
 		m_client->MallocFrameBuffer = RfbClientCallback::wrap<&VncConnection::initFrameBuffer>;
-		m_client->GotFrameBufferUpdate = RfbClientCallback::wrap<&VncConnection::imageUpdated>;
+		m_client->GotFrameBufferUpdate = RfbClientCallback::wrap<&VncConnection::updateFramebufferRegion>;
 		m_client->FinishedFrameBufferUpdate = RfbClientCallback::wrap<&VncConnection::finishFrameBufferUpdate>;
 		m_client->HandleCursorPos = RfbClientCallback::wrap<&VncConnection::updateCursorPosition>;
 		m_client->GotCursorShape = RfbClientCallback::wrap<&VncConnection::updateCursorShape>;
@@ -540,12 +596,18 @@ void VncConnection::handleConnection()
 
 		if( i )
 		{
+			Tracer::Scope traceScope( Tracer::Event::VncConnectionHandleMessages );
+
 			// handle all available messages
 			bool handledOkay = true;
+			int messageCount = 0;
 			do {
 				handledOkay &= HandleRFBServerMessage( m_client );
+				++messageCount;
 			} while( handledOkay && WaitForMessage( m_client, 0 ) );
 
+			traceScope.setEndArguments( messageCount, handledOkay );
+
 			if( handledOkay == false )
 			{
 				break;
@@ -651,6 +713,11 @@ rfbBool VncConnection::initFrameBuffer( rfbClient* client )
 	m_image = QImage( client->frameBuffer, client->width, client->height, QImage::Format_RGB32, framebufferCleanup, client->frameBuffer );
 	m_imgLock.unlock();
 
+	// scaled framebuffer has to be rebuilt completely
+	m_dirtyRegionMutex.lock();
+	m_dirtyRegion = QRect( 0, 0, client->width, client->height );
+	m_dirtyRegionMutex.unlock();
+
 	// set up pixel format according to QImage
 	client->format.redShift = 16;
 	client->format.greenShift = 8;
@@ -703,6 +770,17 @@ void VncConnection::finishFrameBufferUpdate()
 
 
 
+void VncConnection::updateFramebufferRegion( int x, int y, int w, int h )
+{
+	m_dirtyRegionMutex.lock();
+	m_dirtyRegion += QRect( x, y, w, h );
+	m_dirtyRegionMutex.unlock();
+
+	Q_EMIT imageUpdated( x, y, w, h );
+}
+
+
+
 void VncConnection::updateEncodingSettingsFromQuality()
 {
 	m_client->appData.encodingsString = m_quality == VncConnectionConfiguration::Quality::Highest ?
@@ -839,6 +917,7 @@ rfbSocket VncConnection::openTlsSocket( const char* hostname, int port )
 	delete m_sslSocket;
 
 	m_sslSocket = new QSslSocket;
+	m_sslSocket->setSslConfiguration( VeyonCore::tlsConfiguration() );
 	connect(m_sslSocket, QOverload<const QList<QSslError>&>::of(&QSslSocket::sslErrors),
 			 []( const QList<QSslError> &errors) {
 				 for( const auto& err : errors )
@@ -34,6 +34,7 @@
 #include <QMutex>
 #include <QQueue>
 #include <QReadWriteLock>
+#include <QRegion>
 #include <QThread>
 #include <QTimer>
 #include <QWaitCondition>
@@ -175,6 +176,9 @@ private:
 	static constexpr int RfbSamplesPerPixel = 3;
 	static constexpr int RfbBytesPerPixel = sizeof(RfbPixel);
 
+	// granularity of partial updates of the scaled framebuffer
+	static constexpr int ScaledFramebufferTileSize = 32;
+
 	enum class ControlFlag {
 		ScaledFramebufferNeedsUpdate = 0x01,
 		ServerReachable = 0x02,
@@ -201,6 +205,7 @@ private:
 	rfbBool initFrameBuffer( rfbClient* client );
 	void requestFrameufferUpdate(FramebufferUpdateType updateType);
 	void finishFrameBufferUpdate();
+	void updateFramebufferRegion( int x, int y, int w, int h );
 
 	void updateEncodingSettingsFromQuality();
 
@@ -208,6 +213,8 @@ private:
 	void updateCursorShape( rfbClient* client, int xh, int yh, int w, int h, int bpp );
 	void updateClipboard( const char *text, int textlen );
 
+	void rescaleFramebufferRegion( const QRegion& region );
+
 	void sendEvents();
 
 	void deleteLaterInMainThread();
@@ -265,4 +272,8 @@ private:
 	QSize m_scaledSize{};
 	QReadWriteLock m_imgLock{};
 
+	// framebuffer areas changed since the scaled framebuffer was updated
+	QMutex m_dirtyRegionMutex{};
+	QRegion m_dirtyRegion{};
+
 } ;
@@ -146,10 +146,11 @@ QJsonArray CheckableItemProxyModel::saveStates()
 {
 	QJsonArray data;
 
+	const auto indexes = uidIndexes();
+
 	for( auto it = m_checkStates.constBegin(), end = m_checkStates.constEnd(); it != end; ++it )
 	{
-		if( it.value() == Qt::Checked &&
-			match( index( 0, 0 ), m_uidRole, it.key(), 1, Qt::MatchExactly | Qt::MatchRecursive ).isEmpty() == false )
+		if( it.value() == Qt::Checked && indexes.contains( it.key() ) )
 		{
 			data += it.key().toString();
 		}
@@ -166,15 +167,15 @@ void CheckableItemProxyModel::loadStates( const QJsonArray& data )
 
 	m_checkStates.clear();
 
+	const auto indexes = uidIndexes();
+
 	for( const auto& item : data )
 	{
 		const QUuid uid = QUuid( item.toString() );
-		const auto indexList = match( index( 0, 0 ), m_uidRole, uid, 1, // clazy:exclude=inefficient-qlist
-									  Qt::MatchExactly | Qt::MatchRecursive );
-		if( indexList.isEmpty() == false &&
-				hasChildren( indexList.first() ) == false )
+		const auto uidIndex = indexes.value( uid );
+		if( uidIndex.isValid() && hasChildren( uidIndex ) == false )
 		{
-			setData( indexList.first(), Qt::Checked, Qt::CheckStateRole );
+			setData( uidIndex, Qt::Checked, Qt::CheckStateRole );
 		}
 
 		// allow items being added dynamically even if we can't propagate the check state at the moment
@@ -186,6 +187,39 @@ void CheckableItemProxyModel::loadStates( const QJsonArray& data )
 
 
 
+QHash<QUuid, QPersistentModelIndex> CheckableItemProxyModel::uidIndexes() const
+{
+	QHash<QUuid, QPersistentModelIndex> indexes;
+
+	QList<QModelIndex> parents{ QModelIndex() };
+
+	while( parents.isEmpty() == false )
+	{
+		const auto parent = parents.takeLast();
+		const auto rows = rowCount( parent );
+
+		for( int row = 0; row < rows; ++row )
+		{
+			const auto childIndex = index( row, 0, parent );
+
+			const auto uid = indexToUuid( childIndex );
+			if( indexes.contains( uid ) == false )
+			{
+				indexes.insert( uid, childIndex );
+			}
+
+			if( hasChildren( childIndex ) )
+			{
+				parents.append( childIndex );
+			}
+		}
+	}
+
+	return indexes;
+}
+
+
+
 QUuid CheckableItemProxyModel::indexToUuid( const QModelIndex& index ) const
 {
 	return QIdentityProxyModel::data( index, m_uidRole ).toUuid();
@@ -48,6 +48,7 @@ public:
 	void loadStates( const QJsonArray& data );
 
 private:
+	QHash<QUuid, QPersistentModelIndex> uidIndexes() const;
 	QUuid indexToUuid( const QModelIndex& index ) const;
 	bool setChildData( const QModelIndex &index, Qt::CheckState checkState );
 	void setParentData( const QModelIndex &index, Qt::CheckState checkState );
@@ -28,6 +28,7 @@
 #include "ComputerImageProvider.h"
 #include "ComputerManager.h"
 #include "FeatureManager.h"
+#include "ImageScaler.h"
 #include "PlatformSessionFunctions.h"
 #include "VeyonMaster.h"
 #include "UserConfig.h"
@@ -53,6 +54,8 @@ ComputerControlListModel::ComputerControlListModel( VeyonMaster* masterCore, QOb
 			 this, &ComputerControlListModel::reload );
 	connect( &m_master->computerManager(), &ComputerManager::computerSelectionChanged,
 			 this, &ComputerControlListModel::update );
+	connect( &m_master->computerManager(), &ComputerManager::computerSelectionModified,
+			 this, &ComputerControlListModel::updateSelection );
 
 	updateComputerScreenSize();
 
@@ -189,6 +192,8 @@ void ComputerControlListModel::updateComputerScreenSize()
 	{
 		m_computerScreenSize = newSize;
 
+		invalidateDecorations();
+
 		for( int i = 0; i < rowCount(); ++i )
 		{
 			updateScreen( index( i ) );
@@ -215,19 +220,56 @@ ComputerControlInterface::Pointer ComputerControlListModel::computerControlInter
 
 ComputerControlInterface::Pointer ComputerControlListModel::computerControlInterface( NetworkObject::Uid uid ) const
 {
-	for( auto& controlInterface : m_computerControlInterfaces )
+	return m_computerControlInterfacesByUid.value( uid );
+}
+
+
+
+QImage ComputerControlListModel::computerDecorationRole( const ComputerControlInterface::Pointer& controlInterface ) const
+{
+	// the framebuffer of connected computers changes with every update so caching or converting
+	// it would only add copies - the cache only helps computers which are not connected
+	if( controlInterface->state() == ComputerControlInterface::State::Connected )
 	{
-		if( controlInterface->computer().networkObjectUid() == uid )
+		const auto framebuffer = controlInterface->scaledFramebuffer();
+		if( framebuffer.isNull() == false )
 		{
-			return controlInterface;
+			return framebuffer;
 		}
 	}
-	return {};
+
+	const auto uid = controlInterface->computer().networkObjectUid();
+
+	{
+		QMutexLocker locker( &m_decorationCacheMutex );
+
+		const auto it = m_decorationCache.constFind( uid );
+		if( it != m_decorationCache.constEnd() )
+		{
+			++m_decorationCacheHits;
+			return *it;
+		}
+
+		++m_decorationCacheMisses;
+	}
+
+	auto decoration = createDecoration( controlInterface );
+
+	// store in the format preferred for texture uploads so the scene graph does not have to convert it
+	if( decoration.hasAlphaChannel() && decoration.format() != QImage::Format_ARGB32_Premultiplied )
+	{
+		decoration = decoration.convertToFormat( QImage::Format_ARGB32_Premultiplied );
+	}
+
+	QMutexLocker locker( &m_decorationCacheMutex );
+	m_decorationCache[uid] = decoration;
+
+	return decoration;
 }
 
 
 
-QImage ComputerControlListModel::computerDecorationRole( const ComputerControlInterface::Pointer& controlInterface ) const
+QImage ComputerControlListModel::createDecoration( const ComputerControlInterface::Pointer& controlInterface ) const
 {
 	switch( controlInterface->state() )
 	{
@@ -265,15 +307,12 @@ void ComputerControlListModel::reload()
 
 	m_computerControlInterfaces.clear();
 	m_computerControlInterfaces.reserve( computerList.size() );
-
-	int row = 0;
+	m_computerControlInterfacesByUid.clear();
+	invalidateDecorations();
 
 	for( const auto& computer : computerList )
 	{
-		const auto controlInterface = ComputerControlInterface::Pointer::create( computer );
-		m_computerControlInterfaces.append( controlInterface );
-		startComputerControlInterface( controlInterface.data() );
-		++row;
+		addComputerControlInterface( ComputerControlInterface::Pointer::create( computer ) );
 	}
 
 	endResetModel();
@@ -285,13 +324,44 @@ void ComputerControlListModel::update()
 {
 	const auto newComputerList = m_master->computerManager().selectedComputers( QModelIndex() );
 
+	NetworkObjectUidList newComputerUids;
+	newComputerUids.reserve( newComputerList.size() );
+	for( const auto& computer : newComputerList )
+	{
+		newComputerUids.append( computer.networkObjectUid() );
+	}
+
+	NetworkObjectUidList deselectedComputers;
+	for( const auto& controlInterface : std::as_const(m_computerControlInterfaces) )
+	{
+		if( newComputerUids.contains( controlInterface->computer().networkObjectUid() ) == false )
+		{
+			deselectedComputers.append( controlInterface->computer().networkObjectUid() );
+		}
+	}
+
+	updateSelection( newComputerList, deselectedComputers );
+}
+
+
+
+void ComputerControlListModel::updateSelection( const ComputerList& selectedComputers,
+												const NetworkObjectUidList& deselectedComputers )
+{
+	NetworkObjectUidList existingComputers;
+	existingComputers.reserve( m_computerControlInterfaces.size() );
+
 	int row = 0;
 
 	for( auto it = m_computerControlInterfaces.begin(); it != m_computerControlInterfaces.end(); ) // clazy:exclude=detaching-member
 	{
-		if( newComputerList.contains( (*it)->computer() ) == false )
+		const auto uid = (*it)->computer().networkObjectUid();
+
+		if( deselectedComputers.contains( uid ) )
 		{
 			stopComputerControlInterface( *it );
+			m_computerControlInterfacesByUid.remove( uid );
+			invalidateDecoration( it->data() );
 
 			beginRemoveRows( QModelIndex(), row, row );
 			it = m_computerControlInterfaces.erase( it );
@@ -299,33 +369,25 @@ void ComputerControlListModel::update()
 		}
 		else
 		{
+			existingComputers.append( uid );
 			++it;
 			++row;
 		}
 	}
 
-	row = 0;
-
-	for( const auto& computer : newComputerList )
+	for( const auto& computer : selectedComputers )
 	{
-		if( row < m_computerControlInterfaces.count() && m_computerControlInterfaces[row]->computer() != computer )
-		{
-			beginInsertRows( QModelIndex(), row, row );
-			const auto controlInterface = ComputerControlInterface::Pointer::create( computer );
-			m_computerControlInterfaces.insert( row, controlInterface );
-			startComputerControlInterface( controlInterface.data() );
-			endInsertRows();
-		}
-		else if( row >= m_computerControlInterfaces.count() )
+		if( existingComputers.contains( computer.networkObjectUid() ) )
 		{
-			beginInsertRows( QModelIndex(), row, row );
-			const auto controlInterface = ComputerControlInterface::Pointer::create( computer );
-			m_computerControlInterfaces.append( controlInterface );
-			startComputerControlInterface( controlInterface.data() );
-			endInsertRows();
+			continue;
 		}
 
-		++row;
+		existingComputers.append( computer.networkObjectUid() );
+
+		const auto newRow = m_computerControlInterfaces.count();
+		beginInsertRows( QModelIndex(), newRow, newRow );
+		addComputerControlInterface( ComputerControlInterface::Pointer::create( computer ) );
+		endInsertRows();
 	}
 
 	updateComputerScreenSize();
@@ -396,13 +458,19 @@ void ComputerControlListModel::startComputerControlInterface( ComputerControlInt
 			 this, &ComputerControlListModel::updateComputerScreenSize );
 
 	connect( controlInterface, &ComputerControlInterface::scaledFramebufferUpdated,
-			 this, [=] () { updateScreen( interfaceIndex( controlInterface ) ); } );
+			 this, [=] () {
+				 invalidateDecoration( controlInterface );
+				 updateScreen( interfaceIndex( controlInterface ) );
+			 } );
 
 	connect( controlInterface, &ComputerControlInterface::activeFeaturesChanged,
 			 this, [=] () { updateActiveFeatures( interfaceIndex( controlInterface ) ); } );
 
 	connect( controlInterface, &ComputerControlInterface::stateChanged,
-			 this, [=] () { updateState( interfaceIndex( controlInterface ) ); } );
+			 this, [=] () {
+				 invalidateDecoration( controlInterface );
+				 updateState( interfaceIndex( controlInterface ) );
+			 } );
 
 	connect( controlInterface, &ComputerControlInterface::userChanged,
 			 this, [=]() { updateUser( interfaceIndex( controlInterface ) ); } );
@@ -428,6 +496,31 @@ void ComputerControlListModel::stopComputerControlInterface( const ComputerContr
 
 
 
+void ComputerControlListModel::addComputerControlInterface( const ComputerControlInterface::Pointer& controlInterface )
+{
+	m_computerControlInterfaces.append( controlInterface );
+	m_computerControlInterfacesByUid[controlInterface->computer().networkObjectUid()] = controlInterface;
+	startComputerControlInterface( controlInterface.data() );
+}
+
+
+
+void ComputerControlListModel::invalidateDecoration( ComputerControlInterface* controlInterface )
+{
+	QMutexLocker locker( &m_decorationCacheMutex );
+	m_decorationCache.remove( controlInterface->computer().networkObjectUid() );
+}
+
+
+
+void ComputerControlListModel::invalidateDecorations()
+{
+	QMutexLocker locker( &m_decorationCacheMutex );
+	m_decorationCache.clear();
+}
+
+
+
 double ComputerControlListModel::averageAspectRatio() const
 {
 	QSize size{ 16, 9 };
@@ -448,7 +541,7 @@ double ComputerControlListModel::averageAspectRatio() const
 
 QImage ComputerControlListModel::scaleAndAlignIcon( const QImage& icon, QSize size ) const
 {
-	const auto scaledIcon = icon.scaled( size.width(), size.height(), Qt::KeepAspectRatio );
+	const auto scaledIcon = ImageScaler::scaled( icon, icon.size().scaled( size, Qt::KeepAspectRatio ) );
 
 	QImage scaledAndAlignedIcon( size, QImage::Format_ARGB32 );
 	scaledAndAlignedIcon.fill( Qt::transparent );
@@ -27,6 +27,7 @@
 #include <QAbstractListModel>
 #include <QQuickImageProvider>
 #include <QImage>
+#include <QMutex>
 
 #include "ComputerListModel.h"
 #include "ComputerControlInterface.h"
@@ -68,6 +69,16 @@ public:
 
 	QImage computerDecorationRole( const ComputerControlInterface::Pointer& controlInterface ) const;
 
+	quint64 decorationCacheHits() const
+	{
+		return m_decorationCacheHits;
+	}
+
+	quint64 decorationCacheMisses() const
+	{
+		return m_decorationCacheMisses;
+	}
+
 	void reload();
 
 Q_SIGNALS:
@@ -76,6 +87,7 @@ Q_SIGNALS:
 
 private:
 	void update();
+	void updateSelection( const ComputerList& selectedComputers, const NetworkObjectUidList& deselectedComputers );
 
 	QModelIndex interfaceIndex( ComputerControlInterface* controlInterface ) const;
 
@@ -90,6 +102,11 @@ private:
 
 	double averageAspectRatio() const;
 
+	void addComputerControlInterface( const ComputerControlInterface::Pointer& controlInterface );
+	void invalidateDecoration( ComputerControlInterface* controlInterface );
+	void invalidateDecorations();
+
+	QImage createDecoration( const ComputerControlInterface::Pointer& controlInterface ) const;
 	QImage scaleAndAlignIcon( const QImage& icon, QSize size ) const;
 	QString computerToolTipRole( const ComputerControlInterface::Pointer& controlInterface ) const;
 	QString computerDisplayRole( const ComputerControlInterface::Pointer& controlInterface ) const;
@@ -108,5 +125,13 @@ private:
 	QSize m_computerScreenSize{};
 
 	ComputerControlInterfaceList m_computerControlInterfaces{};
+	QHash<NetworkObject::Uid, ComputerControlInterface::Pointer> m_computerControlInterfacesByUid{};
+
+	// decorations are requested by the image provider for every screen update so keep them until
+	// they change
+	mutable QMutex m_decorationCacheMutex;
+	mutable QHash<NetworkObject::Uid, QImage> m_decorationCache{};
+	mutable quint64 m_decorationCacheHits{0};
+	mutable quint64 m_decorationCacheMisses{0};
 
 };
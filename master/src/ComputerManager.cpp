@@ -28,6 +28,7 @@
 #include <QHostInfo>
 #include <QMessageBox>
 #include <QTime>
+#include <QTimer>
 
 #include "ComputerManager.h"
 #include "VeyonConfiguration.h"
@@ -49,6 +50,7 @@ ComputerManager::ComputerManager( UserConfig& config, QObject* parent ) :
 	m_networkObjectOverlayDataModel(new NetworkObjectOverlayDataModel({tr("User"), tr("Logged in since")}, this)),
 	m_computerTreeModel( new CheckableItemProxyModel( NetworkObjectModel::UidRole, this ) ),
 	m_networkObjectFilterProxyModel( new NetworkObjectFilterProxyModel( this ) ),
+	m_selectionModificationsTimer( new QTimer( this ) ),
 	m_localHostNames( QHostInfo::localHostName().toLower() ),
 	m_localHostAddresses( QHostInfo::fromName( QHostInfo::localHostName() ).addresses() )
 {
@@ -70,6 +72,13 @@ ComputerManager::ComputerManager( UserConfig& config, QObject* parent ) :
 								 QHostInfo::localDomainName().toLower() );
 	}
 
+	// toggling a container changes the check states of all its children and parents so collect
+	// all modifications before passing them on
+	m_selectionModificationsTimer->setSingleShot( true );
+	m_selectionModificationsTimer->setInterval( 0 );
+	connect( m_selectionModificationsTimer, &QTimer::timeout,
+			 this, &ComputerManager::emitComputerSelectionModifications );
+
 	initNetworkObjectLayer();
 	initLocations();
 	initComputerTreeModel();
@@ -80,6 +89,8 @@ ComputerManager::ComputerManager( UserConfig& config, QObject* parent ) :
 ComputerManager::~ComputerManager()
 {
 	m_config.setCheckedNetworkObjects( m_computerTreeModel->saveStates() );
+
+	VeyonCore::networkObjectDirectoryManager().saveSnapshot();
 }
 
 
@@ -182,17 +193,80 @@ void ComputerManager::updateSessionInfo(const ComputerControlInterface::Pointer&
 
 void ComputerManager::checkChangedData( const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles )
 {
-	Q_UNUSED(topLeft)
-	Q_UNUSED(bottomRight)
+	if( roles.contains( Qt::CheckStateRole ) == false )
+	{
+		return;
+	}
 
-	if( roles.contains( Qt::CheckStateRole ) )
+	const auto model = computerTreeModel();
+	const auto parent = topLeft.parent();
+
+	for( int row = topLeft.row(); row <= bottomRight.row(); ++row )
 	{
-		Q_EMIT computerSelectionChanged();
+		const auto entryIndex = model->index( row, 0, parent );
+		if( NetworkObject::Type( model->data( entryIndex, NetworkObjectModel::TypeRole ).toInt() ) != NetworkObject::Type::Host )
+		{
+			continue;
+		}
+
+		const auto uid = model->data( entryIndex, NetworkObjectModel::UidRole ).toUuid();
+
+		if( model->data( entryIndex, NetworkObjectModel::CheckStateRole ).value<Qt::CheckState>() == Qt::Unchecked )
+		{
+			m_selectedComputers.remove( uid );
+			m_deselectedComputers.append( uid );
+		}
+		else
+		{
+			m_deselectedComputers.remove( uid );
+			m_selectedComputers[uid] = Computer( uid,
+												 model->data( entryIndex, NetworkObjectModel::NameRole ).toString(),
+												 model->data( entryIndex, NetworkObjectModel::HostAddressRole ).toString(),
+												 model->data( entryIndex, NetworkObjectModel::MacAddressRole ).toString(),
+												 model->data( parent, NetworkObjectModel::NameRole ).toString() );
+		}
+	}
+
+	m_selectionModificationsTimer->start();
+}
+
+
+
+void ComputerManager::emitComputerSelectionModifications()
+{
+	ComputerList selectedComputers;
+	selectedComputers.reserve( m_selectedComputers.size() );
+	for( const auto& computer : std::as_const(m_selectedComputers) )
+	{
+		selectedComputers.append( computer );
+	}
+
+	const auto deselectedComputers = m_deselectedComputers;
+
+	m_selectedComputers.clear();
+	m_deselectedComputers.clear();
+
+	if( selectedComputers.isEmpty() == false || deselectedComputers.isEmpty() == false )
+	{
+		Q_EMIT computerSelectionModified( selectedComputers, deselectedComputers );
 	}
 }
 
 
 
+// full updates triggered by computerSelectionReset() or computerSelectionChanged() already
+// reflect pending modifications, so they must not be applied afterwards (e.g. re-adding
+// a computer which has just been removed)
+void ComputerManager::discardComputerSelectionModifications()
+{
+	m_selectionModificationsTimer->stop();
+
+	m_selectedComputers.clear();
+	m_deselectedComputers.clear();
+}
+
+
+
 void ComputerManager::initLocations()
 {
 	for( const auto& hostName : std::as_const( m_localHostNames ) )
@@ -234,6 +308,9 @@ void ComputerManager::initLocations()
 
 void ComputerManager::initNetworkObjectLayer()
 {
+	// show the objects known from the last run until the directory has been updated
+	VeyonCore::networkObjectDirectoryManager().loadSnapshot();
+
 	m_networkObjectDirectory->update();
 	m_networkObjectDirectory->setUpdateInterval( VeyonCore::config().networkObjectDirectoryUpdateInterval() );
 	m_networkObjectOverlayDataModel->setSourceModel( m_networkObjectModel );
@@ -313,17 +390,22 @@ void ComputerManager::initComputerTreeModel()
 
 	m_computerTreeModel->loadStates( checkedNetworkObjects );
 
-	connect( computerTreeModel(), &QAbstractItemModel::modelReset,
-			 this, &ComputerManager::computerSelectionReset );
-	connect( computerTreeModel(), &QAbstractItemModel::layoutChanged,
-			 this, &ComputerManager::computerSelectionReset );
+	const auto resetSelection = [this]() {
+		discardComputerSelectionModifications();
+		Q_EMIT computerSelectionReset();
+	};
+	const auto updateSelection = [this]() {
+		discardComputerSelectionModifications();
+		Q_EMIT computerSelectionChanged();
+	};
+
+	connect( computerTreeModel(), &QAbstractItemModel::modelReset, this, resetSelection );
+	connect( computerTreeModel(), &QAbstractItemModel::layoutChanged, this, resetSelection );
 
 	connect( computerTreeModel(), &QAbstractItemModel::dataChanged,
 			 this, &ComputerManager::checkChangedData );
-	connect( computerTreeModel(), &QAbstractItemModel::rowsInserted,
-			 this, &ComputerManager::computerSelectionChanged );
-	connect( computerTreeModel(), &QAbstractItemModel::rowsRemoved,
-			 this, &ComputerManager::computerSelectionChanged );
+	connect( computerTreeModel(), &QAbstractItemModel::rowsInserted, this, updateSelection );
+	connect( computerTreeModel(), &QAbstractItemModel::rowsRemoved, this, updateSelection );
 }
 
 
@@ -479,7 +561,31 @@ ComputerList ComputerManager::selectedComputers(const QModelIndex& parent) const
 
 
 
-QModelIndex ComputerManager::findNetworkObject(NetworkObject::Uid networkObjectUid, const QModelIndex& parent) const
+QModelIndex ComputerManager::findNetworkObject(NetworkObject::Uid networkObjectUid) const
+{
+	const auto it = m_networkObjectIndexes.constFind( networkObjectUid );
+	if( it != m_networkObjectIndexes.constEnd() && it->isValid() &&
+		it->data( NetworkObjectModel::UidRole ).toUuid() == networkObjectUid )
+	{
+		return *it;
+	}
+
+	const auto index = searchNetworkObject( networkObjectUid, {} );
+	if( index.isValid() )
+	{
+		m_networkObjectIndexes[networkObjectUid] = index;
+	}
+	else
+	{
+		m_networkObjectIndexes.remove( networkObjectUid );
+	}
+
+	return index;
+}
+
+
+
+QModelIndex ComputerManager::searchNetworkObject(NetworkObject::Uid networkObjectUid, const QModelIndex& parent) const
 {
 	QAbstractItemModel* model = networkObjectModel();
 
@@ -493,7 +599,7 @@ QModelIndex ComputerManager::findNetworkObject(NetworkObject::Uid networkObjectU
 
 		if( NetworkObject::isContainer(objectType) )
 		{
-			QModelIndex index = findNetworkObject( networkObjectUid, entryIndex );
+			QModelIndex index = searchNetworkObject( networkObjectUid, entryIndex );
 			if( index.isValid() )
 			{
 				return index;
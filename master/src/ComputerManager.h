@@ -28,6 +28,7 @@
 #include "ComputerControlInterface.h"
 
 class QHostAddress;
+class QTimer;
 class NetworkObjectDirectory;
 class NetworkObjectFilterProxyModel;
 class NetworkObjectOverlayDataModel;
@@ -63,9 +64,13 @@ public:
 Q_SIGNALS:
 	void computerSelectionReset();
 	void computerSelectionChanged();
+	void computerSelectionModified( const ComputerList& selectedComputers,
+									const NetworkObjectUidList& deselectedComputers );
 
 private:
 	void checkChangedData( const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles );
+	void emitComputerSelectionModifications();
+	void discardComputerSelectionModifications();
 
 	void initLocations();
 	void initNetworkObjectLayer();
@@ -78,7 +83,8 @@ private:
 	ComputerList getComputersAtLocation(const QString& locationName, const QModelIndex& parent = {}, bool parentMatches = false) const;
 	bool hasSubLocations(const QModelIndex& index) const;
 
-	QModelIndex findNetworkObject(NetworkObject::Uid networkObjectUid, const QModelIndex& parent = {}) const;
+	QModelIndex findNetworkObject(NetworkObject::Uid networkObjectUid) const;
+	QModelIndex searchNetworkObject(NetworkObject::Uid networkObjectUid, const QModelIndex& parent) const;
 
 	QModelIndex mapToUserNameModelIndex(const QModelIndex& networkObjectIndex) const;
 	QModelIndex mapToSessionUptimeModelIndex(const QModelIndex& networkObjectIndex) const;
@@ -94,6 +100,12 @@ private:
 	CheckableItemProxyModel* m_computerTreeModel;
 	NetworkObjectFilterProxyModel* m_networkObjectFilterProxyModel;
 
+	mutable QHash<NetworkObject::Uid, QPersistentModelIndex> m_networkObjectIndexes;
+
+	QTimer* m_selectionModificationsTimer;
+	QHash<NetworkObject::Uid, Computer> m_selectedComputers;
+	NetworkObjectUidList m_deselectedComputers;
+
 	QStringList m_currentLocations;
 	QStringList m_locationFilterList;
 
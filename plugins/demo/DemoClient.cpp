@@ -24,15 +24,20 @@
 
 #include <QApplication>
 #include <QIcon>
+#include <QScreen>
+#include <QWindow>
 
 #include "DemoClient.h"
+#include "DemoFeaturePlugin.h"
 #include "LockWidget.h"
 #include "PlatformCoreFunctions.h"
 #include "VncViewWidget.h"
 
 
-DemoClient::DemoClient( const QString& host, int port, bool fullscreen, QRect viewport, QObject* parent ) :
+DemoClient::DemoClient( const QString& host, int port, bool fullscreen, QRect viewport,
+						Feature::Uid demoServerFeatureUid, QObject* parent ) :
 	QObject( parent ),
+	m_demoServerFeatureUid( demoServerFeatureUid ),
 	m_computerControlInterface( ComputerControlInterface::Pointer::create( Computer( {}, host, host ), port, this ) )
 {
 	if( fullscreen )
@@ -63,6 +68,13 @@ DemoClient::DemoClient( const QString& host, int port, bool fullscreen, QRect vi
 
 	resizeToplevelWidget();
 
+	// let the demo server send a downscaled stream if our screen is smaller than
+	// the demo framebuffer - not possible when displaying a part of it only
+	if( viewport.isNull() )
+	{
+		m_computerControlInterface->executeIfConnected( [this]() { sendViewportSize(); } );
+	}
+
 	VeyonCore::platform().coreFunctions().raiseWindow( m_toplevel, fullscreen );
 
 	VeyonCore::platform().coreFunctions().disableScreenSaver();
@@ -116,3 +128,30 @@ void DemoClient::resizeToplevelWidget()
 		m_toplevel->resize(m_vncView->sizeHint());
 	}
 }
+
+
+
+void DemoClient::sendViewportSize()
+{
+	if( m_toplevel == nullptr )
+	{
+		return;
+	}
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
+	const auto* screen = m_toplevel->windowHandle() ? m_toplevel->windowHandle()->screen() : nullptr;
+#else
+	const auto* screen = m_toplevel->screen();
+#endif
+	if( screen == nullptr )
+	{
+		return;
+	}
+
+	const auto size = screen->size() * screen->devicePixelRatio();
+
+	m_computerControlInterface->sendFeatureMessage(
+				FeatureMessage{ m_demoServerFeatureUid, DemoFeaturePlugin::SetDemoClientViewportSize }
+				.addArgument( DemoFeaturePlugin::Argument::ViewportWidth, size.width() )
+				.addArgument( DemoFeaturePlugin::Argument::ViewportHeight, size.height() ) );
+}
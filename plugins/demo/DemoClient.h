@@ -34,7 +34,8 @@ class DemoClient : public QObject
 {
 	Q_OBJECT
 public:
-	DemoClient( const QString& host, int port, bool fullscreen, QRect viewport, QObject* parent = nullptr );
+	DemoClient( const QString& host, int port, bool fullscreen, QRect viewport, Feature::Uid demoServerFeatureUid,
+				QObject* parent = nullptr );
 	~DemoClient() override;
 
 protected:
@@ -43,6 +44,9 @@ protected:
 private:
 	void viewDestroyed( QObject* obj );
 	void resizeToplevelWidget();
+	void sendViewportSize();
+
+	const Feature::Uid m_demoServerFeatureUid;
 
 	QWidget* m_toplevel{nullptr};
 
@@ -391,6 +391,7 @@ bool DemoFeaturePlugin::handleFeatureMessage( VeyonWorkerInterface& worker, cons
 											   *this,
 											   m_configuration,
 											   message.argument( Argument::DemoServerPort ).toInt(),
+											   m_demoServerFeature.uid(),
 											   this );
 			}
 			return true;
@@ -426,7 +427,8 @@ bool DemoFeaturePlugin::handleFeatureMessage( VeyonWorkerInterface& worker, cons
 				const auto viewport = message.argument( Argument::Viewport ).toRect();
 
 				vDebug() << "connecting with master" << demoServerHost;
-				m_demoClient = new DemoClient( demoServerHost, demoServerPort, isFullscreenDemo, viewport );
+				m_demoClient = new DemoClient( demoServerHost, demoServerPort, isFullscreenDemo, viewport,
+											   m_demoServerFeature.uid() );
 			}
 			return true;
 
@@ -61,6 +61,14 @@ public:
 	};
 	Q_ENUM(Argument)
 
+	enum Commands {
+		StartDemoServer,
+		StopDemoServer,
+		StartDemoClient,
+		StopDemoClient,
+		SetDemoClientViewportSize
+	};
+
 	explicit DemoFeaturePlugin( QObject* parent = nullptr );
 	~DemoFeaturePlugin() override = default;
 
@@ -133,13 +141,6 @@ private:
 	bool controlDemoClient( Feature::Uid featureUid, Operation operation, const QVariantMap& arguments,
 						   const ComputerControlInterfaceList& computerControlInterfaces );
 
-	enum Commands {
-		StartDemoServer,
-		StopDemoServer,
-		StartDemoClient,
-		StopDemoClient
-	};
-
 	const Feature m_demoFeature;
 	const Feature m_demoClientFullScreenFeature;
 	const Feature m_demoClientWindowFeature;
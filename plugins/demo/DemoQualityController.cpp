@@ -0,0 +1,132 @@
+/*
+ * DemoQualityController.cpp - implementation of DemoQualityController class
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QtMath>
+
+#include "DemoQualityController.h"
+
+
+DemoQualityController::DemoQualityController( qint64 bandwidthLimit, int updateInterval ) :
+	m_bandwidthLimit( qMax<qint64>( 1, bandwidthLimit ) ),
+	m_minimumUpdateInterval( qMax( 1, updateInterval ) ),
+	m_maximumUpdateInterval( m_minimumUpdateInterval * MaximumUpdateIntervalFactor )
+{
+	m_statistics.decision.updateInterval = m_minimumUpdateInterval;
+}
+
+
+
+bool DemoQualityController::update( const QVector<Sample>& samples, int elapsedTime )
+{
+	if( elapsedTime <= 0 )
+	{
+		return false;
+	}
+
+	qint64 sentBytes = 0;
+	qint64 queuedBytes = 0;
+
+	for( const auto& sample : samples )
+	{
+		sentBytes += sample.sentBytes;
+		queuedBytes += sample.queuedBytes;
+	}
+
+	// data which would have been sent if the links were not saturated
+	const auto queueGrowth = qMax<qint64>( 0, queuedBytes - m_previousQueuedBytes );
+	m_previousQueuedBytes = queuedBytes;
+
+	const auto throughput = sentBytes * 1000 / 1024 / elapsedTime;
+	const auto demand = ( sentBytes + queueGrowth ) * 1000 / 1024 / elapsedTime;
+
+	m_smoothedDemand = DemandSmoothingFactor * demand + ( 1 - DemandSmoothingFactor ) * m_smoothedDemand;
+
+	m_statistics.clientCount = samples.size();
+	m_statistics.throughput = throughput;
+	m_statistics.demand = qRound64( m_smoothedDemand );
+	m_statistics.queuedBytes = queuedBytes;
+
+	if( samples.isEmpty() )
+	{
+		return false;
+	}
+
+	const auto previousDecision = m_statistics.decision;
+
+	const auto load = m_smoothedDemand / m_bandwidthLimit;
+	// more than one second of data queued means the links are saturated regardless of throughput
+	const auto backlogged = queuedBytes / 1024 > m_bandwidthLimit;
+
+	if( load > HighLoad || backlogged )
+	{
+		decreaseLoad( load );
+	}
+	else if( load < LowLoad && queueGrowth == 0 )
+	{
+		increaseLoad();
+	}
+
+	return m_statistics.decision != previousDecision;
+}
+
+
+
+void DemoQualityController::decreaseLoad( double load )
+{
+	auto& decision = m_statistics.decision;
+
+	decision.compressionLevel = MaximumCompressionLevel;
+
+	if( decision.quality > MinimumQuality )
+	{
+		decision.quality = qMax( int(MinimumQuality), decision.quality - qMax( 1, int(load) ) );
+	}
+	else
+	{
+		// can't reduce quality any further so request updates less frequently
+		decision.updateInterval = qMin( m_maximumUpdateInterval, decision.updateInterval * 3 / 2 );
+	}
+}
+
+
+
+void DemoQualityController::increaseLoad()
+{
+	auto& decision = m_statistics.decision;
+
+	// restore update rate first as it affects perceived latency most
+	if( decision.updateInterval > m_minimumUpdateInterval )
+	{
+		decision.updateInterval = qMax( m_minimumUpdateInterval, decision.updateInterval * 2 / 3 );
+	}
+	else if( decision.quality < MaximumQuality )
+	{
+		++decision.quality;
+	}
+	else if( decision.compressionLevel > MinimumCompressionLevel )
+	{
+		// plenty of bandwidth left so save some CPU time
+		--decision.compressionLevel;
+	}
+}
@@ -0,0 +1,113 @@
+/*
+ * DemoQualityController.h - header file for DemoQualityController class
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QVector>
+
+// determines encoding quality, compression level and framebuffer update interval
+// for the demo server based on the data actually sent to and queued for all
+// connected clients so the aggregated bandwidth stays below the configured limit
+//
+// The controller does not depend on sockets or timers, i.e. it can be fed with
+// samples from any source such as a simulated link.
+class DemoQualityController
+{
+public:
+	static constexpr auto MinimumQuality = 0;
+	static constexpr auto DefaultQuality = 6;
+	static constexpr auto MaximumQuality = 9;
+	static constexpr auto MinimumCompressionLevel = 6;
+	static constexpr auto MaximumCompressionLevel = 9;
+	static constexpr auto MaximumUpdateIntervalFactor = 8;
+
+	// data of a single connection since the previous sample
+	struct Sample
+	{
+		qint64 sentBytes{0};
+		qint64 queuedBytes{0};
+	};
+
+	struct Decision
+	{
+		int quality{DefaultQuality};
+		int compressionLevel{MaximumCompressionLevel};
+		int updateInterval{0};
+
+		bool operator==( const Decision& other ) const
+		{
+			return quality == other.quality &&
+					compressionLevel == other.compressionLevel &&
+					updateInterval == other.updateInterval;
+		}
+
+		bool operator!=( const Decision& other ) const
+		{
+			return !( *this == other );
+		}
+	};
+
+	struct Statistics
+	{
+		int clientCount{0};
+		qint64 throughput{0};	// KB/s
+		qint64 demand{0};		// KB/s
+		qint64 queuedBytes{0};
+		Decision decision{};
+	};
+
+	// bandwidth limit in KB/s, update interval in ms
+	DemoQualityController( qint64 bandwidthLimit, int updateInterval );
+
+	// returns true if decision has changed
+	bool update( const QVector<Sample>& samples, int elapsedTime );
+
+	const Decision& decision() const
+	{
+		return m_statistics.decision;
+	}
+
+	const Statistics& statistics() const
+	{
+		return m_statistics;
+	}
+
+private:
+	void decreaseLoad( double load );
+	void increaseLoad();
+
+	static constexpr auto HighLoad = 1.0;
+	static constexpr auto LowLoad = 0.6;
+	static constexpr auto DemandSmoothingFactor = 0.5;
+
+	const qint64 m_bandwidthLimit;
+	const int m_minimumUpdateInterval;
+	const int m_maximumUpdateInterval;
+
+	double m_smoothedDemand{0};
+	qint64 m_previousQueuedBytes{0};
+
+	Statistics m_statistics{};
+
+};
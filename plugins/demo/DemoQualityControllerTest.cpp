@@ -0,0 +1,183 @@
+/*
+ * DemoQualityControllerTest.cpp - tests for DemoQualityController
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QTest>
+
+#include "DemoQualityController.h"
+
+// simulates the demo server producing framebuffer updates according to the current
+// decision and sending them to clients over links with limited capacity
+class SimulatedDemo
+{
+public:
+	static constexpr auto SampleInterval = 1000;
+	static constexpr auto FrameSizePerQualityLevel = 20 * 1024;
+
+	SimulatedDemo( qint64 bandwidthLimit, int updateInterval, int clientCount, qint64 linkCapacity ) :
+		m_controller( bandwidthLimit, updateInterval ),
+		m_links( clientCount, Link{ linkCapacity, 0 } )
+	{
+	}
+
+	void setLinkCapacity( qint64 linkCapacity )
+	{
+		for( auto& link : m_links )
+		{
+			link.capacity = linkCapacity;
+		}
+	}
+
+	void run( int sampleCount )
+	{
+		for( int i = 0; i < sampleCount; ++i )
+		{
+			const auto& decision = m_controller.decision();
+
+			m_elapsedFrameTime += SampleInterval;
+			const auto frameCount = m_elapsedFrameTime / decision.updateInterval;
+			m_elapsedFrameTime %= decision.updateInterval;
+
+			const auto producedBytes = frameCount * FrameSizePerQualityLevel * qint64( decision.quality + 1 );
+
+			QVector<DemoQualityController::Sample> samples;
+			samples.reserve( m_links.size() );
+
+			for( auto& link : m_links )
+			{
+				link.queuedBytes += producedBytes;
+				const auto sentBytes = qMin( link.queuedBytes, link.capacity * 1024 * SampleInterval / 1000 );
+				link.queuedBytes -= sentBytes;
+
+				samples.append( { sentBytes, link.queuedBytes } );
+			}
+
+			m_controller.update( samples, SampleInterval );
+		}
+	}
+
+	const DemoQualityController& controller() const
+	{
+		return m_controller;
+	}
+
+private:
+	struct Link
+	{
+		qint64 capacity;	// KB/s
+		qint64 queuedBytes;
+	};
+
+	DemoQualityController m_controller;
+	QVector<Link> m_links;
+	int m_elapsedFrameTime{0};
+
+};
+
+
+
+class DemoQualityControllerTest : public QObject
+{
+	Q_OBJECT
+private Q_SLOTS:
+	void ignoresInvalidSamples();
+	void usesSpareBandwidth();
+	void adaptsToBandwidthLimit();
+	void recoversAfterCongestion();
+
+private:
+	static constexpr auto BandwidthLimit = 1000;
+	static constexpr auto UpdateInterval = 100;
+
+};
+
+
+
+void DemoQualityControllerTest::ignoresInvalidSamples()
+{
+	DemoQualityController controller( BandwidthLimit, UpdateInterval );
+	const auto initialDecision = controller.decision();
+
+	QCOMPARE( controller.update( { { 1024 * 1024, 0 } }, 0 ), false );
+	QCOMPARE( controller.update( {}, SimulatedDemo::SampleInterval ), false );
+	QVERIFY( controller.decision() == initialDecision );
+	QCOMPARE( controller.statistics().clientCount, 0 );
+}
+
+
+
+void DemoQualityControllerTest::usesSpareBandwidth()
+{
+	SimulatedDemo demo( 100 * BandwidthLimit, UpdateInterval, 4, 100 * BandwidthLimit );
+	demo.run( 30 );
+
+	const auto& decision = demo.controller().decision();
+	QCOMPARE( decision.quality, int(DemoQualityController::MaximumQuality) );
+	QCOMPARE( decision.compressionLevel, int(DemoQualityController::MinimumCompressionLevel) );
+	QCOMPARE( decision.updateInterval, UpdateInterval );
+	QCOMPARE( demo.controller().statistics().clientCount, 4 );
+}
+
+
+
+void DemoQualityControllerTest::adaptsToBandwidthLimit()
+{
+	SimulatedDemo demo( BandwidthLimit, UpdateInterval, 1, BandwidthLimit );
+	demo.run( 50 );
+
+	const auto& decision = demo.controller().decision();
+	const auto& statistics = demo.controller().statistics();
+
+	// quality has to be reduced to stay within the limit but not more than necessary
+	QVERIFY( decision.quality < DemoQualityController::DefaultQuality );
+	QVERIFY( decision.quality > DemoQualityController::MinimumQuality );
+	QCOMPARE( decision.updateInterval, UpdateInterval );
+	QVERIFY( statistics.throughput <= BandwidthLimit );
+
+	// queues must not build up permanently
+	QVERIFY( statistics.queuedBytes / 1024 < BandwidthLimit );
+}
+
+
+
+void DemoQualityControllerTest::recoversAfterCongestion()
+{
+	SimulatedDemo demo( BandwidthLimit, UpdateInterval, 2, BandwidthLimit / 10 );
+	demo.run( 20 );
+
+	// lowest quality still saturates the links so updates have to be sent less often
+	QCOMPARE( demo.controller().decision().quality, int(DemoQualityController::MinimumQuality) );
+	QVERIFY( demo.controller().decision().updateInterval > UpdateInterval );
+	QVERIFY( demo.controller().decision().updateInterval <= UpdateInterval * DemoQualityController::MaximumUpdateIntervalFactor );
+
+	demo.setLinkCapacity( 100 * BandwidthLimit );
+	demo.run( 100 );
+
+	QCOMPARE( demo.controller().decision().updateInterval, UpdateInterval );
+	QVERIFY( demo.controller().decision().quality > DemoQualityController::MinimumQuality );
+	QCOMPARE( demo.controller().statistics().queuedBytes, 0 );
+}
+
+
+QTEST_APPLESS_MAIN(DemoQualityControllerTest)
+#include "DemoQualityControllerTest.moc"
@@ -23,32 +23,32 @@
  *
  */
 
-#include "rfb/rfbproto.h"
-
-#include <QTcpSocket>
-
 #include "DemoConfiguration.h"
 #include "DemoServer.h"
 #include "DemoServerConnection.h"
-#include "VncClientProtocol.h"
+#include "DemoServerStream.h"
 
 
 DemoServer::DemoServer( int vncServerPort, const Password& vncServerPassword, const DemoAuthentication& authentication,
-						const DemoConfiguration& configuration, int demoServerPort, QObject *parent ) :
+						const DemoConfiguration& configuration, int demoServerPort, Feature::Uid featureUid,
+						QObject *parent ) :
 	QTcpServer( parent ),
 	m_authentication( authentication ),
 	m_configuration( configuration ),
+	m_featureUid( featureUid ),
+	m_vncServerPort( vncServerPort ),
+	m_vncServerPassword( vncServerPassword ),
 	m_memoryLimit( m_configuration.memoryLimit() * 1024*1024 ),
 	m_keyFrameInterval( m_configuration.keyFrameInterval() * 1000 ),
-	m_vncServerPort( vncServerPort ),
-	m_vncServerSocket( new QTcpSocket( this ) ),
-	m_vncClientProtocol(new VncClientProtocol(m_vncServerSocket, vncServerPassword)),
-	m_bandwidthLimit(qMax(1, m_configuration.bandwidthLimit()) * 1024)
+	m_qualityController(qMax(1, m_configuration.bandwidthLimit()) * 1024, m_configuration.framebufferUpdateInterval())
 {
-	connect( m_vncServerSocket, &QTcpSocket::readyRead, this, &DemoServer::readFromVncServer );
-	connect( m_vncServerSocket, &QTcpSocket::disconnected, this, &DemoServer::reconnectToVncServer );
-
 	connect( &m_framebufferUpdateTimer, &QTimer::timeout, this, &DemoServer::requestFramebufferUpdate );
+	connect( &m_qualityControlTimer, &QTimer::timeout, this, &DemoServer::updateQuality );
+
+	// create primary stream in any case so primaryStream() is always valid
+	createStream( 0 );
+
+	connect( primaryStream(), &DemoServerStream::started, this, &DemoServer::acceptPendingConnections );
 
 	if( listen( QHostAddress::Any, demoServerPort ) == false )
 	{
@@ -56,24 +56,22 @@ DemoServer::DemoServer( int vncServerPort, const Password& vncServerPassword, co
 		return;
 	}
 
-	m_framebufferUpdateTimer.start( m_configuration.framebufferUpdateInterval() );
-
-	reconnectToVncServer();
-}
-
-
-
-DemoServer::~DemoServer()
-{
-	delete m_vncClientProtocol;
-	delete m_vncServerSocket;
+	m_framebufferUpdateTimer.start( m_qualityController.decision().updateInterval );
+	m_qualityControlTimer.start( QualityControlInterval );
+	m_qualityControlElapsedTimer.start();
 }
 
 
 
 void DemoServer::terminate()
 {
-	m_vncServerSocket->disconnect( this );
+	for( const auto& stream : m_streams )
+	{
+		if( stream.loadAcquire() )
+		{
+			stream.loadAcquire()->stop();
+		}
+	}
 
 	const auto connections = findChildren<DemoServerConnection *>();
 	if( connections.isEmpty() )
@@ -98,25 +96,61 @@ void DemoServer::terminate()
 
 
 
-const QByteArray& DemoServer::serverInitMessage() const
+QByteArray DemoServer::serverInitMessage() const
 {
-	return m_vncClientProtocol->serverInitMessage();
+	return primaryStream()->serverInitMessage();
 }
 
 
 
-void DemoServer::lockDataForRead()
+DemoServerStream* DemoServer::selectStream( QSize viewerSize, bool* betterStreamPending ) const
 {
-	QElapsedTimer readLockTimer;
-	readLockTimer.restart();
+	auto selectedStream = primaryStream();
 
-	m_dataLock.lockForRead();
+	*betterStreamPending = false;
 
-	if( readLockTimer.elapsed() > 100 )
+	const auto nativeSize = selectedStream->framebufferSize();
+	if( viewerSize.isValid() == false || viewerSize.isEmpty() || nativeSize.isEmpty() )
 	{
-		vDebug() << "locking for read took" << readLockTimer.elapsed() << "ms in thread"
-				 << QThread::currentThreadId();
+		return selectedStream;
+	}
+
+	for( size_t i = 1; i < m_streams.size(); ++i )
+	{
+		// skip scales which would result in a framebuffer smaller than the viewer
+		if( nativeSize.width() / StreamScales[i] < viewerSize.width() ||
+			nativeSize.height() / StreamScales[i] < viewerSize.height() )
+		{
+			continue;
+		}
+
+		const auto stream = m_streams[i].loadAcquire();
+		if( stream == nullptr )
+		{
+			// streams may only be created in the thread of the demo server
+			const auto server = const_cast<DemoServer *>( this );
+			QMetaObject::invokeMethod( server, [server, i]() { server->createStream( int(i) ); }, Qt::QueuedConnection );
+			*betterStreamPending = true;
+			continue;
+		}
+
+		if( stream->isReady() == false )
+		{
+			*betterStreamPending |= stream->isStopped() == false;
+			continue;
+		}
+
+		const auto framebufferSize = stream->framebufferSize();
+		if( framebufferSize.width() >= viewerSize.width() &&
+			framebufferSize.height() >= viewerSize.height() )
+		{
+			selectedStream = stream;
+			// better streams only matter as long as they're not ready yet
+			*betterStreamPending = false;
+		}
 	}
+
+	return selectedStream;
 }
 
 
@@ -127,7 +161,7 @@ void DemoServer::incomingConnection( qintptr socketDescriptor )
 
 	m_pendingConnections.append( socketDescriptor );
 
-	if( m_vncClientProtocol->state() == VncClientProtocol::State::Running )
+	if( primaryStream()->isReady() )
 	{
 		acceptPendingConnections();
 	}
@@ -145,228 +179,75 @@ void DemoServer::acceptPendingConnections()
 
 
 
-void DemoServer::reconnectToVncServer()
-{
-	m_vncClientProtocol->start();
-
-	m_vncServerSocket->connectToHost( QHostAddress::LocalHost, static_cast<quint16>( m_vncServerPort ) );
-}
-
-
-
-void DemoServer::readFromVncServer()
-{
-	if( m_vncClientProtocol->state() != VncClientProtocol::State::Running )
-	{
-		while( m_vncClientProtocol->read() )
-		{
-		}
-
-		if( m_vncClientProtocol->state() == VncClientProtocol::State::Running )
-		{
-			start();
-		}
-	}
-	else
-	{
-		while( receiveVncServerMessage() )
-		{
-		}
-	}
-}
-
-
-
 void DemoServer::requestFramebufferUpdate()
 {
-	if( m_vncClientProtocol->state() != VncClientProtocol::State::Running )
-	{
-		return;
-	}
-
-	if( m_requestFullFramebufferUpdate ||
-		m_lastFullFramebufferUpdate.elapsed() >= m_keyFrameInterval )
-	{
-		vDebug() << "Requesting full framebuffer update";
-		m_vncClientProtocol->requestFramebufferUpdate( false );
-		m_lastFullFramebufferUpdate.restart();
-		m_requestFullFramebufferUpdate = false;
-	}
-	else
+	for( const auto& stream : m_streams )
 	{
-		m_vncClientProtocol->requestFramebufferUpdate( true );
-	}
-}
-
-
-
-bool DemoServer::receiveVncServerMessage()
-{
-	if( m_vncClientProtocol->receiveMessage() )
-	{
-		if( m_vncClientProtocol->lastMessageType() == rfbFramebufferUpdate )
-		{
-			enqueueFramebufferUpdateMessage( m_vncClientProtocol->lastMessage() );
-		}
-		else
+		if( stream.loadAcquire() )
 		{
-			vWarning() << "skipping server message of type" << static_cast<int>( m_vncClientProtocol->lastMessageType() );
+			stream.loadAcquire()->requestFramebufferUpdate();
 		}
-
-		return true;
 	}
-
-	return false;
 }
 
 
 
-void DemoServer::enqueueFramebufferUpdateMessage( const QByteArray& message )
+void DemoServer::updateQuality()
 {
-	QElapsedTimer writeLockTime;
-	writeLockTime.start();
+	const auto connections = findChildren<DemoServerConnection *>();
 
-	m_dataLock.lockForWrite();
+	QVector<DemoQualityController::Sample> samples;
+	samples.reserve( connections.size() );
 
-	if( writeLockTime.elapsed() > 10 )
+	for( auto connection : connections )
 	{
-		vDebug() << "locking for write took" << writeLockTime.elapsed() << "ms";
+		samples.append( { connection->takeSentBytes(), connection->queuedBytes() } );
 	}
 
-	const auto lastUpdatedRect = m_vncClientProtocol->lastUpdatedRect();
-
-	const bool isFullUpdate = ( lastUpdatedRect.x() == 0 && lastUpdatedRect.y() == 0 &&
-								lastUpdatedRect.width() == m_vncClientProtocol->framebufferWidth() &&
-								lastUpdatedRect.height() == m_vncClientProtocol->framebufferHeight() );
+	const auto elapsedTime = int( m_qualityControlElapsedTimer.restart() );
 
-	const auto queueSize = framebufferUpdateMessageQueueSize();
-
-	if( isFullUpdate || queueSize > m_memoryLimit*2 )
+	if( m_qualityController.update( samples, elapsedTime ) )
 	{
-		if( m_keyFrameTimer.elapsed() > 1 )
-		{
-			const auto memTotal = queueSize / 1024;
-			const auto bandwidth = qMax<int>(1, (memTotal * 1000) / m_keyFrameTimer.elapsed());
-			const auto clientCount = qMin(1, findChildren<DemoServerConnection *>().count());
-			const auto totalBandwidth = bandwidth * clientCount;
-
-			auto newQuality = m_quality;
-			if (totalBandwidth > m_bandwidthLimit)
-			{
-				newQuality = qMax(int(MinimumQuality),
-								  m_quality - qMax(1, int(totalBandwidth / m_bandwidthLimit)));
-			}
-			else if (totalBandwidth < m_bandwidthLimit * 4 / 5)
-			{
-				newQuality = qMin(int(MaximumQuality),
-								  m_quality + qMax(1, int(m_bandwidthLimit / totalBandwidth)));
-			}
+		const auto& decision = m_qualityController.decision();
 
-			if (newQuality != m_quality)
+		for( const auto& stream : m_streams )
+		{
+			if( stream.loadAcquire() )
 			{
-				setVncServerEncodings(newQuality);
+				stream.loadAcquire()->setEncodings( decision );
 			}
-
-			vDebug() << "message count:" << m_framebufferUpdateMessages.size()
-					 << "queue size (KB):" << memTotal
-					 << "total bandwidth (KB/s):" << totalBandwidth << "of" << m_bandwidthLimit
-					 << "bandwidth per client (KB/s):" << bandwidth
-					 << "quality" << m_quality;
 		}
-		m_keyFrameTimer.restart();
-		++m_keyFrame;
 
-		m_framebufferUpdateMessages.clear();
+		m_framebufferUpdateTimer.setInterval( decision.updateInterval );
 	}
 
-	m_framebufferUpdateMessages.append( message );
-
-	m_dataLock.unlock();
-
-	// we're about to reach memory limits?
-	if( framebufferUpdateMessageQueueSize() > m_memoryLimit )
+	const auto& statistics = m_qualityController.statistics();
+	if( statistics.clientCount > 0 )
 	{
-		// then request a full update so we can clear our queue
-		m_requestFullFramebufferUpdate = true;
+		vDebug() << "clients:" << statistics.clientCount
+				 << "throughput (KB/s):" << statistics.throughput
+				 << "demand (KB/s):" << statistics.demand
+				 << "queued (KB):" << statistics.queuedBytes / 1024
+				 << "quality:" << statistics.decision.quality
+				 << "compression:" << statistics.decision.compressionLevel
+				 << "update interval (ms):" << statistics.decision.updateInterval;
 	}
 }
 
 
 
-qint64 DemoServer::framebufferUpdateMessageQueueSize() const
+void DemoServer::createStream( int index )
 {
-	qint64 size = 0;
-
-	for( const auto& message : std::as_const( m_framebufferUpdateMessages ) )
-	{
-		size += message.size();
-	}
-
-	return size;
-}
-
-
-
-void DemoServer::start()
-{
-	vDebug();
-
-	setVncServerPixelFormat();
-	setVncServerEncodings(DefaultQuality);
-
-	m_requestFullFramebufferUpdate = true;
-
-	requestFramebufferUpdate();
-
-	while( receiveVncServerMessage() )
+	if( m_streams[size_t(index)].loadAcquire() )
 	{
+		return;
 	}
 
-	acceptPendingConnections();
-}
-
+	vDebug() << "creating stream at scale" << StreamScales[size_t(index)];
 
+	auto stream = new DemoServerStream( m_vncServerPort, m_vncServerPassword, StreamScales[size_t(index)],
+										m_memoryLimit, m_keyFrameInterval, this );
+	stream->setEncodings( m_qualityController.decision() );
 
-bool DemoServer::setVncServerPixelFormat()
-{
-	rfbPixelFormat format;
-
-	format.bitsPerPixel = 32;
-	format.depth = 24;
-	format.bigEndian = qFromBigEndian<uint16_t>( 1 ) == 1 ? true : false;
-	format.trueColour = 1;
-	format.redShift = 16;
-	format.greenShift = 8;
-	format.blueShift = 0;
-	format.redMax = 0xff;
-	format.greenMax = 0xff;
-	format.blueMax = 0xff;
-	format.pad1 = 0;
-	format.pad2 = 0;
-
-	return m_vncClientProtocol->setPixelFormat( format );
-}
-
-
-
-bool DemoServer::setVncServerEncodings(int quality)
-{
-	m_quality = quality;
-
-	return m_vncClientProtocol->
-			setEncodings( {
-							  rfbEncodingTight,
-							  rfbEncodingZYWRLE,
-							  rfbEncodingZRLE,
-							  rfbEncodingUltra,
-							  rfbEncodingCopyRect,
-							  rfbEncodingHextile,
-							  rfbEncodingCoRRE,
-							  rfbEncodingRRE,
-							  rfbEncodingRaw,
-							  rfbEncodingCompressLevel9,
-							  rfbEncodingQualityLevel0 + quality,
-							  rfbEncodingNewFBSize,
-							  rfbEncodingLastRect
-						  } );
+	m_streams[size_t(index)].storeRelease( stream );
 }
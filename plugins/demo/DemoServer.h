@@ -25,29 +25,32 @@
 
 #pragma once
 
+#include <array>
+
+#include <QAtomicPointer>
 #include <QElapsedTimer>
-#include <QReadWriteLock>
+#include <QSize>
 #include <QTcpServer>
 #include <QTimer>
 
 #include "CryptoCore.h"
+#include "DemoQualityController.h"
+#include "Feature.h"
 
 class DemoAuthentication;
 class DemoConfiguration;
+class DemoServerStream;
 class QTcpServer;
-class QTcpSocket;
-class VncClientProtocol;
 
 class DemoServer : public QTcpServer
 {
 	Q_OBJECT
 public:
 	using Password = CryptoCore::PlaintextPassword;
-	using MessageList = QVector<QByteArray>;
 
 	DemoServer( int vncServerPort, const Password& vncServerPassword, const DemoAuthentication& authentication,
-				const DemoConfiguration& configuration, int demoServerPort, QObject *parent );
-	~DemoServer() override;
+				const DemoConfiguration& configuration, int demoServerPort, Feature::Uid featureUid, QObject *parent );
+	~DemoServer() override = default;
 
 	void terminate();
 
@@ -56,66 +59,61 @@ public:
 		return m_configuration;
 	}
 
-	const QByteArray& serverInitMessage() const;
-
-	void lockDataForRead();
-
-	void unlockData()
+	Feature::Uid featureUid() const
 	{
-		m_dataLock.unlock();
+		return m_featureUid;
 	}
 
-	int keyFrame() const
+	QByteArray serverInitMessage() const;
+
+	DemoServerStream* primaryStream() const
 	{
-		return m_keyFrame;
+		return m_streams[0].loadAcquire();
 	}
 
-	const MessageList& framebufferUpdateMessages() const
+	// returns the stream with the smallest framebuffer still covering the given
+	// viewer size, may be called from any thread - scaled streams are created on
+	// demand, i.e. betterStreamPending is set if a more suitable stream is going
+	// to be available later
+	DemoServerStream* selectStream( QSize viewerSize, bool* betterStreamPending ) const;
+
+	const DemoQualityController::Statistics& qualityStatistics() const
 	{
-		return m_framebufferUpdateMessages;
+		return m_qualityController.statistics();
 	}
 
 private:
 	void incomingConnection( qintptr socketDescriptor ) override;
 	void acceptPendingConnections();
-	void reconnectToVncServer();
-	void readFromVncServer();
 	void requestFramebufferUpdate();
+	void updateQuality();
 
-	bool receiveVncServerMessage();
-	void enqueueFramebufferUpdateMessage( const QByteArray& message );
-
-	qint64 framebufferUpdateMessageQueueSize() const;
-
-	void start();
-	bool setVncServerPixelFormat();
-	bool setVncServerEncodings(int quality);
+	void createStream( int index );
 
 	static constexpr auto ConnectionThreadWaitTime = 5000;
 	static constexpr auto TerminateRetryInterval = 1000;
-	static constexpr auto MinimumQuality = 0;
-	static constexpr auto DefaultQuality = 6;
-	static constexpr auto MaximumQuality = 9;
+	static constexpr auto QualityControlInterval = 1000;
+	static constexpr std::array<int, 3> StreamScales{ { 1, 2, 4 } };
 
 	const DemoAuthentication& m_authentication;
 	const DemoConfiguration& m_configuration;
+	const Feature::Uid m_featureUid;
+
+	const int m_vncServerPort;
+	const Password m_vncServerPassword;
 	const qint64 m_memoryLimit;
 	const int m_keyFrameInterval;
-	const int m_vncServerPort;
 
 	QList<quintptr> m_pendingConnections;
-	QTcpSocket* m_vncServerSocket;
-	VncClientProtocol* m_vncClientProtocol;
 
-	QReadWriteLock m_dataLock{};
+	// primary stream at native resolution comes first, followed by streams with
+	// increasing scale divisor which are created on first selection by a viewer
+	std::array<QAtomicPointer<DemoServerStream>, StreamScales.size()> m_streams{};
+
 	QTimer m_framebufferUpdateTimer{this};
-	QElapsedTimer m_lastFullFramebufferUpdate{};
-	QElapsedTimer m_keyFrameTimer{};
-	bool m_requestFullFramebufferUpdate{false};
-
-	int m_keyFrame{0};
-	MessageList m_framebufferUpdateMessages{};
-	int m_quality = DefaultQuality;
-	int m_bandwidthLimit;
+	QTimer m_qualityControlTimer{this};
+	QElapsedTimer m_qualityControlElapsedTimer{};
+
+	DemoQualityController m_qualityController;
 
 } ;
@@ -28,9 +28,12 @@
 #include <QTcpSocket>
 
 #include "DemoConfiguration.h"
+#include "DemoFeaturePlugin.h"
 #include "DemoServer.h"
 #include "DemoServerConnection.h"
+#include "DemoServerStream.h"
 #include "FeatureMessage.h"
+#include "PlatformNetworkFunctions.h"
 
 
 DemoServerConnection::DemoServerConnection( DemoServer* demoServer,
@@ -39,6 +42,7 @@ DemoServerConnection::DemoServerConnection( DemoServer* demoServer,
 	QThread( demoServer ),
 	m_authentication( authentication ),
 	m_demoServer( demoServer ),
+	m_stream( demoServer->primaryStream() ),
 	m_socketDescriptor( socketDescriptor ),
 	m_rfbClientToServerMessageSizes( {
 									 std::pair<int, int>( rfbSetPixelFormat, sz_rfbSetPixelFormatMsg ),
@@ -46,8 +50,11 @@ DemoServerConnection::DemoServerConnection( DemoServer* demoServer,
 									 std::pair<int, int>( rfbKeyEvent, sz_rfbKeyEventMsg ),
 									 std::pair<int, int>( rfbPointerEvent, sz_rfbPointerEventMsg ),
 									 } ),
+	m_framebufferUpdateCursor( m_stream->createFramebufferUpdateCursor() ),
 	m_framebufferUpdateInterval( m_demoServer->configuration().framebufferUpdateInterval() )
 {
+	m_stream->addViewer();
+
 	start();
 }
 
@@ -59,18 +66,41 @@ void DemoServerConnection::run()
 
 	m_socket = new QTcpSocket;
 
-	if( m_socket->setSocketDescriptor( m_socketDescriptor ) == false )
+	if( m_socket->setSocketDescriptor( m_socketDescriptor ) )
+	{
+		serveClient();
+	}
+	else
 	{
 		vCritical() << "failed to set socket descriptor";
-		delete m_socket;
-		m_socket = nullptr;
-		deleteLater();
-		return;
 	}
 
+	delete m_serverProtocol;
+	delete m_socket;
+
+	m_socket = nullptr;
+
+	// balance addViewer() from constructor in any case so the viewer count stays correct
+	m_stream->removeViewer();
+
+	deleteLater();
+}
+
+
+
+void DemoServerConnection::serveClient()
+{
 	connect( m_socket, &QTcpSocket::readyRead, this, &DemoServerConnection::processClient, Qt::DirectConnection );
 	connect( m_socket, &QTcpSocket::disconnected, this, &DemoServerConnection::quit );
 
+	// account for data written from the socket's internal buffer
+	connect( m_socket, &QTcpSocket::bytesWritten, this, [this]( qint64 bytes ) {
+		m_sendStatistics.bytes += bytes;
+		++m_sendStatistics.writeCalls;
+		m_sentBytes.fetchAndAddRelaxed( bytes );
+		m_queuedBytes.storeRelaxed( m_socket->bytesToWrite() );
+	}, Qt::DirectConnection );
+
 	m_serverProtocol = new DemoServerProtocol( m_authentication, m_socket, &m_vncServerClient ),
 
 	m_serverProtocol->setServerInitMessage( m_demoServer->serverInitMessage() );
@@ -78,12 +108,12 @@ void DemoServerConnection::run()
 
 	exec();
 
-	delete m_serverProtocol;
-	delete m_socket;
-
-	m_socket = nullptr;
-
-	deleteLater();
+	if( m_sendStatistics.frames > 0 )
+	{
+		vDebug() << "sent" << m_sendStatistics.frames << "frames,"
+				 << m_sendStatistics.bytes / m_sendStatistics.frames << "bytes per frame,"
+				 << double(m_sendStatistics.writeCalls) / m_sendStatistics.frames << "writes per frame";
+	}
 }
 
 
@@ -142,6 +172,7 @@ bool DemoServerConnection::receiveClientMessage()
 		m_socket->getChar(nullptr);
 		if( featureMessage.isReadyForReceive(m_socket) && featureMessage.receive(m_socket) )
 		{
+			handleFeatureMessage( featureMessage );
 			return true;
 		}
 		m_socket->ungetChar(messageType);
@@ -177,34 +208,157 @@ bool DemoServerConnection::receiveClientMessage()
 
 
 
-void DemoServerConnection::sendFramebufferUpdate()
+void DemoServerConnection::handleFeatureMessage( const FeatureMessage& message )
+{
+	if( message.featureUid() == m_demoServer->featureUid() &&
+		message.command() == DemoFeaturePlugin::SetDemoClientViewportSize )
+	{
+		m_viewportSize = { message.argument( DemoFeaturePlugin::Argument::ViewportWidth ).toInt(),
+						   message.argument( DemoFeaturePlugin::Argument::ViewportHeight ).toInt() };
+
+		switchStream( m_demoServer->selectStream( m_viewportSize, &m_streamSelectionPending ) );
+	}
+}
+
+
+
+void DemoServerConnection::switchStream( DemoServerStream* stream )
 {
-	m_demoServer->lockDataForRead();
+	if( stream == m_stream )
+	{
+		return;
+	}
+
+	const auto framebufferSize = stream->framebufferSize();
+
+	vDebug() << "switching to stream with scale" << stream->scale() << framebufferSize;
+
+	m_stream->removeViewer();
+	stream->addViewer();
+
+	m_stream = stream;
+	m_framebufferUpdateCursor = m_stream->createFramebufferUpdateCursor();
+	m_congested = false;
+
+	// announce new framebuffer size before sending the first key frame of the new stream
+	rfbFramebufferUpdateMsg message;
+	message.type = rfbFramebufferUpdate;
+	message.pad = 0;
+	message.nRects = qToBigEndian<uint16_t>( 1 );
+
+	rfbFramebufferUpdateRectHeader rectHeader;
+	rectHeader.r.x = 0;
+	rectHeader.r.y = 0;
+	rectHeader.r.w = qToBigEndian<uint16_t>( uint16_t(framebufferSize.width()) );
+	rectHeader.r.h = qToBigEndian<uint16_t>( uint16_t(framebufferSize.height()) );
+	rectHeader.encoding = qToBigEndian<uint32_t>( rfbEncodingNewFBSize );
+
+	sendMessages( { QByteArray( reinterpret_cast<const char *>( &message ), sz_rfbFramebufferUpdateMsg ) +
+					QByteArray( reinterpret_cast<const char *>( &rectHeader ), sz_rfbFramebufferUpdateRectHeader ) } );
+}
 
-	const auto& framebufferUpdateMessages = m_demoServer->framebufferUpdateMessages();
 
-	const int framebufferUpdateMessageCount = framebufferUpdateMessages.count();
 
-	if( m_demoServer->keyFrame() != m_keyFrame ||
-			m_framebufferUpdateMessageIndex > framebufferUpdateMessageCount )
+void DemoServerConnection::sendFramebufferUpdate()
+{
+	// a more suitable stream has been requested and may be ready by now
+	if( m_streamSelectionPending )
 	{
-		m_framebufferUpdateMessageIndex = 0;
-		m_keyFrame = m_demoServer->keyFrame();
+		switchStream( m_demoServer->selectStream( m_viewportSize, &m_streamSelectionPending ) );
+	}
+
+	// client can't keep up with the updates? then do not queue further data but skip
+	// all incremental updates and continue with the next key frame once the socket
+	// has been drained so the memory used for slow clients stays bounded
+	if( m_socket->bytesToWrite() > MaximumQueuedBytes )
+	{
+		if( m_congested == false )
+		{
+			vDebug() << "client is too slow - skipping updates until next key frame";
+			m_congested = true;
+			m_stream->requestKeyFrame();
+		}
+
+		m_framebufferUpdateCursor.skipToLatestKeyFrame();
+
+		QTimer::singleShot( m_framebufferUpdateInterval, m_socket, [this]() { sendFramebufferUpdate(); } );
+		return;
 	}
 
-	bool sentUpdates = false;
-	while( m_framebufferUpdateMessageIndex < framebufferUpdateMessageCount )
+	if( m_congested )
 	{
-		m_socket->write( framebufferUpdateMessages[m_framebufferUpdateMessageIndex] );
-		++m_framebufferUpdateMessageIndex;
-		sentUpdates = true;
+		m_congested = false;
+		m_framebufferUpdateCursor.skipToLatestKeyFrame();
 	}
 
-	m_demoServer->unlockData();
+	const auto framebufferUpdateMessages = m_framebufferUpdateCursor.readMessages();
+
+	sendMessages( framebufferUpdateMessages );
 
-	if( sentUpdates == false )
+	if( framebufferUpdateMessages.isEmpty() )
 	{
 		// did not send updates but client still waiting for update? then try again soon
 		QTimer::singleShot( m_framebufferUpdateInterval, m_socket, [this]() { sendFramebufferUpdate(); } );
 	}
 }
+
+
+
+void DemoServerConnection::sendMessages( const QVector<QByteArray>& messages )
+{
+	if( messages.isEmpty() )
+	{
+		return;
+	}
+
+	++m_sendStatistics.frames;
+
+	int index = 0;
+	qint64 offset = 0;
+
+	// write directly from the shared message buffers as long as the socket's internal
+	// write buffer is empty, as otherwise we would mess up the order of data
+	if( m_socket->bytesToWrite() == 0 )
+	{
+		auto& networkFunctions = VeyonCore::platform().networkFunctions();
+		const auto socket = static_cast<PlatformNetworkFunctions::Socket>( m_socket->socketDescriptor() );
+
+		while( index < messages.size() )
+		{
+			auto written = networkFunctions.writeGathered( socket, messages, index, offset );
+			if( written <= 0 )
+			{
+				break;
+			}
+
+			++m_sendStatistics.writeCalls;
+			m_sendStatistics.bytes += written;
+			m_sentBytes.fetchAndAddRelaxed( written );
+
+			while( written > 0 && index < messages.size() )
+			{
+				const auto remaining = messages[index].size() - offset;
+				if( written >= remaining )
+				{
+					written -= remaining;
+					offset = 0;
+					++index;
+				}
+				else
+				{
+					offset += written;
+					written = 0;
+				}
+			}
+		}
+	}
+
+	// let the socket buffer everything the kernel did not accept yet
+	for( ; index < messages.size(); ++index )
+	{
+		m_socket->write( messages[index].constData() + offset, messages[index].size() - offset );
+		offset = 0;
+	}
+
+	m_queuedBytes.storeRelaxed( m_socket->bytesToWrite() );
+}
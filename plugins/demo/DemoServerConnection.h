@@ -24,9 +24,15 @@
 
 #pragma once
 
+#include <QAtomicInteger>
+#include <QSize>
+
 #include "DemoServerProtocol.h"
+#include "DemoServerUpdateLog.h"
 
 class DemoServer;
+class DemoServerStream;
+class FeatureMessage;
 
 // clazy:excludeall=ctor-missing-parent-argument
 
@@ -38,20 +44,39 @@ class DemoServerConnection : public QThread
 	Q_OBJECT
 public:
 	static constexpr int ProtocolRetryTime = 250;
+	static constexpr qint64 MaximumQueuedBytes = 4*1024*1024;
 
 	DemoServerConnection( DemoServer* demoServer, const DemoAuthentication& authentication, quintptr socketDescriptor );
 	~DemoServerConnection() = default;
 
+	// may be called from any thread
+	qint64 takeSentBytes()
+	{
+		return m_sentBytes.fetchAndStoreRelaxed( 0 );
+	}
+
+	qint64 queuedBytes() const
+	{
+		return m_queuedBytes.loadRelaxed();
+	}
+
 private:
 	void run() override;
+	void serveClient();
 
 	void processClient(); // clazy:exclude=thread-with-slots
 	void sendFramebufferUpdate();
+	void sendMessages( const QVector<QByteArray>& messages );
 
 	bool receiveClientMessage();
+	void handleFeatureMessage( const FeatureMessage& message );
+	void switchStream( DemoServerStream* stream );
 
 	const DemoAuthentication& m_authentication;
 	DemoServer* m_demoServer;
+	DemoServerStream* m_stream;
+	QSize m_viewportSize{};
+	bool m_streamSelectionPending{false};
 
 	quintptr m_socketDescriptor;
 	QTcpSocket* m_socket{nullptr};
@@ -61,8 +86,19 @@ private:
 
 	const QMap<int, int> m_rfbClientToServerMessageSizes;
 
-	int m_keyFrame{-1};
-	int m_framebufferUpdateMessageIndex{0};
+	DemoServerUpdateLog::Cursor m_framebufferUpdateCursor;
+	bool m_congested{false};
+
+	// send statistics for measuring efficiency of batched writes
+	struct {
+		qint64 frames{0};
+		qint64 bytes{0};
+		qint64 writeCalls{0};
+	} m_sendStatistics;
+
+	// shared with the demo server's quality controller
+	QAtomicInteger<qint64> m_sentBytes{0};
+	QAtomicInteger<qint64> m_queuedBytes{0};
 
 	const int m_framebufferUpdateInterval;
 
@@ -0,0 +1,322 @@
+/*
+ * DemoServerStream.cpp - implementation of DemoServerStream class
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "rfb/rfbproto.h"
+
+#include <QTcpSocket>
+
+#include "DemoServerStream.h"
+#include "Tracer.h"
+#include "VncClientProtocol.h"
+
+
+DemoServerStream::DemoServerStream( int vncServerPort, const Password& vncServerPassword, int scale,
+									qint64 memoryLimit, int keyFrameInterval, QObject* parent ) :
+	QObject( parent ),
+	m_scale( scale ),
+	m_memoryLimit( memoryLimit ),
+	m_keyFrameInterval( keyFrameInterval ),
+	m_vncServerPort( vncServerPort ),
+	m_vncServerSocket( new QTcpSocket( this ) ),
+	m_vncClientProtocol( new VncClientProtocol( m_vncServerSocket, vncServerPassword ) )
+{
+	connect( m_vncServerSocket, &QTcpSocket::readyRead, this, &DemoServerStream::readFromVncServer );
+	connect( m_vncServerSocket, &QTcpSocket::disconnected, this, [this]() {
+		if( m_scale > 1 && m_ready == false )
+		{
+			vWarning() << "VNC server closed connection before providing scaled framebuffer - disabling stream at scale" << m_scale;
+			stop();
+		}
+		else
+		{
+			reconnectToVncServer();
+		}
+	} );
+
+	reconnectToVncServer();
+}
+
+
+
+DemoServerStream::~DemoServerStream()
+{
+	delete m_vncClientProtocol;
+	delete m_vncServerSocket;
+}
+
+
+
+void DemoServerStream::stop()
+{
+	m_vncServerSocket->disconnect( this );
+	m_vncServerSocket->close();
+
+	m_ready = false;
+	m_stopped = true;
+}
+
+
+
+QByteArray DemoServerStream::serverInitMessage() const
+{
+	QMutexLocker locker( &m_serverInitMessageMutex );
+	return m_serverInitMessage;
+}
+
+
+
+QSize DemoServerStream::framebufferSize() const
+{
+	QMutexLocker locker( &m_serverInitMessageMutex );
+
+	if( m_serverInitMessage.size() < sz_rfbServerInitMsg )
+	{
+		return {};
+	}
+
+	const auto message = reinterpret_cast<const rfbServerInitMsg *>( m_serverInitMessage.constData() );
+
+	return { qFromBigEndian( message->framebufferWidth ), qFromBigEndian( message->framebufferHeight ) };
+}
+
+
+
+void DemoServerStream::requestFramebufferUpdate()
+{
+	if( m_vncClientProtocol->state() != VncClientProtocol::State::Running )
+	{
+		return;
+	}
+
+	// do not let the VNC server encode scaled updates nobody is going to receive
+	if( m_ready && m_scale > 1 && m_viewerCount.loadAcquire() == 0 )
+	{
+		return;
+	}
+
+	if( m_requestFullFramebufferUpdate ||
+		m_lastFullFramebufferUpdate.elapsed() >= m_keyFrameInterval )
+	{
+		vDebug() << "Requesting full framebuffer update at scale" << m_scale;
+		m_vncClientProtocol->requestFramebufferUpdate( false );
+		m_lastFullFramebufferUpdate.restart();
+		m_requestFullFramebufferUpdate = false;
+	}
+	else
+	{
+		m_vncClientProtocol->requestFramebufferUpdate( true );
+	}
+}
+
+
+
+bool DemoServerStream::setEncodings( const DemoQualityController::Decision& decision )
+{
+	m_encodingDecision = decision;
+
+	if( m_vncClientProtocol->state() != VncClientProtocol::State::Running )
+	{
+		// will be applied in start()
+		return true;
+	}
+
+	return m_vncClientProtocol->
+			setEncodings( {
+							  rfbEncodingTight,
+							  rfbEncodingZYWRLE,
+							  rfbEncodingZRLE,
+							  rfbEncodingUltra,
+							  rfbEncodingCopyRect,
+							  rfbEncodingHextile,
+							  rfbEncodingCoRRE,
+							  rfbEncodingRRE,
+							  rfbEncodingRaw,
+							  rfbEncodingCompressLevel0 + uint32_t(decision.compressionLevel),
+							  rfbEncodingQualityLevel0 + uint32_t(decision.quality),
+							  rfbEncodingNewFBSize,
+							  rfbEncodingLastRect
+						  } );
+}
+
+
+
+void DemoServerStream::reconnectToVncServer()
+{
+	m_ready = false;
+
+	m_vncClientProtocol->start();
+
+	m_vncServerSocket->connectToHost( QHostAddress::LocalHost, static_cast<quint16>( m_vncServerPort ) );
+}
+
+
+
+void DemoServerStream::readFromVncServer()
+{
+	if( m_vncClientProtocol->state() != VncClientProtocol::State::Running )
+	{
+		while( m_vncClientProtocol->read() )
+		{
+		}
+
+		if( m_vncClientProtocol->state() == VncClientProtocol::State::Running )
+		{
+			start();
+		}
+	}
+	else
+	{
+		while( receiveVncServerMessage() )
+		{
+		}
+	}
+}
+
+
+
+bool DemoServerStream::receiveVncServerMessage()
+{
+	if( m_vncClientProtocol->receiveMessage() )
+	{
+		if( m_vncClientProtocol->lastMessageType() == rfbFramebufferUpdate )
+		{
+			enqueueFramebufferUpdateMessage( m_vncClientProtocol->lastMessage() );
+		}
+		else
+		{
+			vWarning() << "skipping server message of type" << static_cast<int>( m_vncClientProtocol->lastMessageType() );
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+
+
+void DemoServerStream::enqueueFramebufferUpdateMessage( const QByteArray& message )
+{
+	const auto lastUpdatedRect = m_vncClientProtocol->lastUpdatedRect();
+	const auto framebufferWidth = m_vncClientProtocol->framebufferWidth();
+	const auto framebufferHeight = m_vncClientProtocol->framebufferHeight();
+
+	const bool isFullUpdate = ( lastUpdatedRect.x() == 0 && lastUpdatedRect.y() == 0 &&
+								lastUpdatedRect.width() == framebufferWidth &&
+								lastUpdatedRect.height() == framebufferHeight );
+
+	const auto queueSize = m_framebufferUpdates.epochSize();
+	const auto isKeyFrame = isFullUpdate || queueSize > m_memoryLimit*2;
+
+	Tracer::Scope traceScope( Tracer::Event::DemoServerEnqueueFramebufferUpdate, message.size(), isKeyFrame, queueSize );
+
+	if( isKeyFrame )
+	{
+		vDebug() << "scale:" << m_scale
+				 << "message count:" << m_framebufferUpdates.epochMessageCount()
+				 << "queue size (KB):" << queueSize / 1024;
+
+		auto serverInitMessage = m_vncClientProtocol->serverInitMessage();
+		auto serverInit = reinterpret_cast<rfbServerInitMsg *>( serverInitMessage.data() );
+
+		if( m_scale > 1 && m_ready == false &&
+			qFromBigEndian( serverInit->framebufferWidth ) == framebufferWidth &&
+			qFromBigEndian( serverInit->framebufferHeight ) == framebufferHeight )
+		{
+			vWarning() << "VNC server does not support scaling - disabling stream at scale" << m_scale;
+			stop();
+			return;
+		}
+
+		// announce current (scaled) framebuffer size to new connections
+		serverInit->framebufferWidth = qToBigEndian<uint16_t>( uint16_t(framebufferWidth) );
+		serverInit->framebufferHeight = qToBigEndian<uint16_t>( uint16_t(framebufferHeight) );
+
+		m_serverInitMessageMutex.lock();
+		m_serverInitMessage = serverInitMessage;
+		m_serverInitMessageMutex.unlock();
+	}
+
+	// publish message to all connections - starting a new epoch with a key frame
+	// makes connections skip all previous messages
+	m_framebufferUpdates.append( message, isKeyFrame );
+
+	if( isKeyFrame && m_ready == false )
+	{
+		m_ready = true;
+		Q_EMIT started();
+	}
+
+	// we're about to reach memory limits?
+	if( m_framebufferUpdates.epochSize() > m_memoryLimit )
+	{
+		// then request a full update so we can clear our queue
+		m_requestFullFramebufferUpdate = true;
+	}
+}
+
+
+
+void DemoServerStream::start()
+{
+	vDebug() << m_scale;
+
+	setVncServerPixelFormat();
+	setEncodings( m_encodingDecision );
+
+	if( m_scale > 1 )
+	{
+		m_vncClientProtocol->setScale( m_scale );
+	}
+
+	m_requestFullFramebufferUpdate = true;
+
+	requestFramebufferUpdate();
+
+	while( receiveVncServerMessage() )
+	{
+	}
+}
+
+
+
+bool DemoServerStream::setVncServerPixelFormat()
+{
+	rfbPixelFormat format;
+
+	format.bitsPerPixel = 32;
+	format.depth = 24;
+	format.bigEndian = qFromBigEndian<uint16_t>( 1 ) == 1 ? true : false;
+	format.trueColour = 1;
+	format.redShift = 16;
+	format.greenShift = 8;
+	format.blueShift = 0;
+	format.redMax = 0xff;
+	format.greenMax = 0xff;
+	format.blueMax = 0xff;
+	format.pad1 = 0;
+	format.pad2 = 0;
+
+	return m_vncClientProtocol->setPixelFormat( format );
+}
@@ -0,0 +1,132 @@
+/*
+ * DemoServerStream.h - header file for DemoServerStream class
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QObject>
+#include <QSize>
+
+#include "CryptoCore.h"
+#include "DemoQualityController.h"
+#include "DemoServerUpdateLog.h"
+
+class QTcpSocket;
+class VncClientProtocol;
+
+// connection to the local VNC server providing framebuffer updates at a
+// certain scale which are published to all demo server connections using it
+class DemoServerStream : public QObject
+{
+	Q_OBJECT
+public:
+	using Password = CryptoCore::PlaintextPassword;
+
+	DemoServerStream( int vncServerPort, const Password& vncServerPassword, int scale,
+					  qint64 memoryLimit, int keyFrameInterval, QObject* parent );
+	~DemoServerStream() override;
+
+	void stop();
+
+	int scale() const
+	{
+		return m_scale;
+	}
+
+	// returns whether the stream provides framebuffer updates at its scale
+	bool isReady() const
+	{
+		return m_ready;
+	}
+
+	bool isStopped() const
+	{
+		return m_stopped;
+	}
+
+	// may be called from any thread
+	QByteArray serverInitMessage() const;
+	QSize framebufferSize() const;
+
+	DemoServerUpdateLog::Cursor createFramebufferUpdateCursor() const
+	{
+		return m_framebufferUpdates.createCursor();
+	}
+
+	void requestKeyFrame()
+	{
+		m_requestFullFramebufferUpdate = true;
+	}
+
+	void addViewer()
+	{
+		m_viewerCount.ref();
+	}
+
+	void removeViewer()
+	{
+		m_viewerCount.deref();
+	}
+
+	void requestFramebufferUpdate();
+	bool setEncodings( const DemoQualityController::Decision& decision );
+
+Q_SIGNALS:
+	void started();
+
+private:
+	void reconnectToVncServer();
+	void readFromVncServer();
+
+	bool receiveVncServerMessage();
+	void enqueueFramebufferUpdateMessage( const QByteArray& message );
+
+	void start();
+	bool setVncServerPixelFormat();
+
+	const int m_scale;
+	const qint64 m_memoryLimit;
+	const int m_keyFrameInterval;
+	const int m_vncServerPort;
+
+	QTcpSocket* m_vncServerSocket;
+	VncClientProtocol* m_vncClientProtocol;
+
+	DemoQualityController::Decision m_encodingDecision{};
+
+	QElapsedTimer m_lastFullFramebufferUpdate{};
+	std::atomic<bool> m_requestFullFramebufferUpdate{false};
+	std::atomic<bool> m_ready{false};
+	std::atomic<bool> m_stopped{false};
+	QAtomicInt m_viewerCount{0};
+
+	mutable QMutex m_serverInitMessageMutex;
+	QByteArray m_serverInitMessage;
+
+	DemoServerUpdateLog m_framebufferUpdates{};
+
+} ;
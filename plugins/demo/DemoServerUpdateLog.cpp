@@ -0,0 +1,146 @@
+/*
+ * DemoServerUpdateLog.cpp - implementation of DemoServerUpdateLog class
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "DemoServerUpdateLog.h"
+
+
+DemoServerUpdateLog::Segment::~Segment()
+{
+	// release successors iteratively instead of recursively through their
+	// destructors to not exhaust the stack with long chains
+	auto segment = m_next.fetchAndStoreRelaxed( nullptr );
+	while( segment && segment->ref.deref() == false )
+	{
+		auto next = segment->m_next.fetchAndStoreRelaxed( nullptr );
+		delete segment;
+		segment = next;
+	}
+}
+
+
+
+QVector<QByteArray> DemoServerUpdateLog::Cursor::readMessages()
+{
+	QVector<QByteArray> messages;
+
+	if( m_position.data() == nullptr )
+	{
+		return messages;
+	}
+
+	// walking along the chain is safe as our current position holds a
+	// reference to all following segments
+	auto segment = m_position.data();
+	while( auto next = segment->next() )
+	{
+		if( next->isKeyFrame() )
+		{
+			messages.clear();
+		}
+		messages.append( next->message() );
+		segment = next;
+	}
+
+	if( segment != m_position.data() )
+	{
+		m_position = SegmentPointer( segment );
+	}
+
+	return messages;
+}
+
+
+
+bool DemoServerUpdateLog::Cursor::skipToLatestKeyFrame()
+{
+	if( m_position.data() == nullptr )
+	{
+		return false;
+	}
+
+	Segment* anchor = nullptr;
+
+	auto segment = m_position.data();
+	while( auto next = segment->next() )
+	{
+		if( next->isKeyFrame() )
+		{
+			anchor = segment;
+		}
+		segment = next;
+	}
+
+	if( anchor && anchor != m_position.data() )
+	{
+		m_position = SegmentPointer( anchor );
+		return true;
+	}
+
+	return false;
+}
+
+
+
+DemoServerUpdateLog::DemoServerUpdateLog() :
+	m_tail( new Segment ),
+	m_keyFrameAnchor( m_tail )
+{
+}
+
+
+
+DemoServerUpdateLog::Cursor DemoServerUpdateLog::createCursor() const
+{
+	QMutexLocker locker( &m_keyFrameAnchorMutex );
+
+	return Cursor( m_keyFrameAnchor );
+}
+
+
+
+void DemoServerUpdateLog::append( const QByteArray& message, bool isKeyFrame )
+{
+	if( isKeyFrame )
+	{
+		++m_epoch;
+		m_epochMessageCount = 0;
+		m_epochSize = 0;
+
+		// new readers start right after the current tail
+		QMutexLocker locker( &m_keyFrameAnchorMutex );
+		m_keyFrameAnchor = m_tail;
+	}
+
+	auto segment = new Segment( message, m_epoch, isKeyFrame );
+
+	// reference held by predecessor
+	segment->ref.ref();
+
+	// publish segment to readers
+	m_tail->m_next.storeRelease( segment );
+	m_tail = SegmentPointer( segment );
+
+	++m_epochMessageCount;
+	m_epochSize += message.size();
+}
@@ -0,0 +1,151 @@
+/*
+ * DemoServerUpdateLog.h - header file for DemoServerUpdateLog class
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QAtomicPointer>
+#include <QByteArray>
+#include <QExplicitlySharedDataPointer>
+#include <QMutex>
+#include <QSharedData>
+#include <QVector>
+
+// append-only log of framebuffer update messages which is written by the
+// thread receiving data from the VNC server and read by all connection threads
+// without any locks
+//
+// Messages are stored in a chain of reference-counted segments. Each segment
+// holds a reference to its successor, so a reader holding its current position
+// keeps all following segments alive while segments no reader refers to any
+// longer are released automatically. Each key frame starts a new epoch which
+// makes readers skip all older segments.
+class DemoServerUpdateLog
+{
+public:
+	class Segment : public QSharedData
+	{
+	public:
+		Segment() = default;
+		Segment( const QByteArray& message, int epoch, bool isKeyFrame ) :
+			m_message( message ),
+			m_epoch( epoch ),
+			m_isKeyFrame( isKeyFrame )
+		{
+		}
+
+		~Segment();
+
+		Q_DISABLE_COPY(Segment)
+
+		const QByteArray& message() const
+		{
+			return m_message;
+		}
+
+		int epoch() const
+		{
+			return m_epoch;
+		}
+
+		bool isKeyFrame() const
+		{
+			return m_isKeyFrame;
+		}
+
+		Segment* next() const
+		{
+			return m_next.loadAcquire();
+		}
+
+	private:
+		friend class DemoServerUpdateLog;
+
+		const QByteArray m_message{};
+		const int m_epoch{0};
+		const bool m_isKeyFrame{false};
+		QAtomicPointer<Segment> m_next{nullptr};
+
+	};
+
+	using SegmentPointer = QExplicitlySharedDataPointer<Segment>;
+
+	// read position of a single reader, must only be used by one thread at a time
+	class Cursor
+	{
+	public:
+		Cursor() = default;
+		explicit Cursor( const SegmentPointer& position ) :
+			m_position( position )
+		{
+		}
+
+		// collect all messages published since the last call, starting at the
+		// latest key frame if a new epoch has been started in the meantime
+		QVector<QByteArray> readMessages();
+
+		// move to the latest key frame without collecting the messages in between
+		// so the segments skipped can be released, returns true if moved
+		bool skipToLatestKeyFrame();
+
+	private:
+		SegmentPointer m_position;
+
+	};
+
+	DemoServerUpdateLog();
+
+	// writer interface - must be called from a single thread only
+	void append( const QByteArray& message, bool isKeyFrame );
+
+	// returns a cursor for a new reader which starts reading at the latest key frame,
+	// may be called from any thread
+	Cursor createCursor() const;
+
+	int epoch() const
+	{
+		return m_epoch;
+	}
+
+	int epochMessageCount() const
+	{
+		return m_epochMessageCount;
+	}
+
+	qint64 epochSize() const
+	{
+		return m_epochSize;
+	}
+
+private:
+	SegmentPointer m_tail;
+
+	// only accessed when creating cursors or at key frames
+	mutable QMutex m_keyFrameAnchorMutex;
+	SegmentPointer m_keyFrameAnchor;
+
+	int m_epoch{0};
+	int m_epochMessageCount{0};
+	qint64 m_epochSize{0};
+
+} ;
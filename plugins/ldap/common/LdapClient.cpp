@@ -8,6 +8,7 @@
 #include <ldap.h>
 
 #include "ldapconnection.h"
+#include "ldapcontrol.h"
 #include "ldapoperation.h"
 #include "ldapserver.h"
 
@@ -32,7 +33,8 @@ LdapClient::LdapClient( const LdapConfiguration& configuration, const QUrl& url,
 	m_server( new KLDAPCore::LdapServer ),
 	m_connection( new KLDAPCore::LdapConnection ),
 	m_operation( new KLDAPCore::LdapOperation ),
-	m_queryTimeout(m_configuration.queryTimeout())
+	m_queryTimeout(m_configuration.queryTimeout()),
+	m_queryPageSize(m_configuration.queryPageSize())
 {
 	connectAndBind( url );
 }
@@ -75,95 +77,101 @@ QString LdapClient::errorDescription() const
 
 LdapClient::Objects LdapClient::queryObjects( const QString& dn, const QStringList& attributes,
 											  const QString& filter, LdapClient::Scope scope )
+{
+	Objects entries;
+
+	queryObjects( dn, attributes, filter, scope,
+				  [&entries]( const QString& objectDn, const Object& object ) {
+					  entries[objectDn] = object;
+				  } );
+
+	vDebug() << "results:" << entries;
+
+	return entries;
+}
+
+
+
+bool LdapClient::queryObjects( const QString& dn, const QStringList& attributes, const QString& filter,
+							   Scope scope, const ObjectHandler& handler, const PageHandler& pageHandler )
 {
 	vDebug() << "called with" << dn << attributes << filter << scope;
 
 	if( m_state != Bound && reconnect() == false )
 	{
 		vCritical() << "not bound to server!";
-		return {};
+		return false;
 	}
 
 	if( dn.isEmpty() )
 	{
 		vCritical() << "DN is empty!";
-		return {};
+		return false;
 	}
 
 	if( attributes.isEmpty() )
 	{
 		vCritical() << "attributes empty!";
-		return {};
+		return false;
 	}
 
-	Objects entries;
-
-	int result = -1;
-	auto id = m_operation->search(KLDAPCore::LdapDN(dn), kldapUrlScope(scope), filter, attributes);
-
-	if( id != -1 )
+	auto realAttributeNames = attributes;
+	for( auto& attribute : realAttributeNames )
 	{
-		auto realAttributeNames = attributes;
-		for( auto& attribute : realAttributeNames )
-		{
-			attribute = attribute.toLower();
-		}
+		attribute = attribute.toLower();
+	}
 
-		auto isFirstResult = true;
+	auto isFirstResult = true;
+	auto handledObjects = false;
 
-		while ((result = m_operation->waitForResult(id, m_queryTimeout)) == KLDAPCore::LdapOperation::RES_SEARCH_ENTRY)
+	const auto success = search( dn, attributes, filter, scope, [&]() {
+		if( isFirstResult )
 		{
-			if( isFirstResult )
-			{
-				isFirstResult = false;
+			isFirstResult = false;
 
-				// match attribute name from result with requested attribute name in order
-				// to keep result aggregation below case-insensitive
-				const auto attributes = m_operation->object().attributes();
-				for( auto it = attributes.constBegin(), end = attributes.constEnd(); it != end; ++it )
+			// match attribute name from result with requested attribute name in order
+			// to keep result aggregation below case-insensitive
+			const auto resultAttributes = m_operation->object().attributes();
+			for( auto it = resultAttributes.constBegin(), end = resultAttributes.constEnd(); it != end; ++it )
+			{
+				for( auto& attribute : realAttributeNames )
 				{
-					for( auto& attribute : realAttributeNames )
+					if( QString::compare( it.key().toLower(), attribute, Qt::CaseInsensitive ) == 0 )
 					{
-						if( QString::compare( it.key().toLower(), attribute, Qt::CaseInsensitive ) == 0 )
-						{
-							attribute = it.key();
-							break;
-						}
+						attribute = it.key();
+						break;
 					}
 				}
 			}
+		}
 
-			// convert result list from type QList<QByteArray> to QStringList
-			const auto dn = m_operation->object().dn().toString();
-			for( const auto& attribute : realAttributeNames )
+		// convert result list from type QList<QByteArray> to QStringList
+		Object object;
+		for( const auto& attribute : realAttributeNames )
+		{
+			const auto values = m_operation->object().values( attribute );
+			for( const auto& value : values )
 			{
-				const auto values = m_operation->object().values( attribute );
-				for( const auto& value : values )
-				{
-					entries[dn][attribute] += QString::fromUtf8( value );
-				}
+				object[attribute] += QString::fromUtf8( value );
 			}
 		}
 
-		vDebug() << "results:" << entries;
-	}
+		handledObjects = true;
+		handler( m_operation->object().dn().toString(), object );
+	}, pageHandler );
 
-	if( result == -1 )
+	// retrying after objects have been passed to the handler already would report them twice
+	if( success == false && handledObjects == false && m_state == Bound && m_queryRetry == false )
 	{
-		vWarning() << "LDAP search failed with code" << m_connection->ldapErrorCode();
-
-		if( m_state == Bound && m_queryRetry == false )
-		{
-			// close connection and try again
-			m_queryRetry = true;
-			m_state = Disconnected;
-			entries = queryObjects( dn, attributes, filter, scope );
-			m_queryRetry = false;
-		}
+		// close connection and try again
+		m_queryRetry = true;
+		m_state = Disconnected;
+		const auto retrySuccess = queryObjects( dn, attributes, filter, scope, handler, pageHandler );
+		m_queryRetry = false;
+		return retrySuccess;
 	}
 
-	return entries;
-
+	return success;
 }
 
 
@@ -194,56 +202,44 @@ QStringList LdapClient::queryAttributeValues( const QString& dn, const QString&
 
 	QStringList entries;
 
-	int result = -1;
-	int id = m_operation->search(KLDAPCore::LdapDN(dn), kldapUrlScope(scope), filter, QStringList(attribute));
+	bool isFirstResult = true;
+	QString realAttributeName = attribute.toLower();
 
-	if( id != -1 )
-	{
-		bool isFirstResult = true;
-		QString realAttributeName = attribute.toLower();
-
-		while ((result = m_operation->waitForResult(id, m_queryTimeout)) == KLDAPCore::LdapOperation::RES_SEARCH_ENTRY)
+	const auto success = search( dn, QStringList(attribute), filter, scope, [&]() {
+		if( isFirstResult )
 		{
-			if( isFirstResult )
-			{
-				isFirstResult = false;
+			isFirstResult = false;
 
-				// match attribute name from result with requested attribute name in order
-				// to keep result aggregation below case-insensitive
-				const auto attributes = m_operation->object().attributes();
-				for( auto it = attributes.constBegin(), end = attributes.constEnd(); it != end; ++it )
+			// match attribute name from result with requested attribute name in order
+			// to keep result aggregation below case-insensitive
+			const auto attributes = m_operation->object().attributes();
+			for( auto it = attributes.constBegin(), end = attributes.constEnd(); it != end; ++it )
+			{
+				if( it.key().toLower() == realAttributeName )
 				{
-					if( it.key().toLower() == realAttributeName )
-					{
-						realAttributeName = it.key();
-						break;
-					}
+					realAttributeName = it.key();
+					break;
 				}
 			}
+		}
 
-			// convert result list from type QList<QByteArray> to QStringList
-			const auto values = m_operation->object().values( realAttributeName );
-			for( const auto& value : values )
-			{
-				entries += QString::fromUtf8( value );
-			}
+		// convert result list from type QList<QByteArray> to QStringList
+		const auto values = m_operation->object().values( realAttributeName );
+		for( const auto& value : values )
+		{
+			entries += QString::fromUtf8( value );
 		}
+	} );
 
-		vDebug() << "results:" << entries;
-	}
+	vDebug() << "results:" << entries;
 
-	if( result == -1 )
+	if( success == false && m_state == Bound && m_queryRetry == false )
 	{
-		vWarning() << "LDAP search failed with code" << m_connection->ldapErrorCode();
-
-		if( m_state == Bound && m_queryRetry == false )
-		{
-			// close connection and try again
-			m_queryRetry = true;
-			m_state = Disconnected;
-			entries = queryAttributeValues( dn, attribute, filter, scope );
-			m_queryRetry = false;
-		}
+		// close connection and try again
+		m_queryRetry = true;
+		m_state = Disconnected;
+		entries = queryAttributeValues( dn, attribute, filter, scope );
+		m_queryRetry = false;
 	}
 
 	return entries;
@@ -269,30 +265,19 @@ QStringList LdapClient::queryDistinguishedNames( const QString& dn, const QStrin
 
 	QStringList distinguishedNames;
 
-	int result = -1;
-	int id = m_operation->search( KLDAPCore::LdapDN(dn), kldapUrlScope(scope), filter, QStringList() );
+	const auto success = search( dn, {}, filter, scope, [&]() {
+		distinguishedNames += m_operation->object().dn().toString();
+	} );
 
-	if( id != -1 )
-	{
-		while ((result = m_operation->waitForResult(id, m_queryTimeout)) == KLDAPCore::LdapOperation::RES_SEARCH_ENTRY)
-		{
-			distinguishedNames += m_operation->object().dn().toString();
-		}
-		vDebug() << "results" << distinguishedNames;
-	}
+	vDebug() << "results" << distinguishedNames;
 
-	if( result == -1 )
+	if( success == false && m_state == Bound && m_queryRetry == false )
 	{
-		vWarning() << "LDAP search failed with code" << m_connection->ldapErrorCode();
-
-		if( m_state == Bound && m_queryRetry == false )
-		{
-			// close connection and try again
-			m_queryRetry = true;
-			m_state = Disconnected;
-			distinguishedNames = queryDistinguishedNames( dn, filter, scope );
-			m_queryRetry = false;
-		}
+		// close connection and try again
+		m_queryRetry = true;
+		m_state = Disconnected;
+		distinguishedNames = queryDistinguishedNames( dn, filter, scope );
+		m_queryRetry = false;
 	}
 
 	return distinguishedNames;
@@ -517,6 +502,69 @@ void LdapClient::initTLS()
 
 
 
+bool LdapClient::search( const QString& dn, const QStringList& attributes, const QString& filter, Scope scope,
+						 const std::function<void ()>& handleEntry, const PageHandler& handlePage )
+{
+	QByteArray cookie;
+	int result = -1;
+
+	// request results in pages (RFC 2696) so large directories do not exceed server-side size limits
+	do
+	{
+		if( m_queryPageSize > 0 )
+		{
+			m_operation->setServerControls( { KLDAPCore::LdapControl::createPageControl( m_queryPageSize, cookie ) } );
+		}
+
+		const auto id = m_operation->search( KLDAPCore::LdapDN(dn), kldapUrlScope(scope), filter, attributes );
+		if( id == -1 )
+		{
+			result = -1;
+			break;
+		}
+
+		while( ( result = m_operation->waitForResult( id, m_queryTimeout ) ) == KLDAPCore::LdapOperation::RES_SEARCH_ENTRY )
+		{
+			handleEntry();
+		}
+
+		cookie.clear();
+
+		// let the caller process each page as it arrives and stop fetching further pages on request
+		if( result != -1 && handlePage && handlePage() == false )
+		{
+			break;
+		}
+
+		if( result == KLDAPCore::LdapOperation::RES_SEARCH_RESULT && m_queryPageSize > 0 )
+		{
+			// servers not supporting paged results ignore the (non-critical) control and return all
+			// entries at once without a page control in the response
+			const auto controls = m_operation->controls();
+			for( const auto& control : controls )
+			{
+				if( control.parsePageControl( cookie ) >= 0 )
+				{
+					break;
+				}
+			}
+		}
+	}
+	while( cookie.isEmpty() == false );
+
+	m_operation->setServerControls( {} );
+
+	if( result == -1 )
+	{
+		vWarning() << "LDAP search failed with code" << m_connection->ldapErrorCode();
+		return false;
+	}
+
+	return true;
+}
+
+
+
 bool LdapClient::reconnect()
 {
 	m_connection->close();
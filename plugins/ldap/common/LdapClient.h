@@ -55,7 +55,10 @@ public:
 	};
 	Q_ENUM(TLSVerifyMode)
 
-	using Objects = QMap<QString, QMap<QString, QStringList> >;
+	using Object = QMap<QString, QStringList>;
+	using Objects = QMap<QString, Object>;
+	using ObjectHandler = std::function<void (const QString& dn, const Object& object)>;
+	using PageHandler = std::function<bool ()>;
 
 	explicit LdapClient( const LdapConfiguration& configuration, const QUrl& url = QUrl(), QObject* parent = nullptr );
 	~LdapClient() override;
@@ -79,6 +82,8 @@ public:
 	QString errorDescription() const;
 
 	Objects queryObjects( const QString& dn, const QStringList& attributes, const QString& filter, Scope scope );
+	bool queryObjects( const QString& dn, const QStringList& attributes, const QString& filter, Scope scope,
+					   const ObjectHandler& handler, const PageHandler& pageHandler = {} );
 
 	QStringList queryAttributeValues( const QString &dn, const QString &attribute,
 									  const QString& filter = QStringLiteral( "(objectclass=*)" ),
@@ -116,10 +121,14 @@ public:
 	}
 
 	static constexpr int DefaultQueryTimeout = 3000;
+	static constexpr int DefaultQueryPageSize = 1000;
 
 private:
 	static constexpr auto LdapLibraryDebugAny = -1;
 
+	bool search( const QString& dn, const QStringList& attributes, const QString& filter, Scope scope,
+				 const std::function<void ()>& handleEntry, const PageHandler& handlePage = {} );
+
 	bool reconnect();
 	bool connectAndBind( const QUrl& url );
 	void initTLS();
@@ -145,5 +154,6 @@ private:
 	QString m_namingContextAttribute;
 
 	const int m_queryTimeout{DefaultQueryTimeout};
+	const int m_queryPageSize{DefaultQueryPageSize};
 
 };
@@ -204,6 +204,23 @@ QStringList LdapDirectory::computersByHostName( const QString& filterValue )
 
 
 
+/*!
+ * \brief Queries the given attributes of all computer objects
+ * \param attributes The attributes to fetch for each computer object
+ * \param handler Function called with DN and attributes of each computer object as it arrives
+ * \param pageHandler Optional function called after each page of results, returning false aborts the query
+ * \return Whether the query succeeded
+ */
+bool LdapDirectory::computerObjects( const QStringList& attributes, const LdapClient::ObjectHandler& handler,
+									 const LdapClient::PageHandler& pageHandler )
+{
+	return m_client.queryObjects( computersDn(), attributes,
+								  LdapClient::constructQueryFilter( {}, {}, m_computersFilter ),
+								  computerSearchScope(), handler, pageHandler );
+}
+
+
+
 QStringList LdapDirectory::computerGroups( const QString& filterValue )
 {
 	return m_client.queryDistinguishedNames( computerGroupsDn(),
@@ -425,6 +442,33 @@ QStringList LdapDirectory::computerLocationEntries( const QString& locationName
 
 
 
+/*!
+ * \brief Queries all containers used as computer locations
+ * \return Location names keyed by the lower-case DN of the corresponding container
+ */
+QHash<QString, QString> LdapDirectory::computerLocationContainers()
+{
+	QHash<QString, QString> containers;
+
+	if( m_computerLocationsByContainer )
+	{
+		m_client.queryObjects( computersDn(), { m_locationNameAttribute },
+							   LdapClient::constructQueryFilter( m_locationNameAttribute, {}, m_computerContainersFilter ),
+							   m_defaultSearchScope,
+							   [&containers]( const QString& dn, const LdapClient::Object& container ) {
+								   const auto name = container.isEmpty() ? QString{} : container.first().value( 0 );
+								   if( name.isEmpty() == false )
+								   {
+									   containers[dn.toLower()] = name;
+								   }
+							   } );
+	}
+
+	return containers;
+}
+
+
+
 QString LdapDirectory::hostToLdapFormat( const QString& host )
 {
 	if( m_computerHostNameAsFQDN )
@@ -43,6 +43,8 @@ public:
 	QStringList userGroups( const QString& filterValue = {} );
 	QStringList computersByDisplayName( const QString& filterValue = {} );
 	QStringList computersByHostName( const QString& filterValue = {} );
+	bool computerObjects( const QStringList& attributes, const LdapClient::ObjectHandler& handler,
+						  const LdapClient::PageHandler& pageHandler = {} );
 	QStringList computerGroups( const QString& filterValue = {} );
 	QStringList computerLocations( const QString& filterValue = {} );
 
@@ -58,6 +60,7 @@ public:
 	QString groupMemberComputerIdentification( const QString& computerDn );
 
 	QStringList computerLocationEntries( const QString& locationName );
+	QHash<QString, QString> computerLocationContainers();
 
 	QString hostToLdapFormat( const QString& host );
 	QString computerObjectFromHost( const QString& host );
@@ -97,6 +100,16 @@ public:
 		return m_computerLocationsByContainer;
 	}
 
+	bool computerLocationsByAttribute() const
+	{
+		return m_computerLocationsByAttribute;
+	}
+
+	const QString& computerLocationAttribute() const
+	{
+		return m_computerLocationAttribute;
+	}
+
 private:
 	LdapClient::Scope computerSearchScope() const;
 
@@ -2,6 +2,8 @@
 // This file is part of Veyon - https://veyon.io
 // SPDX-License-Identifier: LGPL-2.0-or-later
 
+#include <QtConcurrent>
+
 #include "LdapConfiguration.h"
 #include "LdapDirectory.h"
 #include "LdapNetworkObjectDirectory.h"
@@ -10,8 +12,19 @@
 LdapNetworkObjectDirectory::LdapNetworkObjectDirectory( const LdapConfiguration& ldapConfiguration,
 														QObject* parent ) :
 	NetworkObjectDirectory( ldapConfiguration.directoryName(), parent ),
+	m_ldapConfiguration( ldapConfiguration ),
 	m_ldapDirectory( ldapConfiguration )
 {
+	connect( this, &LdapNetworkObjectDirectory::queryResultsAvailable,
+			 this, &LdapNetworkObjectDirectory::processQueryResults, Qt::QueuedConnection );
+}
+
+
+
+LdapNetworkObjectDirectory::~LdapNetworkObjectDirectory()
+{
+	m_abortBackgroundUpdate = true;
+	m_backgroundUpdate.waitForFinished();
 }
 
 
@@ -51,39 +64,266 @@ NetworkObjectList LdapNetworkObjectDirectory::queryParents( const NetworkObject&
 
 void LdapNetworkObjectDirectory::update()
 {
-	const auto locations = m_ldapDirectory.computerLocations();
+	// don't block the UI while querying large directories
+	if( VeyonCore::component() == VeyonCore::Component::Master )
+	{
+		updateInBackground();
+		return;
+	}
+
+	queryDirectory( m_ldapDirectory,
+					[this]( const QStringList& locations ) { updateLocations( locations ); },
+					[this]( const QString& location, const NetworkObjectList& computers, bool complete ) {
+						updateLocation( location, computers, complete );
+					} );
+}
+
+
+
+void LdapNetworkObjectDirectory::updateInBackground()
+{
+	if( m_backgroundUpdate.isRunning() )
+	{
+		return;
+	}
+
+	m_abortBackgroundUpdate = false;
+
+	m_backgroundUpdate = QtConcurrent::run( [this]() {
+		// LdapClient is not thread-safe so use a separate connection in the worker thread
+		LdapDirectory ldapDirectory( m_ldapConfiguration );
+
+		queryDirectory( ldapDirectory,
+						[this]( const QStringList& locations ) {
+							QMutexLocker locker( &m_queryResultsMutex );
+							m_queriedLocations = locations;
+							m_hasQueriedLocations = true;
+							Q_EMIT queryResultsAvailable();
+						},
+						[this]( const QString& location, const NetworkObjectList& computers, bool complete ) {
+							QMutexLocker locker( &m_queryResultsMutex );
+							m_queriedComputers.append( { location, computers, complete } );
+							Q_EMIT queryResultsAvailable();
+						} );
+	} );
+}
+
+
+
+void LdapNetworkObjectDirectory::processQueryResults()
+{
+	QStringList locations;
+	bool hasLocations = false;
+	QVector<QueriedComputers> computers;
+
+	m_queryResultsMutex.lock();
+	locations.swap( m_queriedLocations );
+	std::swap( hasLocations, m_hasQueriedLocations );
+	computers.swap( m_queriedComputers );
+	m_queryResultsMutex.unlock();
+
+	if( hasLocations )
+	{
+		updateLocations( locations );
+	}
 
-	for( const auto& location : std::as_const( locations ) )
+	for( const auto& location : std::as_const(computers) )
 	{
-		const NetworkObject locationObject{this, NetworkObject::Type::Location, location};
+		updateLocation( location.location, location.computers, location.complete );
+	}
+}
 
-		addOrUpdateObject( locationObject, rootObject() );
 
-		updateLocation( locationObject );
+
+void LdapNetworkObjectDirectory::updateLocations( const QStringList& locations )
+{
+	m_updatedComputerDns.clear();
+
+	for( const auto& location : locations )
+	{
+		addOrUpdateObject( NetworkObject{this, NetworkObject::Type::Location, location}, rootObject() );
 	}
 
-	removeObjects( rootObject(), [locations]( const NetworkObject& object ) {
+	removeObjects( rootObject(), [&locations]( const NetworkObject& object ) {
 		return object.type() == NetworkObject::Type::Location && locations.contains( object.name() ) == false; } );
 }
 
 
 
-void LdapNetworkObjectDirectory::updateLocation( const NetworkObject& locationObject )
+void LdapNetworkObjectDirectory::updateLocation( const QString& location, const NetworkObjectList& computers,
+												 bool complete )
 {
-	const auto computers = m_ldapDirectory.computerLocationEntries( locationObject.name() );
+	const NetworkObject locationObject{this, NetworkObject::Type::Location, location};
+
+	// computers of a location may arrive in several parts so remember all of them until the location is complete
+	auto& computerDns = m_updatedComputerDns[location];
+	computerDns.reserve( computerDns.size() + computers.size() );
 
-	for( const auto& computer : std::as_const( computers ) )
+	for( const auto& computer : computers )
 	{
-		const auto hostObject = computerToObject( this, &m_ldapDirectory, computer );
+		addOrUpdateObject( computer, locationObject );
+		computerDns.insert( computer.property( NetworkObject::Property::DirectoryAddress ).toString() );
+	}
+
+	if( complete )
+	{
+		removeObjects( locationObject, [&computerDns]( const NetworkObject& object ) {
+			return object.type() == NetworkObject::Type::Host &&
+				   computerDns.contains( object.property( NetworkObject::Property::DirectoryAddress ).toString() ) == false; } );
+
+		m_updatedComputerDns.remove( location );
+	}
+}
+
+
+
+void LdapNetworkObjectDirectory::queryDirectory( LdapDirectory& ldapDirectory,
+												 const LocationsHandler& locationsHandler,
+												 const LocationHandler& locationHandler )
+{
+	const auto locations = ldapDirectory.computerLocations();
+
+	locationsHandler( locations );
+
+	const auto locationContainers = ldapDirectory.computerLocationContainers();
+
+	// group memberships can't be derived from computer objects so all groups have to be queried in advance
+	QHash<QString, QStringList> groupMemberLocations;
+	QHash<QString, QString> pendingGroupMembers;
+
+	if( ldapDirectory.computerLocationsByContainer() == false &&
+		ldapDirectory.computerLocationsByAttribute() == false )
+	{
+		for( const auto& location : locations )
+		{
+			if( m_abortBackgroundUpdate )
+			{
+				return;
+			}
+
+			const auto members = ldapDirectory.computerLocationEntries( location );
+			for( const auto& member : members )
+			{
+				groupMemberLocations[member.toLower()].append( location );
+				pendingGroupMembers[member.toLower()] = member;
+			}
+		}
+	}
+
+	auto attributes = computerAttributes( &ldapDirectory );
+	if( ldapDirectory.computerLocationsByAttribute() )
+	{
+		attributes.append( ldapDirectory.computerLocationAttribute() );
+		attributes.removeDuplicates();
+	}
+
+	// fetch all computer objects with a single paged search and pass the computers of each page
+	// to their locations right away instead of waiting for the whole directory to be queried
+	QHash<QString, NetworkObjectList> pageComputers;
+
+	const auto success = ldapDirectory.computerObjects( attributes,
+		[&]( const QString& dn, const LdapClient::Object& computer ) {
+			const auto computerLocationNames = computerLocations( ldapDirectory, dn, computer, locationContainers, groupMemberLocations );
+			if( computerLocationNames.isEmpty() )
+			{
+				return;
+			}
+
+			pendingGroupMembers.remove( dn.toLower() );
+
+			const auto hostObject = computerEntryToObject( this, &ldapDirectory, dn, computer );
+			for( const auto& location : computerLocationNames )
+			{
+				pageComputers[location].append( hostObject );
+			}
+		},
+		[&]() {
+			for( auto it = pageComputers.constBegin(), end = pageComputers.constEnd(); it != end; ++it )
+			{
+				locationHandler( it.key(), it.value(), false );
+			}
+			pageComputers.clear();
+
+			return m_abortBackgroundUpdate == false;
+		} );
+
+	if( success == false || m_abortBackgroundUpdate )
+	{
+		return;
+	}
+
+	// computers which are not located in the computer tree (e.g. group members) have to be queried individually
+	QHash<QString, NetworkObjectList> remainingComputers;
+
+	for( auto it = pendingGroupMembers.constBegin(), end = pendingGroupMembers.constEnd(); it != end; ++it )
+	{
+		if( m_abortBackgroundUpdate )
+		{
+			return;
+		}
+
+		const auto hostObject = computerToObject( this, &ldapDirectory, it.value() );
 		if( hostObject.type() == NetworkObject::Type::Host )
 		{
-			addOrUpdateObject( hostObject, locationObject );
+			const auto memberLocations = groupMemberLocations.value( it.key() );
+			for( const auto& location : memberLocations )
+			{
+				remainingComputers[location].append( hostObject );
+			}
+		}
+	}
+
+	for( const auto& location : locations )
+	{
+		locationHandler( location, remainingComputers.value( location ), true );
+	}
+}
+
+
+
+QStringList LdapNetworkObjectDirectory::computerLocations( const LdapDirectory& ldapDirectory,
+														   const QString& computerDn,
+														   const LdapClient::Object& computer,
+														   const QHash<QString, QString>& locationContainers,
+														   const QHash<QString, QStringList>& groupMemberLocations ) const
+{
+	QStringList locations;
+
+	if( ldapDirectory.computerLocationsByContainer() )
+	{
+		// without recursive search operations only computers directly inside a location container belong to it
+		const auto recursive = m_ldapConfiguration.recursiveSearchOperations();
+
+		for( auto dn = LdapClient::parentDn( computerDn ); dn.isEmpty() == false; dn = LdapClient::parentDn( dn ) )
+		{
+			const auto it = locationContainers.constFind( dn.toLower() );
+			if( it != locationContainers.constEnd() )
+			{
+				locations.append( it.value() );
+			}
+
+			if( recursive == false )
+			{
+				break;
+			}
 		}
 	}
+	else if( ldapDirectory.computerLocationsByAttribute() )
+	{
+		for( auto it = computer.constBegin(), end = computer.constEnd(); it != end; ++it )
+		{
+			if( it.key().compare( ldapDirectory.computerLocationAttribute(), Qt::CaseInsensitive ) == 0 )
+			{
+				locations.append( it.value() );
+			}
+		}
+	}
+	else
+	{
+		locations = groupMemberLocations.value( computerDn.toLower() );
+	}
 
-	removeObjects( locationObject, [computers]( const NetworkObject& object ) {
-		return object.type() == NetworkObject::Type::Host &&
-			   computers.contains( object.property( NetworkObject::Property::DirectoryAddress ).toString() ) == false; } );
+	return locations;
 }
 
 
@@ -170,6 +410,20 @@ NetworkObjectList LdapNetworkObjectDirectory::queryHosts( NetworkObject::Propert
 
 NetworkObject LdapNetworkObjectDirectory::computerToObject( NetworkObjectDirectory* directory,
 												  LdapDirectory* ldapDirectory, const QString& computerDn )
+{
+	const auto computers = ldapDirectory->client().queryObjects( computerDn, computerAttributes( ldapDirectory ),
+															 ldapDirectory->computersFilter(), LdapClient::Scope::Base );
+	if( computers.isEmpty() == false )
+	{
+		return computerEntryToObject( directory, ldapDirectory, computers.firstKey(), computers.first() );
+	}
+
+	return NetworkObject{directory, NetworkObject::Type::None};
+}
+
+
+
+QStringList LdapNetworkObjectDirectory::computerAttributes( LdapDirectory* ldapDirectory )
 {
 	auto displayNameAttribute = ldapDirectory->computerDisplayNameAttribute();
 	if( displayNameAttribute.isEmpty() )
@@ -185,7 +439,7 @@ NetworkObject LdapNetworkObjectDirectory::computerToObject( NetworkObjectDirecto
 
 	QStringList computerAttributes{ LdapClient::cn(), displayNameAttribute, hostNameAttribute };
 
-	auto macAddressAttribute = ldapDirectory->computerMacAddressAttribute();
+	const auto macAddressAttribute = ldapDirectory->computerMacAddressAttribute();
 	if( macAddressAttribute.isEmpty() == false )
 	{
 		computerAttributes.append( macAddressAttribute );
@@ -193,36 +447,50 @@ NetworkObject LdapNetworkObjectDirectory::computerToObject( NetworkObjectDirecto
 
 	computerAttributes.removeDuplicates();
 
-	const auto computers = ldapDirectory->client().queryObjects( computerDn, computerAttributes,
-															 ldapDirectory->computersFilter(), LdapClient::Scope::Base );
-	if( computers.isEmpty() == false )
+	return computerAttributes;
+}
+
+
+
+NetworkObject LdapNetworkObjectDirectory::computerEntryToObject( NetworkObjectDirectory* directory,
+																 LdapDirectory* ldapDirectory,
+																 const QString& computerDn,
+																 const LdapClient::Object& computer )
+{
+	auto displayNameAttribute = ldapDirectory->computerDisplayNameAttribute();
+	if( displayNameAttribute.isEmpty() )
+	{
+		displayNameAttribute = LdapClient::cn();
+	}
+
+	auto hostNameAttribute = ldapDirectory->computerHostNameAttribute();
+	if( hostNameAttribute.isEmpty() )
 	{
-		const auto& computerDn = computers.firstKey();
-		const auto& computer = computers.first();
+		hostNameAttribute = LdapClient::cn();
+	}
 
-		auto displayName = computer[displayNameAttribute].value( 0 );
-		auto hostName = computer[hostNameAttribute].value( 0 );
+	const auto macAddressAttribute = ldapDirectory->computerMacAddressAttribute();
 
-		if( displayName.isEmpty() )
-		{
-			displayName = computer[LdapClient::cn()].value( 0 );
-		}
-		if( hostName.isEmpty() )
-		{
-			hostName = computer[LdapClient::cn()].value( 0 );
-		}
+	auto displayName = computer[displayNameAttribute].value( 0 );
+	auto hostName = computer[hostNameAttribute].value( 0 );
 
-		NetworkObject::Properties properties;
-		properties[NetworkObject::propertyKey(NetworkObject::Property::HostAddress)] = hostName;
-		if( macAddressAttribute.isEmpty() == false )
-		{
-			properties[NetworkObject::propertyKey(NetworkObject::Property::MacAddress)] =
-				computer[macAddressAttribute].value( 0 );
-		}
-		properties[NetworkObject::propertyKey(NetworkObject::Property::DirectoryAddress)] = computerDn;
+	if( displayName.isEmpty() )
+	{
+		displayName = computer[LdapClient::cn()].value( 0 );
+	}
+	if( hostName.isEmpty() )
+	{
+		hostName = computer[LdapClient::cn()].value( 0 );
+	}
 
-		return NetworkObject{directory, NetworkObject::Type::Host, displayName, properties};
+	NetworkObject::Properties properties;
+	properties[NetworkObject::propertyKey(NetworkObject::Property::HostAddress)] = hostName;
+	if( macAddressAttribute.isEmpty() == false )
+	{
+		properties[NetworkObject::propertyKey(NetworkObject::Property::MacAddress)] =
+			computer[macAddressAttribute].value( 0 );
 	}
+	properties[NetworkObject::propertyKey(NetworkObject::Property::DirectoryAddress)] = computerDn;
 
-	return NetworkObject{directory, NetworkObject::Type::None};
+	return NetworkObject{directory, NetworkObject::Type::Host, displayName, properties};
 }
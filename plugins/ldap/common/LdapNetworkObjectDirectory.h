@@ -4,6 +4,11 @@
 
 #pragma once
 
+#include <QFuture>
+#include <QMutex>
+
+#include <atomic>
+
 #include "LdapDirectory.h"
 #include "NetworkObjectDirectory.h"
 
@@ -12,6 +17,7 @@ class LDAP_COMMON_EXPORT LdapNetworkObjectDirectory : public NetworkObjectDirect
 	Q_OBJECT
 public:
 	LdapNetworkObjectDirectory( const LdapConfiguration& ldapConfiguration, QObject* parent );
+	~LdapNetworkObjectDirectory() override;
 
 	NetworkObjectList queryObjects( NetworkObject::Type type,
 									NetworkObject::Property property, const QVariant& value ) override;
@@ -21,11 +27,52 @@ public:
 						  LdapDirectory* ldapDirectory, const QString& computerDn );
 
 private:
+	using LocationsHandler = std::function<void (const QStringList& locations)>;
+	using LocationHandler = std::function<void (const QString& location, const NetworkObjectList& computers, bool complete)>;
+
+	struct QueriedComputers
+	{
+		QString location;
+		NetworkObjectList computers;
+		bool complete{false};
+	};
+
 	void update() override;
-	void updateLocation( const NetworkObject& locationObject );
+	void updateInBackground();
+	void processQueryResults();
+
+	void updateLocations( const QStringList& locations );
+	void updateLocation( const QString& location, const NetworkObjectList& computers, bool complete );
+
+	void queryDirectory( LdapDirectory& ldapDirectory,
+						 const LocationsHandler& locationsHandler, const LocationHandler& locationHandler );
+	QStringList computerLocations( const LdapDirectory& ldapDirectory,
+								   const QString& computerDn, const LdapClient::Object& computer,
+								   const QHash<QString, QString>& locationContainers,
+								   const QHash<QString, QStringList>& groupMemberLocations ) const;
+
+	static QStringList computerAttributes( LdapDirectory* ldapDirectory );
+	static NetworkObject computerEntryToObject( NetworkObjectDirectory* directory, LdapDirectory* ldapDirectory,
+												const QString& computerDn,
+												const LdapClient::Object& computer );
 
 	NetworkObjectList queryLocations( NetworkObject::Property property, const QVariant& value );
 	NetworkObjectList queryHosts( NetworkObject::Property property, const QVariant& value );
 
+	const LdapConfiguration& m_ldapConfiguration;
 	LdapDirectory m_ldapDirectory;
+
+	QFuture<void> m_backgroundUpdate;
+	std::atomic<bool> m_abortBackgroundUpdate{false};
+
+	QMutex m_queryResultsMutex;
+	QStringList m_queriedLocations;
+	bool m_hasQueriedLocations{false};
+	QVector<QueriedComputers> m_queriedComputers;
+
+	QHash<QString, QSet<QString>> m_updatedComputerDns;
+
+Q_SIGNALS:
+	void queryResultsAvailable();
+
 };
@@ -226,7 +226,8 @@ bool LinuxCoreFunctions::runProgramAsAdmin( const QString& program, const QStrin
 
 
 bool LinuxCoreFunctions::runProgramAsUser( const QString& program, const QStringList& parameters,
-										   const QString& username, const QString& desktop )
+										   const QString& username, const QString& desktop,
+										   const QStringList& extraEnvironment, qint64* processId )
 {
 	Q_UNUSED(desktop)
 
@@ -287,8 +288,19 @@ bool LinuxCoreFunctions::runProgramAsUser( const QString& program, const QString
 #endif
 
 	QObject::connect( process, QOverload<int, QProcess::ExitStatus>::of( &QProcess::finished ), &QProcess::deleteLater );
+
+	if( extraEnvironment.isEmpty() == false )
+	{
+		process->setEnvironment( QProcess::systemEnvironment() + extraEnvironment );
+	}
+
 	process->start( program, parameters );
 
+	if( processId )
+	{
+		*processId = process->processId();
+	}
+
 	return true;
 }
 
@@ -23,6 +23,8 @@
  */
 
 #include <QDir>
+#include <QStandardPaths>
+#include <QSysInfo>
 
 #include <fcntl.h>
 #include <grp.h>
@@ -55,6 +57,37 @@ QString LinuxFilesystemFunctions::globalTempPath() const
 
 
 
+QString LinuxFilesystemFunctions::privateHostDataPath()
+{
+	// home directories may be shared between hosts so use a host-specific directory for regular users
+	const auto path = geteuid() == 0 ?
+						  QStringLiteral("/var/lib/veyon") :
+						  QStringLiteral("%1/veyon/%2").arg( QStandardPaths::writableLocation( QStandardPaths::GenericDataLocation ),
+															 QSysInfo::machineHostName() );
+
+	if( QDir().mkpath( path ) == false )
+	{
+		vCritical() << "could not create directory" << path;
+		return {};
+	}
+
+	const auto nativePath = QFile::encodeName( path );
+
+	struct stat s{};
+	if( lstat( nativePath.constData(), &s ) != 0 ||
+		S_ISDIR(s.st_mode) == false ||
+		s.st_uid != geteuid() ||
+		chmod( nativePath.constData(), S_IRWXU ) != 0 )
+	{
+		vCritical() << "could not restrict access to directory" << path;
+		return {};
+	}
+
+	return path;
+}
+
+
+
 QString LinuxFilesystemFunctions::fileOwnerGroup( const QString& filePath )
 {
 	return QFileInfo( filePath ).group();
@@ -0,0 +1,296 @@
+/*
+ * LinuxGroupResolver.cpp - implementation of LinuxGroupResolver class
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QFileInfo>
+
+#include "LinuxGroupResolver.h"
+#include "VeyonCore.h"
+
+#include <grp.h>
+#include <pwd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <iterator>
+#include <vector>
+
+
+QStringList LinuxGroupResolver::groups()
+{
+	QMutexLocker locker( &m_mutex );
+
+	checkDatabaseModification();
+	removeExpiredEntries();
+
+	if( isValid( m_groups.timestamp ) == false )
+	{
+		enumerateGroups();
+	}
+
+	return m_groups.groups;
+}
+
+
+
+QStringList LinuxGroupResolver::groupsOfUser( const QString& username )
+{
+	QMutexLocker locker( &m_mutex );
+
+	checkDatabaseModification();
+	removeExpiredEntries();
+
+	auto& entry = m_userGroups[username];
+	if( isValid( entry.timestamp ) == false )
+	{
+		entry.groups = lookupGroupsOfUser( username );
+		entry.timestamp.start();
+	}
+
+	return entry.groups;
+}
+
+
+
+void LinuxGroupResolver::invalidate()
+{
+	QMutexLocker locker( &m_mutex );
+
+	m_groups = {};
+	m_userGroups.clear();
+	m_groupNames.clear();
+}
+
+
+
+void LinuxGroupResolver::checkDatabaseModification()
+{
+	// changes of NSS configuration or local group database make all cached data stale
+	const auto timestamp = qMax( QFileInfo( QStringLiteral("/etc/nsswitch.conf") ).lastModified(),
+								 QFileInfo( QStringLiteral("/etc/group") ).lastModified() );
+
+	if( timestamp != m_databaseTimestamp )
+	{
+		m_databaseTimestamp = timestamp;
+		m_groups = {};
+		m_userGroups.clear();
+		m_groupNames.clear();
+	}
+}
+
+
+
+void LinuxGroupResolver::removeExpiredEntries()
+{
+	// drop outdated entries of users and groups which have not been looked up again
+	// so the caches do not grow with every user ever seen by a long-running service
+	if( isValid( m_lastExpiryCheck ) )
+	{
+		return;
+	}
+
+	m_lastExpiryCheck.start();
+
+	for( auto it = m_userGroups.begin(); it != m_userGroups.end(); )
+	{
+		it = isValid( it->timestamp ) ? std::next( it ) : m_userGroups.erase( it );
+	}
+
+	for( auto it = m_groupNames.begin(); it != m_groupNames.end(); )
+	{
+		it = isValid( it->timestamp ) ? std::next( it ) : m_groupNames.erase( it );
+	}
+}
+
+
+
+void LinuxGroupResolver::enumerateGroups()
+{
+	QStringList groups;
+
+	std::vector<char> buffer( InitialBufferSize );
+
+	setgrent();
+
+	while( true )
+	{
+		group groupEntry{};
+		group* result = nullptr;
+
+		const auto error = getgrent_r( &groupEntry, buffer.data(), buffer.size(), &result );
+		if( error == ERANGE && buffer.size() < MaximumBufferSize )
+		{
+			// retry current entry with larger buffer
+			buffer.resize( buffer.size() * 2 );
+			continue;
+		}
+
+		if( error != 0 || result == nullptr )
+		{
+			break;
+		}
+
+		const auto groupName = QString::fromUtf8( result->gr_name );
+
+		groups.append( groupName );
+
+		// prefetch names for subsequent lookups of user groups
+		auto& nameEntry = m_groupNames[result->gr_gid];
+		nameEntry.name = groupName;
+		nameEntry.timestamp.start();
+	}
+
+	endgrent();
+
+	m_groups.groups = groups;
+	m_groups.timestamp.start();
+
+	// memberships of individual users are deliberately not prefetched from the member
+	// lists here as they lack primary groups and memberships only provided via
+	// initgroups (e.g. by sssd or winbind), i.e. results would differ from groupsOfUser()
+	// - instead the group names resolved above are reused by subsequent user lookups
+	vDebug() << "enumerated" << groups.size() << "groups";
+}
+
+
+
+QStringList LinuxGroupResolver::lookupGroupsOfUser( const QString& username )
+{
+	const auto name = username.toUtf8();
+
+	std::vector<char> buffer( InitialBufferSize );
+	passwd passwdEntry{};
+	passwd* passwdResult = nullptr;
+
+	while( getpwnam_r( name.constData(), &passwdEntry, buffer.data(), buffer.size(), &passwdResult ) == ERANGE &&
+		   buffer.size() < MaximumBufferSize )
+	{
+		buffer.resize( buffer.size() * 2 );
+	}
+
+	if( passwdResult == nullptr )
+	{
+		return {};
+	}
+
+	const auto primaryGroupId = passwdResult->pw_gid;
+
+	int groupCount = 64;
+	std::vector<gid_t> groupIds( size_t(groupCount) );
+
+	while( getgrouplist( name.constData(), primaryGroupId, groupIds.data(), &groupCount ) < 0 )
+	{
+		if( groupCount <= int(groupIds.size()) || groupCount > MaximumGroupCount )
+		{
+			vWarning() << "could not determine groups of user" << username;
+			return {};
+		}
+
+		// groupCount now holds the required size
+		groupIds.resize( size_t(groupCount) );
+	}
+
+	QStringList groups;
+	groups.reserve( groupCount );
+
+	for( int i = 0; i < groupCount; ++i )
+	{
+		// the primary group is always returned by getgrouplist() but only counts
+		// if the user is listed as member in the group database
+		if( groupIds[size_t(i)] == primaryGroupId && isListedMember( primaryGroupId, name ) == false )
+		{
+			continue;
+		}
+
+		const auto groupName = lookupGroupName( groupIds[size_t(i)] );
+		if( groupName.isEmpty() == false )
+		{
+			groups.append( groupName );
+		}
+	}
+
+	return groups;
+}
+
+
+
+QString LinuxGroupResolver::lookupGroupName( gid_t groupId )
+{
+	const auto it = m_groupNames.constFind( groupId );
+	if( it != m_groupNames.constEnd() && isValid( it->timestamp ) )
+	{
+		return it->name;
+	}
+
+	std::vector<char> buffer( InitialBufferSize );
+	group groupEntry{};
+	group* result = nullptr;
+
+	while( getgrgid_r( groupId, &groupEntry, buffer.data(), buffer.size(), &result ) == ERANGE &&
+		   buffer.size() < MaximumBufferSize )
+	{
+		buffer.resize( buffer.size() * 2 );
+	}
+
+	QString groupName;
+	if( result )
+	{
+		groupName = QString::fromUtf8( result->gr_name );
+	}
+
+	auto& entry = m_groupNames[groupId];
+	entry.name = groupName;
+	entry.timestamp.start();
+
+	return groupName;
+}
+
+
+
+bool LinuxGroupResolver::isListedMember( gid_t groupId, const QByteArray& username )
+{
+	std::vector<char> buffer( InitialBufferSize );
+	group groupEntry{};
+	group* result = nullptr;
+
+	while( getgrgid_r( groupId, &groupEntry, buffer.data(), buffer.size(), &result ) == ERANGE &&
+		   buffer.size() < MaximumBufferSize )
+	{
+		buffer.resize( buffer.size() * 2 );
+	}
+
+	if( result == nullptr )
+	{
+		return false;
+	}
+
+	for( auto member = result->gr_mem; member && *member; ++member )
+	{
+		if( username == *member )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,91 @@
+/*
+ * LinuxGroupResolver.h - declaration of LinuxGroupResolver class
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QStringList>
+
+#include <sys/types.h>
+
+// resolves groups and group memberships through NSS in-process and caches the
+// results for a limited time so access checks do not have to query the (possibly
+// remote) group database over and over again
+class LinuxGroupResolver
+{
+public:
+	LinuxGroupResolver() = default;
+
+	// returns names of all groups which can be enumerated
+	QStringList groups();
+
+	// returns names of all supplementary groups of given user including memberships
+	// provided by NSS modules only (e.g. sssd or winbind) - the primary group is only
+	// included if the user is listed as a member explicitly
+	QStringList groupsOfUser( const QString& username );
+
+	void invalidate();
+
+private:
+	struct CacheEntry
+	{
+		QStringList groups;
+		QElapsedTimer timestamp;
+	};
+
+	struct GroupNameEntry
+	{
+		QString name;
+		QElapsedTimer timestamp;
+	};
+
+	static constexpr auto TimeToLive = 60*1000;
+	static constexpr auto MaximumGroupCount = 65536;
+	static constexpr auto InitialBufferSize = 16*1024;
+	static constexpr auto MaximumBufferSize = 16*1024*1024;
+
+	static bool isValid( const QElapsedTimer& timestamp )
+	{
+		return timestamp.isValid() && timestamp.hasExpired( TimeToLive ) == false;
+	}
+
+	void checkDatabaseModification();
+	void removeExpiredEntries();
+	void enumerateGroups();
+	QStringList lookupGroupsOfUser( const QString& username );
+	QString lookupGroupName( gid_t groupId );
+	static bool isListedMember( gid_t groupId, const QByteArray& username );
+
+	QMutex m_mutex;
+
+	QDateTime m_databaseTimestamp;
+	CacheEntry m_groups;
+	QHash<QString, CacheEntry> m_userGroups;
+	QHash<gid_t, GroupNameEntry> m_groupNames;
+	QElapsedTimer m_lastExpiryCheck;
+
+} ;
@@ -24,6 +24,11 @@
 
 #include <netinet/in.h>
 #include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <array>
+#include <climits>
+#include <cerrno>
 
 #include <QProcess>
 
@@ -88,3 +93,41 @@ bool LinuxNetworkFunctions::configureSocketKeepalive( Socket socket, bool enable
 
 	return true;
 }
+
+
+
+qint64 LinuxNetworkFunctions::writeGathered( Socket socket, const QVector<QByteArray>& buffers, int firstBuffer, qint64 offset )
+{
+	std::array<iovec, IOV_MAX> vectors{};
+	size_t vectorCount = 0;
+
+	for( int i = firstBuffer; i < buffers.size() && vectorCount < vectors.size(); ++i )
+	{
+		const auto bufferOffset = i == firstBuffer ? offset : 0;
+		vectors[vectorCount].iov_base = const_cast<char *>( buffers[i].constData() + bufferOffset );
+		vectors[vectorCount].iov_len = size_t( buffers[i].size() - bufferOffset );
+		++vectorCount;
+	}
+
+	if( vectorCount == 0 )
+	{
+		return 0;
+	}
+
+	msghdr message{};
+	message.msg_iov = vectors.data();
+	message.msg_iovlen = vectorCount;
+
+	const auto result = sendmsg( static_cast<int>( socket ), &message, MSG_NOSIGNAL | MSG_DONTWAIT );
+	if( result < 0 )
+	{
+		if( errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR )
+		{
+			return 0;
+		}
+
+		return -1;
+	}
+
+	return result;
+}
@@ -36,4 +36,6 @@ public:
 
 	bool configureSocketKeepalive( Socket socket, bool enabled, int idleTime, int interval, int probes ) override;
 
+	qint64 writeGathered( Socket socket, const QVector<QByteArray>& buffers, int firstBuffer, qint64 offset ) override;
+
 };
@@ -35,6 +35,7 @@
 
 #include "LinuxCoreFunctions.h"
 #include "LinuxSessionFunctions.h"
+#include "LinuxSessionTracker.h"
 #include "PlatformSessionManager.h"
 
 
@@ -137,6 +138,12 @@ QStringList LinuxSessionFunctions::listSessions()
 {
 	QStringList sessions;
 
+	const auto tracker = LinuxSessionTracker::instance();
+	if( tracker && tracker->lookupSessions( sessions ) )
+	{
+		return sessions;
+	}
+
 	const QDBusReply<QDBusArgument> reply = LinuxCoreFunctions::systemdLoginManager()->call( QStringLiteral("ListSessions") );
 
 	if( reply.isValid() )
@@ -154,6 +161,12 @@ QStringList LinuxSessionFunctions::listSessions()
 
 			sessions.append( session.path.path() );
 		}
+
+		if( tracker )
+		{
+			tracker->storeSessions( sessions );
+		}
+
 		return sessions;
 	}
 
@@ -166,6 +179,14 @@ QStringList LinuxSessionFunctions::listSessions()
 
 QVariant LinuxSessionFunctions::getSessionProperty(const QString& session, const QString& property, bool logErrors)
 {
+	const auto tracker = LinuxSessionTracker::instance();
+
+	QVariant value;
+	if( tracker && tracker->lookupProperty( session, property, value ) )
+	{
+		return value;
+	}
+
 	QDBusInterface loginManager( QStringLiteral("org.freedesktop.login1"),
 								 session,
 								 QStringLiteral("org.freedesktop.DBus.Properties"),
@@ -192,7 +213,14 @@ QVariant LinuxSessionFunctions::getSessionProperty(const QString& session, const
 		return {};
 	}
 
-	return reply.value().variant();
+	value = reply.value().variant();
+
+	if( tracker )
+	{
+		tracker->storeProperty( session, property, value );
+	}
+
+	return value;
 }
 
 
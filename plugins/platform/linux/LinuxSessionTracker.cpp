@@ -0,0 +1,299 @@
+/*
+ * LinuxSessionTracker.cpp - implementation of LinuxSessionTracker class
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QCoreApplication>
+#include <QDBusArgument>
+#include <QDBusConnection>
+#include <QDBusReply>
+
+#include "LinuxCoreFunctions.h"
+#include "LinuxSessionTracker.h"
+#include "VeyonCore.h"
+
+
+LinuxSessionTracker* LinuxSessionTracker::instance()
+{
+	static QMutex instanceMutex;
+	static LinuxSessionTracker* instance = nullptr;
+
+	QMutexLocker locker( &instanceMutex );
+
+	const auto application = QCoreApplication::instance();
+
+	if( instance == nullptr && application )
+	{
+		instance = new LinuxSessionTracker;
+
+		// receive signals in the main thread regardless of the calling thread and
+		// dispose the instance along with the application object
+		instance->moveToThread( application->thread() );
+		connect( application, &QObject::destroyed, instance, [] {
+			QMutexLocker destroyLocker( &instanceMutex );
+			delete instance;
+			instance = nullptr;
+		}, Qt::DirectConnection );
+	}
+
+	return instance;
+}
+
+
+
+bool LinuxSessionTracker::lookupSessions( QStringList& sessions )
+{
+	QMutexLocker locker( &m_mutex );
+
+	if( m_connected && m_sessionsValid )
+	{
+		sessions = m_sessions;
+		return true;
+	}
+
+	return false;
+}
+
+
+
+void LinuxSessionTracker::storeSessions( const QStringList& sessions )
+{
+	QMutexLocker locker( &m_mutex );
+
+	m_sessions = sessions;
+	m_sessionsValid = true;
+}
+
+
+
+bool LinuxSessionTracker::lookupProperty( const QString& session, const QString& property, QVariant& value )
+{
+	if( m_connected == false || m_uncachedProperties.contains( property ) )
+	{
+		return false;
+	}
+
+	const auto sessionPath = resolveSessionPath( session );
+	if( sessionPath.isEmpty() )
+	{
+		return false;
+	}
+
+	QMutexLocker locker( &m_mutex );
+
+	const auto properties = m_sessionProperties.constFind( sessionPath );
+	if( properties == m_sessionProperties.constEnd() )
+	{
+		return false;
+	}
+
+	const auto entry = properties->constFind( property );
+	if( entry == properties->constEnd() )
+	{
+		return false;
+	}
+
+	value = *entry;
+
+	return true;
+}
+
+
+
+void LinuxSessionTracker::storeProperty( const QString& session, const QString& property, const QVariant& value )
+{
+	if( m_connected == false || isCacheable( property, value ) == false )
+	{
+		return;
+	}
+
+	const auto sessionPath = resolveSessionPath( session );
+	if( sessionPath.isEmpty() )
+	{
+		return;
+	}
+
+	QMutexLocker locker( &m_mutex );
+
+	m_sessionProperties[sessionPath][property] = value;
+}
+
+
+
+void LinuxSessionTracker::addSession( const QString& login1SessionId, const QDBusObjectPath& sessionObjectPath )
+{
+	Q_UNUSED(login1SessionId)
+
+	QMutexLocker locker( &m_mutex );
+
+	if( m_sessions.contains( sessionObjectPath.path() ) == false )
+	{
+		m_sessions.append( sessionObjectPath.path() );
+	}
+}
+
+
+
+void LinuxSessionTracker::removeSession( const QString& login1SessionId, const QDBusObjectPath& sessionObjectPath )
+{
+	Q_UNUSED(login1SessionId)
+
+	QMutexLocker locker( &m_mutex );
+
+	m_sessions.removeAll( sessionObjectPath.path() );
+	m_sessionProperties.remove( sessionObjectPath.path() );
+
+	for( auto it = m_sessionAliases.begin(); it != m_sessionAliases.end(); )
+	{
+		if( it.value() == sessionObjectPath.path() )
+		{
+			it = m_sessionAliases.erase( it );
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+
+
+void LinuxSessionTracker::updateProperties( const QString& interface, const QVariantMap& changedProperties,
+											const QStringList& invalidatedProperties, const QDBusMessage& message )
+{
+	if( interface != QLatin1String("org.freedesktop.login1.Session") )
+	{
+		return;
+	}
+
+	QMutexLocker locker( &m_mutex );
+
+	const auto properties = m_sessionProperties.find( message.path() );
+	if( properties == m_sessionProperties.end() )
+	{
+		return;
+	}
+
+	for( auto it = changedProperties.constBegin(), end = changedProperties.constEnd(); it != end; ++it )
+	{
+		if( isCacheable( it.key(), it.value() ) )
+		{
+			properties->insert( it.key(), it.value() );
+		}
+		else
+		{
+			properties->remove( it.key() );
+		}
+	}
+
+	for( const auto& property : invalidatedProperties )
+	{
+		properties->remove( property );
+	}
+}
+
+
+
+LinuxSessionTracker::LinuxSessionTracker() :
+	QObject(),
+	// transitions such as opening -> online or online -> closing are not announced
+	m_uncachedProperties( {
+		QStringLiteral("State")
+	} )
+{
+	const auto service = QStringLiteral("org.freedesktop.login1");
+	auto bus = QDBusConnection::systemBus();
+
+	m_connected = bus.connect( service, QStringLiteral("/org/freedesktop/login1"),
+							   QStringLiteral("org.freedesktop.login1.Manager"), QStringLiteral("SessionNew"),
+							   this, SLOT(addSession(QString,QDBusObjectPath)) ) &&
+				  bus.connect( service, QStringLiteral("/org/freedesktop/login1"),
+							   QStringLiteral("org.freedesktop.login1.Manager"), QStringLiteral("SessionRemoved"),
+							   this, SLOT(removeSession(QString,QDBusObjectPath)) ) &&
+				  // an empty path matches the property changes of all session objects
+				  bus.connect( service, {}, QStringLiteral("org.freedesktop.DBus.Properties"),
+							   QStringLiteral("PropertiesChanged"),
+							   this, SLOT(updateProperties(QString,QVariantMap,QStringList,QDBusMessage)) );
+
+	if( m_connected == false )
+	{
+		vWarning() << "could not subscribe to login manager signals - session information will not be cached";
+	}
+}
+
+
+
+QString LinuxSessionTracker::resolveSessionPath( const QString& session )
+{
+	const auto sessionPathPrefix = QStringLiteral("/org/freedesktop/login1/session/");
+
+	if( session != sessionPathPrefix + QLatin1String("auto") &&
+		session != sessionPathPrefix + QLatin1String("self") )
+	{
+		return session;
+	}
+
+	{
+		QMutexLocker locker( &m_mutex );
+		const auto alias = m_sessionAliases.constFind( session );
+		if( alias != m_sessionAliases.constEnd() )
+		{
+			return *alias;
+		}
+	}
+
+	// aliases refer to the session of the calling process, so they resolve to the
+	// same session for the lifetime of this process
+	QDBusInterface sessionProperties( QStringLiteral("org.freedesktop.login1"),
+									  session,
+									  QStringLiteral("org.freedesktop.DBus.Properties"),
+									  QDBusConnection::systemBus() );
+
+	const QDBusReply<QDBusVariant> sessionId = sessionProperties.call( QStringLiteral("Get"),
+																	   QStringLiteral("org.freedesktop.login1.Session"),
+																	   QStringLiteral("Id") );
+	if( sessionId.isValid() == false )
+	{
+		return {};
+	}
+
+	const QDBusReply<QDBusObjectPath> sessionPath = LinuxCoreFunctions::systemdLoginManager()->call(
+		QDBus::Block, QStringLiteral("GetSession"), sessionId.value().variant().toString() );
+	if( sessionPath.isValid() == false )
+	{
+		return {};
+	}
+
+	QMutexLocker locker( &m_mutex );
+	m_sessionAliases[session] = sessionPath.value().path();
+
+	return sessionPath.value().path();
+}
+
+
+
+bool LinuxSessionTracker::isCacheable( const QString& property, const QVariant& value ) const
+{
+	// demarshalling structures from a shared QDBusArgument can not be repeated
+	return m_uncachedProperties.contains( property ) == false &&
+			value.isValid() && value.userType() != qMetaTypeId<QDBusArgument>();
+}
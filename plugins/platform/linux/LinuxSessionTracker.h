@@ -0,0 +1,81 @@
+/*
+ * LinuxSessionTracker.h - declaration of LinuxSessionTracker class
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QDBusMessage>
+#include <QDBusObjectPath>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QVariant>
+
+// clazy:excludeall=ctor-missing-parent-argument
+
+// keeps a snapshot of logind sessions and their properties which is kept up to date
+// via logind signals so session information can be answered without D-Bus calls -
+// cached data stays valid until invalidated by a signal
+class LinuxSessionTracker : public QObject
+{
+	Q_OBJECT
+public:
+	// returns the process-wide instance or nullptr if no application object exists
+	static LinuxSessionTracker* instance();
+
+	bool lookupSessions( QStringList& sessions );
+	void storeSessions( const QStringList& sessions );
+
+	bool lookupProperty( const QString& session, const QString& property, QVariant& value );
+	void storeProperty( const QString& session, const QString& property, const QVariant& value );
+
+private Q_SLOTS:
+	void addSession( const QString& login1SessionId, const QDBusObjectPath& sessionObjectPath );
+	void removeSession( const QString& login1SessionId, const QDBusObjectPath& sessionObjectPath );
+	void updateProperties( const QString& interface, const QVariantMap& changedProperties,
+						   const QStringList& invalidatedProperties, const QDBusMessage& message );
+
+private:
+	LinuxSessionTracker();
+
+	// maps alias paths such as /org/freedesktop/login1/session/auto to the object
+	// path of the session, since signals are only emitted for the latter - returns
+	// an empty string if the alias can't be resolved
+	QString resolveSessionPath( const QString& session );
+
+	bool isCacheable( const QString& property, const QVariant& value ) const;
+
+	// properties which change without logind emitting PropertiesChanged signals
+	const QSet<QString> m_uncachedProperties;
+
+	QMutex m_mutex;
+	bool m_connected{false};
+
+	QStringList m_sessions;
+	bool m_sessionsValid{false};
+
+	QHash<QString, QString> m_sessionAliases;
+	QHash<QString, QVariantMap> m_sessionProperties;
+
+} ;
@@ -71,20 +71,7 @@ QStringList LinuxUserFunctions::userGroups( bool queryDomainGroups )
 {
 	Q_UNUSED(queryDomainGroups)
 
-	QStringList groupList;
-
-	QProcess getentProcess;
-	getentProcess.start( QStringLiteral("getent"), { QStringLiteral("group") } );
-	getentProcess.waitForFinished();
-
-	const auto groups = QString::fromUtf8( getentProcess.readAll() ).split( QLatin1Char('\n') );
-
-	groupList.reserve( groups.size() );
-
-	for( const auto& group : groups )
-	{
-		groupList += group.split( QLatin1Char(':') ).first();
-	}
+	auto groupList = m_groupResolver.groups();
 
 	const QStringList ignoredGroups( {
 		QStringLiteral("daemon"),
@@ -177,22 +164,7 @@ QStringList LinuxUserFunctions::groupsOfUser( const QString& username, bool quer
 {
 	Q_UNUSED(queryDomainGroups)
 
-	QStringList groupList;
-
-	QProcess getentProcess;
-	getentProcess.start( QStringLiteral("getent"), { QStringLiteral("group") } );
-	getentProcess.waitForFinished();
-
-	const auto groups = QString::fromUtf8( getentProcess.readAll() ).split( QLatin1Char('\n') );
-	for( const auto& group : groups )
-	{
-		const auto groupComponents = group.split( QLatin1Char(':') );
-		if( groupComponents.size() == 4 &&
-			groupComponents.last().split( QLatin1Char(',') ).contains(username))
-		{
-			groupList += groupComponents.first(); // clazy:exclude=reserve-candidates
-		}
-	}
+	auto groupList = m_groupResolver.groupsOfUser( username );
 
 	groupList.removeAll( QString() );
 
@@ -26,6 +26,7 @@
 
 #include <QDBusConnection>
 
+#include "LinuxGroupResolver.h"
 #include "LogonHelper.h"
 #include "PlatformUserFunctions.h"
 
@@ -63,4 +64,6 @@ private:
 
 	LogonHelper m_logonHelper{};
 
+	LinuxGroupResolver m_groupResolver{};
+
 };
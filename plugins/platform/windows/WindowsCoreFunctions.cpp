@@ -298,7 +298,9 @@ bool WindowsCoreFunctions::runProgramAsAdmin( const QString& program, const QStr
 bool WindowsCoreFunctions::runProgramAsUser( const QString& program,
 											 const QStringList& parameters,
 											 const QString& username,
-											 const QString& desktop )
+											 const QString& desktop,
+											 const QStringList& extraEnvironment,
+											 qint64* processId )
 {
 	vDebug() << program << parameters << username << desktop;
 
@@ -309,9 +311,13 @@ bool WindowsCoreFunctions::runProgramAsUser( const QString& program,
 		return false;
 	}
 
-	auto processHandle = runProgramInSession( program, parameters, {}, baseProcessId, desktop );
+	auto processHandle = runProgramInSession( program, parameters, extraEnvironment, baseProcessId, desktop );
 	if( processHandle )
 	{
+		if( processId )
+		{
+			*processId = GetProcessId( processHandle );
+		}
 		CloseHandle( processHandle );
 		return true;
 	}
@@ -479,7 +485,14 @@ HANDLE WindowsCoreFunctions::runProgramInSession( const QString& program,
 												  DWORD baseProcessId,
 												  const QString& desktop )
 {
-	vDebug() << program << parameters << extraEnvironment << baseProcessId;
+	// don't log values of environment variables as they may contain secrets
+	QStringList extraEnvironmentNames;
+	for( const auto& variable : extraEnvironment )
+	{
+		extraEnvironmentNames.append( variable.section( QLatin1Char('='), 0, 0 ) );
+	}
+
+	vDebug() << program << parameters << extraEnvironmentNames << baseProcessId;
 
 	enablePrivilege( SE_ASSIGNPRIMARYTOKEN_NAME, true );
 	enablePrivilege( SE_INCREASE_QUOTA_NAME, true );
@@ -63,7 +63,9 @@ public:
 	bool runProgramAsUser( const QString& program,
 						   const QStringList& parameters,
 						   const QString& username,
-						   const QString& desktop ) override;
+						   const QString& desktop,
+						   const QStringList& extraEnvironment = {},
+						   qint64* processId = nullptr ) override;
 
 	QString genericUrlHandler() const override;
 
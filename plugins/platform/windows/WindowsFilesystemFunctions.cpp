@@ -22,7 +22,10 @@
  *
  */
 
+#include <vector>
+
 #include <QDir>
+#include <QSysInfo>
 
 #include <shlobj.h>
 #include <accctrl.h>
@@ -33,6 +36,64 @@
 #include "WindowsFilesystemFunctions.h"
 
 
+static bool restrictAccessToCurrentUser( const QString& path )
+{
+	HANDLE token = nullptr;
+	if( OpenProcessToken( GetCurrentProcess(), TOKEN_QUERY, &token ) == false )
+	{
+		vCritical() << "OpenProcessToken() failed:" << GetLastError();
+		return false;
+	}
+
+	DWORD tokenInfoSize = 0;
+	GetTokenInformation( token, TokenUser, nullptr, 0, &tokenInfoSize );
+
+	std::vector<char> tokenInfo( tokenInfoSize );
+	if( tokenInfoSize == 0 ||
+		GetTokenInformation( token, TokenUser, tokenInfo.data(), tokenInfoSize, &tokenInfoSize ) == false )
+	{
+		vCritical() << "GetTokenInformation() failed:" << GetLastError();
+		CloseHandle( token );
+		return false;
+	}
+
+	CloseHandle( token );
+
+	// full control for the current user only, inherited by all files in the directory
+	EXPLICIT_ACCESS ea{};
+	ea.grfAccessPermissions = GENERIC_ALL;
+	ea.grfAccessMode = SET_ACCESS;
+	ea.grfInheritance = SUB_CONTAINERS_AND_OBJECTS_INHERIT;
+	ea.Trustee.TrusteeForm = TRUSTEE_IS_SID;
+	ea.Trustee.TrusteeType = TRUSTEE_IS_USER;
+	ea.Trustee.ptstrName = LPTSTR( reinterpret_cast<PTOKEN_USER>( tokenInfo.data() )->User.Sid );
+
+	PACL acl = nullptr;
+	if( SetEntriesInAcl( 1, &ea, nullptr, &acl ) != ERROR_SUCCESS )
+	{
+		vCritical() << "SetEntriesInAcl() failed";
+		return false;
+	}
+
+	// protect the DACL so permissions inherited from parent folders are dropped
+	const auto pathWide = WindowsCoreFunctions::toWCharArray( path );
+	const auto result = SetNamedSecurityInfo( pathWide.data(), SE_FILE_OBJECT,
+											  DACL_SECURITY_INFORMATION | PROTECTED_DACL_SECURITY_INFORMATION,
+											  nullptr, nullptr, acl, nullptr );
+
+	LocalFree( acl );
+
+	if( result != ERROR_SUCCESS )
+	{
+		vCritical() << "SetNamedSecurityInfo() failed:" << result;
+		return false;
+	}
+
+	return true;
+}
+
+
+
 static QString windowsConfigPath( const KNOWNFOLDERID folderId )
 {
 	QString result;
@@ -70,6 +131,30 @@ QString WindowsFilesystemFunctions::globalTempPath() const
 
 
 
+QString WindowsFilesystemFunctions::privateHostDataPath()
+{
+	// the local (i.e. non-roaming) application data folder of the account running the process,
+	// which is located in the system profile for the service
+	const auto path = windowsConfigPath( FOLDERID_LocalAppData ) + QDir::separator() + QStringLiteral("Veyon") +
+					  QDir::separator() + QSysInfo::machineHostName();
+
+	if( QDir().mkpath( path ) == false )
+	{
+		vCritical() << "could not create directory" << path;
+		return {};
+	}
+
+	if( restrictAccessToCurrentUser( path ) == false )
+	{
+		vCritical() << "could not restrict access to directory" << path;
+		return {};
+	}
+
+	return path;
+}
+
+
+
 QString WindowsFilesystemFunctions::fileOwnerGroup( const QString& filePath )
 {
 	PSID ownerSID = nullptr;
@@ -32,6 +32,8 @@
 #include <ws2ipdef.h>
 #include <ws2tcpip.h>
 
+#include <array>
+
 #include <QHostAddress>
 #include <QProcess>
 
@@ -463,3 +465,34 @@ bool WindowsNetworkFunctions::pingViaUtility( const QString& hostAddress )
 
 	return pingProcess.exitCode() == 0;
 }
+
+
+
+qint64 WindowsNetworkFunctions::writeGathered( Socket socket, const QVector<QByteArray>& buffers, int firstBuffer, qint64 offset )
+{
+	static constexpr auto MaxBufferCount = 1024;
+
+	std::array<WSABUF, MaxBufferCount> wsaBuffers{};
+	DWORD bufferCount = 0;
+
+	for( int i = firstBuffer; i < buffers.size() && bufferCount < wsaBuffers.size(); ++i )
+	{
+		const auto bufferOffset = i == firstBuffer ? offset : 0;
+		wsaBuffers[bufferCount].buf = const_cast<char *>( buffers[i].constData() + bufferOffset );
+		wsaBuffers[bufferCount].len = static_cast<ULONG>( buffers[i].size() - bufferOffset );
+		++bufferCount;
+	}
+
+	if( bufferCount == 0 )
+	{
+		return 0;
+	}
+
+	DWORD bytesSent = 0;
+	if( WSASend( socket, wsaBuffers.data(), bufferCount, &bytesSent, 0, nullptr, nullptr ) != 0 )
+	{
+		return WSAGetLastError() == WSAEWOULDBLOCK ? 0 : -1;
+	}
+
+	return bytesSent;
+}
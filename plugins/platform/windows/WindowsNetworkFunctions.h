@@ -40,6 +40,8 @@ public:
 
 	bool configureSocketKeepalive( Socket socket, bool enabled, int idleTime, int interval, int probes ) override;
 
+	qint64 writeGathered( Socket socket, const QVector<QByteArray>& buffers, int firstBuffer, qint64 offset ) override;
+
 	static constexpr auto WindowsFirewallServiceError = HRESULT(0x800706D9);
 
 private:
@@ -101,3 +101,16 @@ void ComputerControlClient::setMinimumFramebufferUpdateInterval(int interval)
 {
 	m_minimumFramebufferUpdateInterval = interval;
 }
+
+
+
+void ComputerControlClient::setFramebufferScale(int scale)
+{
+	// let the VNC server scale down the framebuffer before encoding it - it
+	// announces the new framebuffer size to the client via NewFBSize
+	if (m_clientProtocol.state() == VncClientProtocol::State::Running &&
+		m_clientProtocol.setScale(scale) == false)
+	{
+		vWarning() << "failed to set framebuffer scale" << scale;
+	}
+}
@@ -54,6 +54,7 @@ public:
 	}
 
 	void setMinimumFramebufferUpdateInterval(int interval);
+	void setFramebufferScale(int scale);
 
 protected:
 	VncClientProtocol& clientProtocol() override
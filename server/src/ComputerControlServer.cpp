@@ -33,6 +33,7 @@
 #include "HostAddress.h"
 #include "VeyonConfiguration.h"
 #include "SystemTrayIcon.h"
+#include "Tracer.h"
 
 
 ComputerControlServer::ComputerControlServer( QObject* parent ) :
@@ -106,6 +107,8 @@ VncProxyConnection* ComputerControlServer::createVncProxyConnection( QTcpSocket*
 
 bool ComputerControlServer::handleFeatureMessage(ComputerControlClient* client)
 {
+	Tracer::Scope traceScope( Tracer::Event::ComputerControlServerHandleFeatureMessage );
+
 	auto socket = client->proxyClientSocket();
 
 	char messageType;
@@ -128,6 +131,8 @@ bool ComputerControlServer::handleFeatureMessage(ComputerControlClient* client)
 		return false;
 	}
 
+	traceScope.setEndArguments( featureMessage.featureUid().data1, featureMessage.command() );
+
 	VeyonCore::featureManager().handleFeatureMessage( *this, MessageContext{socket, client}, featureMessage );
 
 	return true;
@@ -163,6 +168,17 @@ void ComputerControlServer::setMinimumFramebufferUpdateInterval(const MessageCon
 
 
 
+void ComputerControlServer::setFramebufferScale(const MessageContext& context, int scale)
+{
+	auto client = qobject_cast<ComputerControlClient *>(context.connection());
+	if (client)
+	{
+		client->setFramebufferScale(scale);
+	}
+}
+
+
+
 void ComputerControlServer::checkForIncompleteAuthentication( VncServerClient* client )
 {
 	// connection to client closed during authentication?
@@ -77,6 +77,8 @@ public:
 
 	void setMinimumFramebufferUpdateInterval(const MessageContext& context, int interval) override;
 
+	void setFramebufferScale(const MessageContext& context, int scale) override;
+
 private:
 	void checkForIncompleteAuthentication( VncServerClient* client );
 	void showAuthenticationMessage( VncServerClient* client );
@@ -23,7 +23,6 @@
  */
 
 #include "ServerAccessControlManager.h"
-#include "AccessControlProvider.h"
 #include "AuthenticationManager.h"
 #include "DesktopAccessDialog.h"
 #include "VeyonConfiguration.h"
@@ -36,6 +35,9 @@ ServerAccessControlManager::ServerAccessControlManager( FeatureWorkerManager& fe
 	m_featureWorkerManager( featureWorkerManager ),
 	m_desktopAccessDialog( desktopAccessDialog )
 {
+	connect( &VeyonCore::config(), &VeyonConfiguration::configurationChanged, this, [this]() {
+		m_accessControlProvider = AccessControlProvider();
+	} );
 }
 
 
@@ -71,6 +73,11 @@ void ServerAccessControlManager::removeClient( VncServerClient* client )
 {
 	m_clients.removeAll( client );
 
+	if( m_accessControlProvider.dependsOnConnectedUsers() == false )
+	{
+		return;
+	}
+
 	// force all remaining clients to pass access control again as conditions might
 	// have changed (e.g. AccessControlRule::Condition::AccessFromAlreadyConnectedUser)
 
@@ -114,7 +121,7 @@ void ServerAccessControlManager::performAccessControl( VncServerClient* client )
 	}
 
 	const auto accessResult =
-			AccessControlProvider().checkAccess( client->username(),
+			m_accessControlProvider.checkAccess( client->username(),
 												 client->hostAddress(),
 												 connectedUsers(),
 												 client->authMethodUid() );
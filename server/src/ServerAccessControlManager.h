@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include "AccessControlProvider.h"
 #include "DesktopAccessDialog.h"
 #include "VncServerClient.h"
 
@@ -56,6 +57,9 @@ private:
 	FeatureWorkerManager& m_featureWorkerManager;
 	DesktopAccessDialog& m_desktopAccessDialog;
 
+	// rules are parsed once and recreated whenever the configuration changes
+	AccessControlProvider m_accessControlProvider{};
+
 	VncServerClientList m_clients{};
 
 	using HostUserPair = QPair<QString, QString>;
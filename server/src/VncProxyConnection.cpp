@@ -240,12 +240,6 @@ bool VncProxyConnection::receiveClientMessage()
 
 bool VncProxyConnection::receiveServerMessage()
 {
-	if( clientProtocol().receiveMessage() )
-	{
-		m_proxyClientSocket->write( clientProtocol().lastMessage() );
-
-		return true;
-	}
-
-	return false;
+	// pass through complete messages without copying them individually
+	return clientProtocol().forwardMessages( m_proxyClientSocket ) > 0;
 }
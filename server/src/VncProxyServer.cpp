@@ -38,7 +38,7 @@ VncProxyServer::VncProxyServer( const QHostAddress& listenAddress,
 	QObject( parent ),
 	m_listenAddress( listenAddress ),
 	m_listenPort( listenPort ),
-	m_server( new TlsServer( VeyonCore::TlsConfiguration::defaultConfiguration(), this ) ),
+	m_server( new TlsServer( VeyonCore::tlsConfiguration(), this ) ),
 	m_connectionFactory( connectionFactory )
 {
 	connect( m_server, &QTcpServer::newConnection, this, &VncProxyServer::acceptConnection );
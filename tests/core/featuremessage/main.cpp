@@ -0,0 +1,255 @@
+/*
+ * main.cpp - tests and benchmarks for FeatureMessage
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTest>
+
+#include "FeatureMessage.h"
+
+class FeatureMessageTest : public QObject
+{
+	Q_OBJECT
+public:
+	enum class Argument
+	{
+		Payload
+	};
+	Q_ENUM(Argument)
+
+private Q_SLOTS:
+	void initTestCase();
+	void cleanupTestCase();
+
+	void burst_data();
+	void burst();
+
+	void partialMessage();
+
+	void framing_data();
+	void framing();
+
+private:
+	static QByteArray serializedMessages(int messageCount, int payloadSize);
+
+	static const FeatureMessage::FeatureUid& featureUid()
+	{
+		static const FeatureMessage::FeatureUid uid{QStringLiteral("{5b4ae2b1-8ac6-4e4e-9df8-5d25e6e7f7c2}")};
+		return uid;
+	}
+
+	VeyonCore* m_core{nullptr};
+
+};
+
+
+
+void FeatureMessageTest::initTestCase()
+{
+	m_core = new VeyonCore(QCoreApplication::instance(), VeyonCore::Component::CLI, QStringLiteral("Test"));
+}
+
+
+
+void FeatureMessageTest::cleanupTestCase()
+{
+	delete m_core;
+}
+
+
+
+void FeatureMessageTest::burst_data()
+{
+	QTest::addColumn<int>("messageCount");
+	QTest::addColumn<int>("payloadSize");
+	QTest::addColumn<int>("chunkSize");
+
+	QTest::newRow("single write") << 1000 << 16 << 0;
+	QTest::newRow("64 KiB chunks") << 1000 << 16 << 64*1024;
+	QTest::newRow("odd chunks") << 1000 << 100 << 37;
+	QTest::newRow("large messages") << 100 << 100*1000 << 4096;
+	QTest::newRow("message rate") << 100000 << 16 << 0;
+}
+
+
+
+void FeatureMessageTest::burst()
+{
+	QFETCH(int, messageCount);
+	QFETCH(int, payloadSize);
+	QFETCH(int, chunkSize);
+
+	const auto serverName = QStringLiteral("VeyonFeatureMessageTest-%1").arg(QCoreApplication::applicationPid());
+
+	QLocalServer server;
+	QLocalServer::removeServer(serverName);
+	QVERIFY(server.listen(serverName));
+
+	QLocalSocket client;
+	client.connectToServer(serverName);
+	QVERIFY(client.waitForConnected());
+	QVERIFY(server.waitForNewConnection(5000));
+
+	auto socket = server.nextPendingConnection();
+	QVERIFY(socket != nullptr);
+
+	QVector<FeatureMessage::Command> commands;
+	commands.reserve(messageCount);
+	int invalidPayloadCount = 0;
+	bool valid = true;
+
+	connect(socket, &QLocalSocket::readyRead, this, [&]() {
+		valid &= FeatureMessage::receiveAll(socket, [&](const FeatureMessage& message) {
+			commands.append(message.command());
+			if (message.featureUid() != featureUid() ||
+				message.argument(Argument::Payload).toByteArray().size() != payloadSize)
+			{
+				++invalidPayloadCount;
+			}
+		});
+	});
+
+	const auto data = serializedMessages(messageCount, payloadSize);
+	if (chunkSize <= 0)
+	{
+		chunkSize = data.size();
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	// write messages back to back and let the receiver run in between like with bursty worker output
+	for (int offset = 0; offset < data.size(); offset += chunkSize)
+	{
+		client.write(data.constData() + offset, qMin(chunkSize, data.size() - offset));
+		client.flush();
+		QCoreApplication::processEvents();
+	}
+
+	// no more data arrives after the last write, so all messages have to be received without
+	// any further readyRead() being triggered by subsequent data
+	QTRY_COMPARE_WITH_TIMEOUT(commands.count(), messageCount, 30000);
+
+	qInfo() << messageCount << "messages received after" << timer.elapsed() << "ms";
+
+	QVERIFY(valid);
+	QCOMPARE(invalidPayloadCount, 0);
+	QCOMPARE(socket->bytesAvailable(), qint64(0));
+
+	for (int i = 0; i < commands.count(); ++i)
+	{
+		QCOMPARE(commands[i], i);
+	}
+}
+
+
+
+void FeatureMessageTest::partialMessage()
+{
+	const auto data = serializedMessages(3, 100);
+
+	QBuffer buffer;
+	buffer.open(QIODevice::ReadWrite);
+
+	// two complete messages followed by the first half of the third one
+	buffer.write(data.left(data.size() - 50));
+	buffer.seek(0);
+
+	int messageCount = 0;
+	const auto receive = [&]() {
+		return FeatureMessage::receiveAll(&buffer, [&](const FeatureMessage&) { ++messageCount; });
+	};
+
+	QVERIFY(receive());
+	QCOMPARE(messageCount, 2);
+	QCOMPARE(buffer.bytesAvailable(), qint64(data.size() / 3 - 50));
+
+	// incomplete message has to be received as soon as the remaining data has arrived
+	const auto pos = buffer.pos();
+	buffer.seek(buffer.size());
+	buffer.write(data.right(50));
+	buffer.seek(pos);
+
+	QVERIFY(receive());
+	QCOMPARE(messageCount, 3);
+	QCOMPARE(buffer.bytesAvailable(), qint64(0));
+}
+
+
+
+void FeatureMessageTest::framing_data()
+{
+	QTest::addColumn<int>("messageCount");
+	QTest::addColumn<int>("payloadSize");
+
+	QTest::newRow("1x16") << 1 << 16;
+	QTest::newRow("100x16") << 100 << 16;
+	QTest::newRow("10000x16") << 10000 << 16;
+	QTest::newRow("100x64KiB") << 100 << 64*1024;
+}
+
+
+
+void FeatureMessageTest::framing()
+{
+	QFETCH(int, messageCount);
+	QFETCH(int, payloadSize);
+
+	QBuffer buffer;
+	buffer.setData(serializedMessages(messageCount, payloadSize));
+	buffer.open(QIODevice::ReadOnly);
+
+	int receivedCount = 0;
+
+	QBENCHMARK {
+		buffer.seek(0);
+		receivedCount = 0;
+		FeatureMessage::receiveAll(&buffer, [&](const FeatureMessage&) { ++receivedCount; });
+	}
+
+	QCOMPARE(receivedCount, messageCount);
+}
+
+
+
+QByteArray FeatureMessageTest::serializedMessages(int messageCount, int payloadSize)
+{
+	QBuffer buffer;
+	buffer.open(QIODevice::WriteOnly);
+
+	for (int i = 0; i < messageCount; ++i)
+	{
+		FeatureMessage{featureUid(), i}
+			.addArgument(Argument::Payload, QByteArray(payloadSize, char(i)))
+			.send(&buffer);
+	}
+
+	return buffer.data();
+}
+
+
+QTEST_GUILESS_MAIN(FeatureMessageTest)
+#include "main.moc"
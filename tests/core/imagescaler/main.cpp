@@ -0,0 +1,363 @@
+/*
+ * main.cpp - tests and benchmarks for ImageScaler
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <cmath>
+
+#include <QRandomGenerator>
+#include <QTest>
+
+#include "ImageScaler.h"
+
+Q_DECLARE_METATYPE(ImageScaler::Implementation)
+
+class ImageScalerTest : public QObject
+{
+	Q_OBJECT
+private Q_SLOTS:
+	void matchesReference_data();
+	void matchesReference();
+
+	void partialUpdateMatchesFullScale_data();
+	void partialUpdateMatchesFullScale();
+
+	void benchmark_data();
+	void benchmark();
+
+	void benchmarkChangedFraction_data();
+	void benchmarkChangedFraction();
+
+private:
+	// same tile size as used by VncConnection for partial updates of the scaled framebuffer
+	static constexpr auto TileSize = 32;
+
+	static const QVector<std::pair<QSize, QSize>>& sizes();
+	static QByteArray sizeName(const std::pair<QSize, QSize>& size);
+
+	static QImage randomImage(QSize size, QImage::Format format);
+
+	// area average computed with floating point precision
+	static QImage referenceScaled(const QImage& image, QSize size);
+
+	static int maximumDifference(const QImage& a, const QImage& b);
+
+};
+
+
+
+const QVector<std::pair<QSize, QSize>>& ImageScalerTest::sizes()
+{
+	static const QVector<std::pair<QSize, QSize>> sizes{
+		{QSize(1, 1), QSize(1, 1)},
+		{QSize(17, 19), QSize(17, 19)},
+		{QSize(7, 5), QSize(3, 2)},
+		{QSize(640, 480), QSize(160, 120)},
+		{QSize(1001, 3), QSize(1000, 1)},
+		{QSize(333, 777), QSize(100, 13)},
+		{QSize(1920, 1080), QSize(427, 241)},
+		{QSize(5, 123), QSize(1, 37)},
+		{QSize(2000, 3), QSize(4, 1)},
+	};
+
+	return sizes;
+}
+
+
+
+QByteArray ImageScalerTest::sizeName(const std::pair<QSize, QSize>& size)
+{
+	return QStringLiteral("%1x%2->%3x%4").arg(size.first.width()).arg(size.first.height())
+			.arg(size.second.width()).arg(size.second.height()).toLatin1();
+}
+
+
+
+void ImageScalerTest::matchesReference_data()
+{
+	QTest::addColumn<ImageScaler::Implementation>("implementation");
+	QTest::addColumn<int>("format");
+	QTest::addColumn<QSize>("sourceSize");
+	QTest::addColumn<QSize>("targetSize");
+
+	for (const auto& implementation : {std::make_pair(ImageScaler::Implementation::Scalar, "Scalar"),
+									   std::make_pair(ImageScaler::Implementation::SSE2, "SSE2"),
+									   std::make_pair(ImageScaler::Implementation::AVX2, "AVX2"),
+									   std::make_pair(ImageScaler::Implementation::NEON, "NEON")})
+	{
+		for (const auto& format : {std::make_pair(QImage::Format_RGB32, "RGB32"),
+								   std::make_pair(QImage::Format_ARGB32_Premultiplied, "ARGB32PM")})
+		{
+			for (const auto& size : sizes())
+			{
+				QTest::newRow((QByteArray(implementation.second) + " " + format.second + " " + sizeName(size)).constData())
+					<< implementation.first << int(format.first) << size.first << size.second;
+			}
+		}
+	}
+}
+
+
+
+void ImageScalerTest::matchesReference()
+{
+	QFETCH(ImageScaler::Implementation, implementation);
+	QFETCH(int, format);
+	QFETCH(QSize, sourceSize);
+	QFETCH(QSize, targetSize);
+
+	if (ImageScaler::isAvailable(implementation) == false)
+	{
+		QSKIP("implementation not available on this platform");
+	}
+
+	const auto image = randomImage(sourceSize, QImage::Format(format));
+
+	QImage scaled(targetSize, image.format());
+	ImageScaler::scale(image, scaled, scaled.rect(), implementation);
+
+	QImage scalarScaled(targetSize, image.format());
+	ImageScaler::scale(image, scalarScaled, scalarScaled.rect(), ImageScaler::Implementation::Scalar);
+
+	// vectorized implementations have to be pixel-exact with the scalar one
+	QCOMPARE(maximumDifference(scaled, scalarScaled), 0);
+
+	// fixed point arithmetics may differ from exact area average by rounding only
+	QVERIFY(maximumDifference(scaled, referenceScaled(image, targetSize)) <= 1);
+}
+
+
+
+void ImageScalerTest::partialUpdateMatchesFullScale_data()
+{
+	QTest::addColumn<QSize>("sourceSize");
+	QTest::addColumn<QSize>("targetSize");
+
+	for (const auto& size : sizes())
+	{
+		QTest::newRow(sizeName(size).constData()) << size.first << size.second;
+	}
+}
+
+
+
+void ImageScalerTest::partialUpdateMatchesFullScale()
+{
+	QFETCH(QSize, sourceSize);
+	QFETCH(QSize, targetSize);
+
+	const auto image = randomImage(sourceSize, QImage::Format_RGB32);
+	const auto scaled = ImageScaler::scaled(image, targetSize);
+
+	QImage partiallyScaled(targetSize, QImage::Format_RGB32);
+	partiallyScaled.fill(Qt::black);
+
+	// update target in odd-sized tiles
+	for (int y = 0; y < targetSize.height(); y += 7)
+	{
+		for (int x = 0; x < targetSize.width(); x += 13)
+		{
+			ImageScaler::scale(image, partiallyScaled, QRect(x, y, 13, 7));
+		}
+	}
+
+	QCOMPARE(maximumDifference(partiallyScaled, scaled), 0);
+}
+
+
+
+void ImageScalerTest::benchmark_data()
+{
+	QTest::addColumn<int>("implementation");
+
+	QTest::newRow("Scalar") << int(ImageScaler::Implementation::Scalar);
+	QTest::newRow("SSE2") << int(ImageScaler::Implementation::SSE2);
+	QTest::newRow("AVX2") << int(ImageScaler::Implementation::AVX2);
+	QTest::newRow("NEON") << int(ImageScaler::Implementation::NEON);
+	QTest::newRow("QImage::scaled()") << -1;
+}
+
+
+
+void ImageScalerTest::benchmark()
+{
+	QFETCH(int, implementation);
+
+	const auto image = randomImage(QSize(1920, 1080), QImage::Format_RGB32);
+	QImage scaled(QSize(320, 180), image.format());
+
+	if (implementation >= 0 && ImageScaler::isAvailable(ImageScaler::Implementation(implementation)) == false)
+	{
+		QSKIP("implementation not available on this platform");
+	}
+
+	if (implementation < 0)
+	{
+		QBENCHMARK {
+			scaled = image.scaled(scaled.size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+		}
+	}
+	else
+	{
+		QBENCHMARK {
+			ImageScaler::scale(image, scaled, scaled.rect(), ImageScaler::Implementation(implementation));
+		}
+	}
+}
+
+
+
+void ImageScalerTest::benchmarkChangedFraction_data()
+{
+	QTest::addColumn<int>("changedPercentage");
+
+	for (const auto percentage : {1, 5, 10, 25, 50, 100})
+	{
+		QTest::addRow("%d%% changed", percentage) << percentage;
+	}
+}
+
+
+
+void ImageScalerTest::benchmarkChangedFraction()
+{
+	QFETCH(int, changedPercentage);
+
+	const auto image = randomImage(QSize(1920, 1080), QImage::Format_RGB32);
+	auto scaled = ImageScaler::scaled(image, QSize(480, 270));
+
+	// spread changed tiles evenly across the scaled framebuffer like
+	// VncConnection::rescaleFramebufferRegion() processes them
+	const auto columns = (scaled.width() + TileSize - 1) / TileSize;
+	const auto rows = (scaled.height() + TileSize - 1) / TileSize;
+	const auto tileCount = columns * rows;
+
+	QVector<QRect> tiles;
+	for (int i = 0; i < tileCount; ++i)
+	{
+		if ((i + 1) * changedPercentage / 100 > i * changedPercentage / 100)
+		{
+			tiles.append(QRect((i % columns) * TileSize, (i / columns) * TileSize, TileSize, TileSize)
+							 .intersected(scaled.rect()));
+		}
+	}
+
+	QVERIFY(tiles.isEmpty() == false);
+
+	QBENCHMARK {
+		for (const auto& tile : std::as_const(tiles))
+		{
+			ImageScaler::scale(image, scaled, tile);
+		}
+	}
+}
+
+
+
+QImage ImageScalerTest::randomImage(QSize size, QImage::Format format)
+{
+	QRandomGenerator generator(size.width() * 65536 + size.height());
+
+	QImage image(size, format);
+	for (int y = 0; y < image.height(); ++y)
+	{
+		auto line = reinterpret_cast<QRgb *>(image.scanLine(y));
+		for (int x = 0; x < image.width(); ++x)
+		{
+			const auto pixel = generator.generate();
+			line[x] = format == QImage::Format_RGB32 ? (pixel | 0xff000000) : pixel;
+		}
+	}
+
+	return image;
+}
+
+
+
+QImage ImageScalerTest::referenceScaled(const QImage& image, QSize size)
+{
+	QImage target(size, image.format());
+
+	const auto factorX = double(image.width()) / size.width();
+	const auto factorY = double(image.height()) / size.height();
+
+	for (int ty = 0; ty < size.height(); ++ty)
+	{
+		for (int tx = 0; tx < size.width(); ++tx)
+		{
+			double sum[4]{};
+
+			const auto beginX = tx * factorX;
+			const auto endX = (tx + 1) * factorX;
+			const auto beginY = ty * factorY;
+			const auto endY = (ty + 1) * factorY;
+
+			for (int y = int(beginY); y < qMin(int(std::ceil(endY)), image.height()); ++y)
+			{
+				const auto coverageY = qMin(double(y + 1), endY) - qMax(double(y), beginY);
+				const auto line = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+
+				for (int x = int(beginX); x < qMin(int(std::ceil(endX)), image.width()); ++x)
+				{
+					const auto coverage = coverageY * (qMin(double(x + 1), endX) - qMax(double(x), beginX));
+					const auto channels = reinterpret_cast<const uint8_t *>(line + x);
+					for (int c = 0; c < 4; ++c)
+					{
+						sum[c] += channels[c] * coverage;
+					}
+				}
+			}
+
+			auto channels = reinterpret_cast<uint8_t *>(reinterpret_cast<QRgb *>(target.scanLine(ty)) + tx);
+			for (int c = 0; c < 4; ++c)
+			{
+				channels[c] = uint8_t(qBound(0, qRound(sum[c] / (factorX * factorY)), 255));
+			}
+		}
+	}
+
+	return target;
+}
+
+
+
+int ImageScalerTest::maximumDifference(const QImage& a, const QImage& b)
+{
+	int difference = 0;
+
+	for (int y = 0; y < a.height(); ++y)
+	{
+		const auto lineA = reinterpret_cast<const uint8_t *>(a.constScanLine(y));
+		const auto lineB = reinterpret_cast<const uint8_t *>(b.constScanLine(y));
+
+		for (int i = 0; i < a.width() * 4; ++i)
+		{
+			difference = qMax(difference, qAbs(int(lineA[i]) - int(lineB[i])));
+		}
+	}
+
+	return difference;
+}
+
+
+QTEST_GUILESS_MAIN(ImageScalerTest)
+#include "main.moc"
@@ -0,0 +1,665 @@
+/*
+ * main.cpp - tests for LdapNetworkObjectDirectory using an in-process LDAP server
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QElapsedTimer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTest>
+#include <QThread>
+
+#include <atomic>
+
+#include "LdapConfiguration.h"
+#include "LdapNetworkObjectDirectory.h"
+
+// minimal BER encoding/decoding as required for the LDAP messages used by LdapClient
+namespace Ber
+{
+
+enum Tag : quint8
+{
+	Boolean = 0x01,
+	Integer = 0x02,
+	OctetString = 0x04,
+	Enumerated = 0x0a,
+	Sequence = 0x30,
+	Set = 0x31,
+	ContextControls = 0xa0,
+};
+
+static QByteArray encode(quint8 tag, const QByteArray& content)
+{
+	QByteArray data(1, char(tag));
+
+	if (content.size() < 0x80)
+	{
+		data.append(char(content.size()));
+	}
+	else
+	{
+		QByteArray length;
+		for (auto l = content.size(); l > 0; l >>= 8)
+		{
+			length.prepend(char(l & 0xff));
+		}
+		data.append(char(0x80 | length.size()));
+		data.append(length);
+	}
+
+	return data + content;
+}
+
+static QByteArray encodeInteger(qint64 value, quint8 tag = Integer)
+{
+	QByteArray content;
+	do
+	{
+		content.prepend(char(value & 0xff));
+		value >>= 8;
+	}
+	while (value > 0);
+
+	if (quint8(content[0]) & 0x80)
+	{
+		content.prepend('\0');
+	}
+
+	return encode(tag, content);
+}
+
+static QByteArray encodeString(const QString& value, quint8 tag = OctetString)
+{
+	return encode(tag, value.toUtf8());
+}
+
+static bool decode(const QByteArray& data, int& pos, quint8& tag, QByteArray& content)
+{
+	if (pos + 2 > data.size())
+	{
+		return false;
+	}
+
+	tag = quint8(data[pos]);
+
+	auto offset = pos + 1;
+	int length = quint8(data[offset++]);
+	if (length & 0x80)
+	{
+		const auto count = length & 0x7f;
+		if (count > 4 || offset + count > data.size())
+		{
+			return false;
+		}
+		length = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			length = (length << 8) | quint8(data[offset++]);
+		}
+	}
+
+	if (offset + length > data.size())
+	{
+		return false;
+	}
+
+	content = data.mid(offset, length);
+	pos = offset + length;
+
+	return true;
+}
+
+static qint64 toInteger(const QByteArray& content)
+{
+	qint64 value = content.isEmpty() ? 0 : qint8(content[0]);
+	for (int i = 1; i < content.size(); ++i)
+	{
+		value = (value << 8) | quint8(content[i]);
+	}
+	return value;
+}
+
+}
+
+
+
+// serves a static set of entries and supports simple bind, search with paged results (RFC 2696) and unbind
+class FakeLdapServer : public QObject
+{
+	Q_OBJECT
+public:
+	struct Attribute
+	{
+		QString name;
+		QStringList values;
+	};
+
+	struct Entry
+	{
+		QString dn;
+		QString normalizedDn;
+		QString normalizedParentDn;
+		QVector<Attribute> attributes;
+	};
+
+	explicit FakeLdapServer(const QVector<Entry>& entries) :
+		m_entries(entries)
+	{
+	}
+
+	Q_INVOKABLE int listen()
+	{
+		auto server = new QTcpServer(this);
+		if (server->listen(QHostAddress::LocalHost) == false)
+		{
+			return -1;
+		}
+
+		connect(server, &QTcpServer::newConnection, this, [this, server]() {
+			while (server->hasPendingConnections())
+			{
+				auto socket = server->nextPendingConnection();
+				connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { processData(socket); });
+				connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+				connect(socket, &QObject::destroyed, this, [this, socket]() { m_connections.remove(socket); });
+			}
+		});
+
+		return server->serverPort();
+	}
+
+	int pageCount() const
+	{
+		return m_pageCount;
+	}
+
+	static Entry entry(const QString& dn, const QVector<Attribute>& attributes)
+	{
+		const auto normalizedDn = dn.toLower();
+		return {dn, normalizedDn, normalizedDn.mid(normalizedDn.indexOf(QLatin1Char(',')) + 1), attributes};
+	}
+
+private:
+	static constexpr auto PagedResultsControlOid = "1.2.840.113556.1.4.319";
+
+	enum Operation : quint8
+	{
+		BindRequest = 0x60,
+		BindResponse = 0x61,
+		UnbindRequest = 0x42,
+		SearchRequest = 0x63,
+		SearchResultEntry = 0x64,
+		SearchResultDone = 0x65,
+	};
+
+	enum Filter : quint8
+	{
+		And = 0xa0,
+		Or = 0xa1,
+		Not = 0xa2,
+		EqualityMatch = 0xa3,
+		Present = 0x87,
+	};
+
+	struct Connection
+	{
+		QByteArray buffer;
+		QVector<int> pagedMatches;
+	};
+
+	void processData(QTcpSocket* socket)
+	{
+		auto& connection = m_connections[socket];
+		connection.buffer += socket->readAll();
+
+		int pos = 0;
+		quint8 tag;
+		QByteArray message;
+		while (Ber::decode(connection.buffer, pos, tag, message))
+		{
+			processMessage(socket, connection, message);
+			connection.buffer.remove(0, pos);
+			pos = 0;
+		}
+	}
+
+	void processMessage(QTcpSocket* socket, Connection& connection, const QByteArray& message)
+	{
+		int pos = 0;
+		quint8 tag;
+		QByteArray messageId;
+		QByteArray operation;
+		quint8 operationTag;
+		if (Ber::decode(message, pos, tag, messageId) == false ||
+			Ber::decode(message, pos, operationTag, operation) == false)
+		{
+			return;
+		}
+
+		int pageSize = 0;
+		QByteArray cookie;
+		QByteArray controls;
+		if (Ber::decode(message, pos, tag, controls) && tag == Ber::ContextControls)
+		{
+			parsePagedResultsControl(controls, pageSize, cookie);
+		}
+
+		const auto id = Ber::toInteger(messageId);
+
+		switch (operationTag)
+		{
+		case BindRequest:
+			socket->write(response(id, Ber::encode(BindResponse, result())));
+			break;
+		case SearchRequest:
+			search(socket, connection, id, operation, pageSize, cookie);
+			break;
+		case UnbindRequest:
+			socket->disconnectFromHost();
+			break;
+		default:
+			break;
+		}
+	}
+
+	void search(QTcpSocket* socket, Connection& connection, qint64 id, const QByteArray& request,
+				int pageSize, const QByteArray& cookie)
+	{
+		int pos = 0;
+		quint8 tag;
+		QByteArray base, scope, deref, sizeLimit, timeLimit, typesOnly, filter, attributeList;
+		quint8 filterTag;
+		if (Ber::decode(request, pos, tag, base) == false ||
+			Ber::decode(request, pos, tag, scope) == false ||
+			Ber::decode(request, pos, tag, deref) == false ||
+			Ber::decode(request, pos, tag, sizeLimit) == false ||
+			Ber::decode(request, pos, tag, timeLimit) == false ||
+			Ber::decode(request, pos, tag, typesOnly) == false ||
+			Ber::decode(request, pos, filterTag, filter) == false ||
+			Ber::decode(request, pos, tag, attributeList) == false)
+		{
+			return;
+		}
+
+		QStringList attributes;
+		QByteArray attribute;
+		for (int attributePos = 0; Ber::decode(attributeList, attributePos, tag, attribute); )
+		{
+			attributes.append(QString::fromUtf8(attribute));
+		}
+
+		QVector<int> matches;
+		if (cookie.isEmpty())
+		{
+			const auto normalizedBase = QString::fromUtf8(base).toLower();
+			const auto scopeValue = Ber::toInteger(scope);
+			for (int i = 0; i < m_entries.size(); ++i)
+			{
+				if (isInScope(m_entries[i], normalizedBase, scopeValue) && matchesFilter(m_entries[i], filterTag, filter))
+				{
+					matches.append(i);
+				}
+			}
+			connection.pagedMatches = matches;
+		}
+		else
+		{
+			matches = connection.pagedMatches;
+		}
+
+		const auto begin = cookie.isEmpty() ? 0 : cookie.toInt();
+		const auto end = pageSize > 0 ? qMin(begin + pageSize, matches.size()) : matches.size();
+
+		QByteArray data;
+		for (int i = begin; i < end; ++i)
+		{
+			data += response(id, searchResultEntry(m_entries[matches[i]], attributes));
+		}
+
+		QByteArray responseControls;
+		if (pageSize > 0)
+		{
+			const auto nextCookie = end < matches.size() ? QByteArray::number(end) : QByteArray();
+			responseControls = Ber::encode(Ber::ContextControls, Ber::encode(Ber::Sequence,
+				Ber::encode(Ber::OctetString, PagedResultsControlOid) +
+				Ber::encode(Ber::OctetString, Ber::encode(Ber::Sequence, Ber::encodeInteger(0) +
+																		 Ber::encode(Ber::OctetString, nextCookie)))));
+			++m_pageCount;
+		}
+
+		data += response(id, Ber::encode(SearchResultDone, result()), responseControls);
+
+		socket->write(data);
+	}
+
+	static void parsePagedResultsControl(const QByteArray& controls, int& pageSize, QByteArray& cookie)
+	{
+		int pos = 0;
+		quint8 tag;
+		QByteArray control;
+		while (Ber::decode(controls, pos, tag, control))
+		{
+			int controlPos = 0;
+			QByteArray oid;
+			QByteArray value;
+			if (Ber::decode(control, controlPos, tag, oid) == false || oid != PagedResultsControlOid)
+			{
+				continue;
+			}
+
+			// skip optional criticality
+			if (Ber::decode(control, controlPos, tag, value) && tag == Ber::Boolean)
+			{
+				Ber::decode(control, controlPos, tag, value);
+			}
+
+			int valuePos = 0;
+			QByteArray sequence, size;
+			if (Ber::decode(value, valuePos, tag, sequence))
+			{
+				int sequencePos = 0;
+				Ber::decode(sequence, sequencePos, tag, size);
+				Ber::decode(sequence, sequencePos, tag, cookie);
+				pageSize = int(Ber::toInteger(size));
+			}
+		}
+	}
+
+	static bool isInScope(const Entry& entry, const QString& normalizedBase, qint64 scope)
+	{
+		switch (scope)
+		{
+		case 0: return entry.normalizedDn == normalizedBase;
+		case 1: return entry.normalizedParentDn == normalizedBase && entry.normalizedDn != normalizedBase;
+		default: break;
+		}
+
+		return entry.normalizedDn == normalizedBase ||
+			   entry.normalizedDn.endsWith(QLatin1Char(',') + normalizedBase);
+	}
+
+	static const Attribute* findAttribute(const Entry& entry, const QString& name)
+	{
+		for (const auto& attribute : entry.attributes)
+		{
+			if (attribute.name.compare(name, Qt::CaseInsensitive) == 0)
+			{
+				return &attribute;
+			}
+		}
+
+		return nullptr;
+	}
+
+	static bool matchesFilter(const Entry& entry, quint8 filterTag, const QByteArray& filter)
+	{
+		int pos = 0;
+		quint8 tag;
+		QByteArray content;
+
+		switch (filterTag)
+		{
+		case And:
+			while (Ber::decode(filter, pos, tag, content))
+			{
+				if (matchesFilter(entry, tag, content) == false)
+				{
+					return false;
+				}
+			}
+			return true;
+		case Or:
+			while (Ber::decode(filter, pos, tag, content))
+			{
+				if (matchesFilter(entry, tag, content))
+				{
+					return true;
+				}
+			}
+			return false;
+		case Not:
+			return Ber::decode(filter, pos, tag, content) && matchesFilter(entry, tag, content) == false;
+		case EqualityMatch:
+		{
+			QByteArray name, value;
+			Ber::decode(filter, pos, tag, name);
+			Ber::decode(filter, pos, tag, value);
+			const auto attribute = findAttribute(entry, QString::fromUtf8(name));
+			return attribute && attribute->values.contains(QString::fromUtf8(value), Qt::CaseInsensitive);
+		}
+		case Present:
+			return findAttribute(entry, QString::fromUtf8(filter)) != nullptr;
+		default:
+			break;
+		}
+
+		return false;
+	}
+
+	static QByteArray searchResultEntry(const Entry& entry, const QStringList& requestedAttributes)
+	{
+		const auto allAttributes = requestedAttributes.isEmpty() || requestedAttributes.contains(QStringLiteral("*"));
+
+		QByteArray attributes;
+		for (const auto& attribute : entry.attributes)
+		{
+			if (allAttributes || requestedAttributes.contains(attribute.name, Qt::CaseInsensitive))
+			{
+				QByteArray values;
+				for (const auto& value : attribute.values)
+				{
+					values += Ber::encodeString(value);
+				}
+				attributes += Ber::encode(Ber::Sequence, Ber::encodeString(attribute.name) + Ber::encode(Ber::Set, values));
+			}
+		}
+
+		return Ber::encode(SearchResultEntry, Ber::encodeString(entry.dn) + Ber::encode(Ber::Sequence, attributes));
+	}
+
+	static QByteArray result()
+	{
+		return Ber::encodeInteger(0, Ber::Enumerated) + Ber::encode(Ber::OctetString, {}) + Ber::encode(Ber::OctetString, {});
+	}
+
+	static QByteArray response(qint64 id, const QByteArray& operation, const QByteArray& controls = {})
+	{
+		return Ber::encode(Ber::Sequence, Ber::encodeInteger(id) + operation + controls);
+	}
+
+	const QVector<Entry> m_entries;
+	QHash<QTcpSocket*, Connection> m_connections;
+	std::atomic<int> m_pageCount{0};
+
+};
+
+
+
+class LdapNetworkObjectDirectoryTest : public QObject
+{
+	Q_OBJECT
+private Q_SLOTS:
+	void initTestCase();
+	void cleanupTestCase();
+
+	void timeToFirstHost_data();
+	void timeToFirstHost();
+
+private:
+	static constexpr auto LocationCount = 500;
+	static constexpr auto ComputersPerLocation = 100;
+
+	static QString baseDn()
+	{
+		return QStringLiteral("dc=example,dc=org");
+	}
+
+	VeyonCore* m_core{nullptr};
+	QThread m_serverThread;
+	FakeLdapServer* m_server{nullptr};
+	int m_serverPort{-1};
+
+};
+
+
+
+void LdapNetworkObjectDirectoryTest::initTestCase()
+{
+	m_core = new VeyonCore(QCoreApplication::instance(), VeyonCore::Component::CLI, QStringLiteral("Test"));
+
+	const auto objectClass = QStringLiteral("objectClass");
+	const auto organizationalUnit = QStringLiteral("organizationalUnit");
+	const auto computersDn = QStringLiteral("ou=computers,") + baseDn();
+
+	QVector<FakeLdapServer::Entry> entries;
+	entries.reserve(2 + LocationCount * (ComputersPerLocation + 1));
+	entries.append(FakeLdapServer::entry(baseDn(), {{objectClass, {QStringLiteral("dcObject")}}}));
+	entries.append(FakeLdapServer::entry(computersDn, {{objectClass, {organizationalUnit}},
+													   {QStringLiteral("ou"), {QStringLiteral("computers")}}}));
+
+	for (int l = 0; l < LocationCount; ++l)
+	{
+		const auto location = QStringLiteral("Room %1").arg(l);
+		const auto locationDn = QStringLiteral("ou=%1,%2").arg(location, computersDn);
+		entries.append(FakeLdapServer::entry(locationDn, {{objectClass, {organizationalUnit}},
+														  {QStringLiteral("ou"), {location}}}));
+
+		for (int c = 0; c < ComputersPerLocation; ++c)
+		{
+			const auto name = QStringLiteral("PC-%1-%2").arg(l).arg(c);
+			entries.append(FakeLdapServer::entry(QStringLiteral("cn=%1,%2").arg(name, locationDn),
+												 {{objectClass, {QStringLiteral("computer")}},
+												  {QStringLiteral("cn"), {name}},
+												  {QStringLiteral("dNSHostName"), {name.toLower() + QStringLiteral(".example.org")}}}));
+		}
+	}
+
+	m_server = new FakeLdapServer(entries);
+	m_server->moveToThread(&m_serverThread);
+	connect(&m_serverThread, &QThread::finished, m_server, &QObject::deleteLater);
+	m_serverThread.start();
+
+	QMetaObject::invokeMethod(m_server, "listen", Qt::BlockingQueuedConnection, Q_RETURN_ARG(int, m_serverPort));
+	QVERIFY(m_serverPort > 0);
+}
+
+
+
+void LdapNetworkObjectDirectoryTest::cleanupTestCase()
+{
+	m_serverThread.quit();
+	m_serverThread.wait();
+
+	delete m_core;
+}
+
+
+
+void LdapNetworkObjectDirectoryTest::timeToFirstHost_data()
+{
+	QTest::addColumn<int>("pageSize");
+
+	QTest::newRow("paged") << 1000;
+	QTest::newRow("unpaged") << 0;
+}
+
+
+
+void LdapNetworkObjectDirectoryTest::timeToFirstHost()
+{
+	QFETCH(int, pageSize);
+
+	LdapConfiguration configuration(&VeyonCore::config());
+	configuration.setServerHost(QStringLiteral("127.0.0.1"));
+	configuration.setServerPort(m_serverPort);
+	configuration.setBaseDn(baseDn());
+	configuration.setComputerTree(QStringLiteral("ou=computers"));
+	configuration.setComputerLocationsByContainer(true);
+	configuration.setLocationNameAttribute(QStringLiteral("ou"));
+	configuration.setComputerContainersFilter(QStringLiteral("(objectClass=organizationalUnit)"));
+	configuration.setComputersFilter(QStringLiteral("(objectClass=computer)"));
+	configuration.setComputerHostNameAttribute(QStringLiteral("dNSHostName"));
+	configuration.setQueryPageSize(pageSize);
+	configuration.setQueryTimeout(30000);
+
+	LdapNetworkObjectDirectory directory(configuration, nullptr);
+
+	QElapsedTimer timer;
+	qint64 firstHostTime = -1;
+	int removedCount = 0;
+
+	connect(&directory, &NetworkObjectDirectory::objectsAboutToBeInserted, this,
+			[&](NetworkObject::ModelId parentId, int index, int count) {
+		Q_UNUSED(index)
+		Q_UNUSED(count)
+		if (firstHostTime < 0 && parentId != directory.rootId())
+		{
+			firstHostTime = timer.elapsed();
+		}
+	});
+	connect(&directory, &NetworkObjectDirectory::objectsAboutToBeRemoved, this,
+			[&](NetworkObject::ModelId parentId, int index, int count) {
+		Q_UNUSED(parentId)
+		Q_UNUSED(index)
+		removedCount += count;
+	});
+
+	const auto pageCount = m_server->pageCount();
+
+	timer.start();
+	static_cast<NetworkObjectDirectory&>(directory).update();
+	const auto totalTime = timer.elapsed();
+
+	qInfo() << "first host after" << firstHostTime << "ms, all" << LocationCount * ComputersPerLocation
+			<< "hosts after" << totalTime << "ms";
+
+	const auto countHosts = [&directory]() {
+		int hostCount = 0;
+		for (int i = 0; i < directory.childCount(directory.rootId()); ++i)
+		{
+			hostCount += directory.childCount(directory.childId(directory.rootId(), i));
+		}
+		return hostCount;
+	};
+
+	QCOMPARE(directory.childCount(directory.rootId()), LocationCount);
+	QCOMPARE(countHosts(), LocationCount * ComputersPerLocation);
+	QVERIFY(firstHostTime >= 0);
+
+	if (pageSize > 0)
+	{
+		// computers have to be passed on with the first page instead of after the whole directory has been queried
+		QVERIFY(m_server->pageCount() - pageCount >= LocationCount * ComputersPerLocation / pageSize);
+		QVERIFY(firstHostTime < totalTime / 2);
+	}
+
+	// updating again must not remove any hosts even though the computers of a location arrive in several parts
+	static_cast<NetworkObjectDirectory&>(directory).update();
+
+	QCOMPARE(removedCount, 0);
+	QCOMPARE(countHosts(), LocationCount * ComputersPerLocation);
+}
+
+
+QTEST_GUILESS_MAIN(LdapNetworkObjectDirectoryTest)
+#include "main.moc"
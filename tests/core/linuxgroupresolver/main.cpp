@@ -0,0 +1,140 @@
+/*
+ * main.cpp - benchmarks for LinuxGroupResolver
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QTest>
+
+#include "LinuxGroupResolver.h"
+#include "VeyonCore.h"
+
+#include <pwd.h>
+#include <unistd.h>
+
+class LinuxGroupResolverTest : public QObject
+{
+	Q_OBJECT
+private Q_SLOTS:
+	void initTestCase();
+	void cleanupTestCase();
+
+	void groupsOfUser_data();
+	void groupsOfUser();
+
+	void groups_data();
+	void groups();
+
+private:
+	static void addCacheRows();
+
+	VeyonCore* m_core{nullptr};
+	QString m_username;
+
+};
+
+
+
+void LinuxGroupResolverTest::initTestCase()
+{
+	m_core = new VeyonCore(QCoreApplication::instance(), VeyonCore::Component::CLI, QStringLiteral("Test"));
+
+	const auto passwdEntry = getpwuid(getuid());
+	QVERIFY(passwdEntry != nullptr);
+
+	m_username = QString::fromUtf8(passwdEntry->pw_name);
+}
+
+
+
+void LinuxGroupResolverTest::cleanupTestCase()
+{
+	delete m_core;
+}
+
+
+
+void LinuxGroupResolverTest::groupsOfUser_data()
+{
+	addCacheRows();
+}
+
+
+
+void LinuxGroupResolverTest::groupsOfUser()
+{
+	QFETCH(bool, cached);
+
+	LinuxGroupResolver resolver;
+
+	const auto groups = resolver.groupsOfUser(m_username);
+
+	// time of a single access check resolving the groups of the current user through NSS
+	QBENCHMARK {
+		if (cached == false)
+		{
+			resolver.invalidate();
+		}
+		QCOMPARE(resolver.groupsOfUser(m_username), groups);
+	}
+}
+
+
+
+void LinuxGroupResolverTest::groups_data()
+{
+	addCacheRows();
+}
+
+
+
+void LinuxGroupResolverTest::groups()
+{
+	QFETCH(bool, cached);
+
+	LinuxGroupResolver resolver;
+
+	const auto groups = resolver.groups();
+	QVERIFY(groups.isEmpty() == false);
+
+	// time of enumerating all groups e.g. for populating the access control pages
+	QBENCHMARK {
+		if (cached == false)
+		{
+			resolver.invalidate();
+		}
+		QCOMPARE(resolver.groups().size(), groups.size());
+	}
+}
+
+
+
+void LinuxGroupResolverTest::addCacheRows()
+{
+	QTest::addColumn<bool>("cached");
+
+	QTest::newRow("uncached") << false;
+	QTest::newRow("cached") << true;
+}
+
+
+QTEST_GUILESS_MAIN(LinuxGroupResolverTest)
+#include "main.moc"
@@ -0,0 +1,196 @@
+/*
+ * main.cpp - benchmarks for Logger
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QThread>
+
+#include "Filesystem.h"
+#include "Logger.h"
+#include "VeyonConfiguration.h"
+
+class LoggerTest : public QObject
+{
+	Q_OBJECT
+private Q_SLOTS:
+	void initTestCase();
+	void cleanupTestCase();
+
+	void callerLatency_data();
+	void callerLatency();
+
+	void throughput_data();
+	void throughput();
+
+private:
+	static constexpr auto WriteTimeout = 60000;
+
+	static void addLogLevelRows();
+	static void log(Logger::LogLevel logLevel, int counter);
+
+	QTemporaryDir m_configDirectory;
+	QTemporaryDir m_logDirectory;
+	QString m_logFilePath;
+	VeyonCore* m_core{nullptr};
+
+};
+
+
+
+void LoggerTest::initTestCase()
+{
+	QVERIFY(m_configDirectory.isValid());
+	QVERIFY(m_logDirectory.isValid());
+
+	qputenv(Logger::logLevelEnvironmentVariable(), "debug");
+
+#ifndef Q_OS_WIN
+	// log into a temporary directory and keep benchmark messages off stderr
+	QSettings::setPath(QSettings::NativeFormat, QSettings::SystemScope, m_configDirectory.path());
+	{
+		QSettings settings(QSettings::NativeFormat, QSettings::SystemScope,
+						   QCoreApplication::organizationName(), QCoreApplication::applicationName());
+		settings.setValue(QStringLiteral("Logging/LogToStdErr"), false);
+		settings.setValue(QStringLiteral("Logging/LogFileDirectory"), m_logDirectory.path());
+	}
+#endif
+
+	m_core = new VeyonCore(QCoreApplication::instance(), VeyonCore::Component::CLI, QStringLiteral("Test"));
+
+	QVERIFY(VeyonCore::isDebugging());
+
+	m_logFilePath = VeyonCore::filesystem().expandPath(VeyonCore::config().logFileDirectory()) +
+					QDir::separator() + QStringLiteral("VeyonTest.log");
+	QVERIFY(QFile::exists(m_logFilePath));
+}
+
+
+
+void LoggerTest::cleanupTestCase()
+{
+	delete m_core;
+
+	qunsetenv(Logger::logLevelEnvironmentVariable());
+}
+
+
+
+void LoggerTest::callerLatency_data()
+{
+	addLogLevelRows();
+}
+
+
+
+void LoggerTest::callerLatency()
+{
+	QFETCH(Logger::LogLevel, logLevel);
+
+	int counter = 0;
+
+	// time spent in the logging thread only while the writer thread formats and writes in the background
+	QBENCHMARK {
+		log(logLevel, counter++);
+	}
+}
+
+
+
+void LoggerTest::throughput_data()
+{
+	addLogLevelRows();
+}
+
+
+
+void LoggerTest::throughput()
+{
+	QFETCH(Logger::LogLevel, logLevel);
+
+	static constexpr auto LineCount = 100000;
+
+	QFile logFile(m_logFilePath);
+	QVERIFY(logFile.open(QFile::ReadOnly | QFile::Unbuffered));
+	QVERIFY(logFile.seek(logFile.size()));
+
+	int lineCount = 0;
+
+	// total time until all lines have been written to the log file,
+	// i.e. lines per second = LineCount / measured time
+	QBENCHMARK_ONCE {
+		for (int i = 0; i < LineCount; ++i)
+		{
+			log(logLevel, i);
+		}
+
+		QElapsedTimer timer;
+		timer.start();
+		while (lineCount < LineCount && timer.elapsed() < WriteTimeout)
+		{
+			const auto data = logFile.readAll();
+			if (data.isEmpty())
+			{
+				QThread::msleep(1);
+			}
+			lineCount += data.count('\n');
+		}
+	}
+
+	QVERIFY(lineCount >= LineCount);
+}
+
+
+
+void LoggerTest::addLogLevelRows()
+{
+	QTest::addColumn<Logger::LogLevel>("logLevel");
+
+	QTest::newRow("debug") << Logger::LogLevel::Debug;
+	QTest::newRow("info") << Logger::LogLevel::Info;
+	QTest::newRow("warning") << Logger::LogLevel::Warning;
+	QTest::newRow("error") << Logger::LogLevel::Error;
+}
+
+
+
+void LoggerTest::log(Logger::LogLevel logLevel, int counter)
+{
+	// use different messages as repeated messages are collapsed
+	switch (logLevel)
+	{
+	case Logger::LogLevel::Debug: vDebug() << "benchmark message" << counter; break;
+	case Logger::LogLevel::Info: vInfo() << "benchmark message" << counter; break;
+	case Logger::LogLevel::Warning: vWarning() << "benchmark message" << counter; break;
+	case Logger::LogLevel::Error: vCritical() << "benchmark message" << counter; break;
+	default: break;
+	}
+}
+
+
+QTEST_GUILESS_MAIN(LoggerTest)
+#include "main.moc"
@@ -0,0 +1,494 @@
+/*
+ * main.cpp - tests and benchmarks for NetworkObjectDirectory
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "NetworkObjectDirectory.h"
+
+class TestDirectory : public NetworkObjectDirectory
+{
+	Q_OBJECT
+public:
+	TestDirectory() :
+		NetworkObjectDirectory(QStringLiteral("Test"), nullptr)
+	{
+	}
+
+	using NetworkObjectDirectory::replaceObjects;
+
+	void update() override
+	{
+	}
+
+	NetworkObject addLocation(const QString& name)
+	{
+		const NetworkObject location{this, NetworkObject::Type::Location, name, {}, {}, rootObject().uid()};
+		addOrUpdateObject(location, rootObject());
+		return location;
+	}
+
+	void addComputer(const NetworkObject& location, const QString& name, const QString& hostAddress,
+					 NetworkObject::Uid uid = {})
+	{
+		addOrUpdateObject(NetworkObject{this, NetworkObject::Type::Host, name,
+										{{NetworkObject::propertyKey(NetworkObject::Property::HostAddress), hostAddress}},
+										uid, location.uid()},
+						  location);
+	}
+
+	void populate(int locationCount, int computerCount)
+	{
+		for (int l = 0; l < locationCount; ++l)
+		{
+			const auto location = addLocation(QStringLiteral("Location %1").arg(l));
+			for (int c = 0; c < computerCount; ++c)
+			{
+				addComputer(location, QStringLiteral("Computer %1").arg(c), hostAddress(l, c));
+			}
+		}
+	}
+
+	static QString hostAddress(int location, int computer)
+	{
+		return QStringLiteral("10.%1.%2.%3").arg(location / 256).arg(location % 256).arg(computer);
+	}
+
+};
+
+
+class NetworkObjectDirectoryTest : public QObject
+{
+	Q_OBJECT
+private Q_SLOTS:
+	void initTestCase();
+	void cleanupTestCase();
+
+	void objectInMultipleLocations();
+	void snapshotRoundTrip();
+
+	void populate_data();
+	void populate();
+	void loadSnapshot_data();
+	void loadSnapshot();
+
+	void lookup_data();
+	void lookupObject_data();
+	void lookupObject();
+	void lookupChildObjects_data();
+	void lookupChildObjects();
+	void lookupObjectIndex_data();
+	void lookupObjectIndex();
+	void lookupParent_data();
+	void lookupParent();
+	void lookupHostAddress_data();
+	void lookupHostAddress();
+
+private:
+	using ObjectKeys = QVector<QPair<NetworkObject::ModelId, NetworkObject::ModelId>>;
+
+	static QString snapshotFileName(const QTemporaryDir& dir);
+	static ObjectKeys sampleObjectKeys(const TestDirectory& directory, int count);
+
+	static constexpr auto LookupSampleCount = 1000;
+
+	static constexpr auto Etag = "test";
+
+	VeyonCore* m_core{nullptr};
+
+};
+
+
+
+void NetworkObjectDirectoryTest::initTestCase()
+{
+	m_core = new VeyonCore(QCoreApplication::instance(), VeyonCore::Component::CLI, QStringLiteral("Test"));
+}
+
+
+
+void NetworkObjectDirectoryTest::cleanupTestCase()
+{
+	delete m_core;
+}
+
+
+
+void NetworkObjectDirectoryTest::objectInMultipleLocations()
+{
+	TestDirectory directory;
+
+	const auto location1 = directory.addLocation(QStringLiteral("Location 1"));
+	const auto location2 = directory.addLocation(QStringLiteral("Location 2"));
+
+	// same object (e.g. same LDAP DN) referenced by two locations
+	const auto uid = QUuid::createUuid();
+	directory.addComputer(location1, QStringLiteral("Computer"), QStringLiteral("10.0.0.1"), uid);
+	directory.addComputer(location2, QStringLiteral("Computer"), QStringLiteral("10.0.0.1"), uid);
+
+	const auto byUid = directory.queryObjects(NetworkObject::Type::Host, NetworkObject::Property::Uid, uid);
+	QCOMPARE(byUid.count(), 2);
+
+	const auto byAddress = directory.queryObjects(NetworkObject::Type::Host, NetworkObject::Property::HostAddress,
+												  QStringLiteral("10.0.0.1"));
+	QCOMPARE(byAddress.count(), 2);
+
+	QStringList locations;
+	for (const auto& computer : byAddress)
+	{
+		const auto parents = directory.queryParents(computer);
+		QCOMPARE(parents.count(), 1);
+		locations.append(parents.first().name());
+	}
+	locations.sort();
+	QCOMPARE(locations, QStringList({location1.name(), location2.name()}));
+
+	// removing one copy must keep the other one indexed
+	directory.replaceObjects({}, location1);
+	QCOMPARE(directory.childCount(location1.modelId()), 0);
+	QCOMPARE(directory.queryObjects(NetworkObject::Type::Host, NetworkObject::Property::Uid, uid).count(), 1);
+	QCOMPARE(directory.queryObjects(NetworkObject::Type::Host, NetworkObject::Property::HostAddress,
+									QStringLiteral("10.0.0.1")).count(), 1);
+}
+
+
+
+void NetworkObjectDirectoryTest::snapshotRoundTrip()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+
+	TestDirectory directory;
+	directory.populate(10, 20);
+	QVERIFY(directory.saveSnapshot(snapshotFileName(dir), Etag));
+
+	TestDirectory restoredDirectory;
+	QCOMPARE(restoredDirectory.loadSnapshot(snapshotFileName(dir), "other"), false);
+	QVERIFY(restoredDirectory.loadSnapshot(snapshotFileName(dir), Etag));
+
+	QCOMPARE(restoredDirectory.childCount(restoredDirectory.rootId()), 10);
+
+	const auto locations = restoredDirectory.objects(restoredDirectory.rootObject());
+	for (int l = 0; l < locations.count(); ++l)
+	{
+		QCOMPARE(restoredDirectory.childCount(locations[l].modelId()), 20);
+
+		// verify positions of restored objects have been indexed
+		const auto computers = restoredDirectory.objects(locations[l]);
+		for (int c = 0; c < computers.count(); ++c)
+		{
+			QCOMPARE(restoredDirectory.index(locations[l].modelId(), computers[c].modelId()), c);
+			QCOMPARE(restoredDirectory.parentId(computers[c].modelId()), locations[l].modelId());
+		}
+	}
+
+	const auto computers = restoredDirectory.queryObjects(NetworkObject::Type::Host,
+														  NetworkObject::Property::HostAddress,
+														  TestDirectory::hostAddress(5, 7));
+	QCOMPARE(computers.count(), 1);
+	QCOMPARE(computers.first().name(), QStringLiteral("Computer 7"));
+	QCOMPARE(restoredDirectory.queryParents(computers.first()).first().name(), QStringLiteral("Location 5"));
+}
+
+
+
+void NetworkObjectDirectoryTest::populate_data()
+{
+	QTest::addColumn<int>("locationCount");
+	QTest::addColumn<int>("computerCount");
+
+	QTest::newRow("10x30") << 10 << 30;
+	QTest::newRow("100x30") << 100 << 30;
+	QTest::newRow("10x1000") << 10 << 1000;
+	QTest::newRow("1000x30") << 1000 << 30;
+}
+
+
+
+void NetworkObjectDirectoryTest::populate()
+{
+	QFETCH(int, locationCount);
+	QFETCH(int, computerCount);
+
+	QBENCHMARK {
+		TestDirectory directory;
+		directory.populate(locationCount, computerCount);
+	}
+}
+
+
+
+void NetworkObjectDirectoryTest::loadSnapshot_data()
+{
+	populate_data();
+}
+
+
+
+void NetworkObjectDirectoryTest::loadSnapshot()
+{
+	QFETCH(int, locationCount);
+	QFETCH(int, computerCount);
+
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+
+	TestDirectory directory;
+	directory.populate(locationCount, computerCount);
+	QVERIFY(directory.saveSnapshot(snapshotFileName(dir), Etag));
+
+	// cold start of the Master with an empty directory
+	QBENCHMARK {
+		TestDirectory restoredDirectory;
+		restoredDirectory.loadSnapshot(snapshotFileName(dir), Etag);
+	}
+}
+
+
+
+void NetworkObjectDirectoryTest::lookup_data()
+{
+	QTest::addColumn<int>("locationCount");
+	QTest::addColumn<int>("computerCount");
+
+	// 20000 hosts each, as seen in large school districts
+	QTest::newRow("20x1000") << 20 << 1000;
+	QTest::newRow("200x100") << 200 << 100;
+	QTest::newRow("2000x10") << 2000 << 10;
+}
+
+
+
+void NetworkObjectDirectoryTest::lookupObject_data()
+{
+	lookup_data();
+}
+
+
+
+void NetworkObjectDirectoryTest::lookupObject()
+{
+	QFETCH(int, locationCount);
+	QFETCH(int, computerCount);
+
+	TestDirectory directory;
+	directory.populate(locationCount, computerCount);
+
+	const auto keys = sampleObjectKeys(directory, LookupSampleCount);
+	int validCount = 0;
+
+	QBENCHMARK {
+		validCount = 0;
+		for (const auto& key : keys)
+		{
+			validCount += directory.object(key.first, key.second).isValid() ? 1 : 0;
+		}
+	}
+
+	QCOMPARE(validCount, keys.count());
+}
+
+
+
+void NetworkObjectDirectoryTest::lookupChildObjects_data()
+{
+	lookup_data();
+}
+
+
+
+void NetworkObjectDirectoryTest::lookupChildObjects()
+{
+	QFETCH(int, locationCount);
+	QFETCH(int, computerCount);
+
+	TestDirectory directory;
+	directory.populate(locationCount, computerCount);
+
+	int childCount = 0;
+
+	// traverse the whole tree like a model does when populating views
+	QBENCHMARK {
+		childCount = 0;
+		const auto locations = directory.childCount(directory.rootId());
+		for (int l = 0; l < locations; ++l)
+		{
+			const auto locationId = directory.childId(directory.rootId(), l);
+			const auto computers = directory.childCount(locationId);
+			for (int c = 0; c < computers; ++c)
+			{
+				childCount += directory.childId(locationId, c) != 0 ? 1 : 0;
+			}
+		}
+	}
+
+	QCOMPARE(childCount, locationCount * computerCount);
+}
+
+
+
+void NetworkObjectDirectoryTest::lookupObjectIndex_data()
+{
+	lookup_data();
+}
+
+
+
+void NetworkObjectDirectoryTest::lookupObjectIndex()
+{
+	QFETCH(int, locationCount);
+	QFETCH(int, computerCount);
+
+	TestDirectory directory;
+	directory.populate(locationCount, computerCount);
+
+	const auto keys = sampleObjectKeys(directory, LookupSampleCount);
+	int validCount = 0;
+
+	QBENCHMARK {
+		validCount = 0;
+		for (const auto& key : keys)
+		{
+			validCount += directory.index(key.first, key.second) >= 0 ? 1 : 0;
+		}
+	}
+
+	QCOMPARE(validCount, keys.count());
+}
+
+
+
+void NetworkObjectDirectoryTest::lookupParent_data()
+{
+	lookup_data();
+}
+
+
+
+void NetworkObjectDirectoryTest::lookupParent()
+{
+	QFETCH(int, locationCount);
+	QFETCH(int, computerCount);
+
+	TestDirectory directory;
+	directory.populate(locationCount, computerCount);
+
+	const auto keys = sampleObjectKeys(directory, LookupSampleCount);
+	int matchCount = 0;
+
+	QBENCHMARK {
+		matchCount = 0;
+		for (const auto& key : keys)
+		{
+			matchCount += directory.parentId(key.second) == key.first ? 1 : 0;
+		}
+	}
+
+	QCOMPARE(matchCount, keys.count());
+}
+
+
+
+void NetworkObjectDirectoryTest::lookupHostAddress_data()
+{
+	lookup_data();
+}
+
+
+
+void NetworkObjectDirectoryTest::lookupHostAddress()
+{
+	QFETCH(int, locationCount);
+	QFETCH(int, computerCount);
+
+	TestDirectory directory;
+	directory.populate(locationCount, computerCount);
+
+	QStringList hostAddresses;
+	hostAddresses.reserve(LookupSampleCount);
+	for (int i = 0; i < LookupSampleCount; ++i)
+	{
+		const auto index = int(qint64(i) * locationCount * computerCount / LookupSampleCount);
+		hostAddresses.append(TestDirectory::hostAddress(index / computerCount, index % computerCount));
+	}
+
+	int foundCount = 0;
+
+	QBENCHMARK {
+		foundCount = 0;
+		for (const auto& hostAddress : std::as_const(hostAddresses))
+		{
+			foundCount += directory.queryObjects(NetworkObject::Type::Host, NetworkObject::Property::HostAddress,
+												 hostAddress).count();
+		}
+	}
+
+	QCOMPARE(foundCount, LookupSampleCount);
+}
+
+
+
+NetworkObjectDirectoryTest::ObjectKeys NetworkObjectDirectoryTest::sampleObjectKeys(const TestDirectory& directory,
+																					 int count)
+{
+	const auto& locations = directory.objects(directory.rootObject());
+
+	int totalCount = 0;
+	for (const auto& location : locations)
+	{
+		totalCount += directory.childCount(location.modelId());
+	}
+
+	// pick objects evenly distributed across all locations
+	ObjectKeys keys;
+	keys.reserve(count);
+
+	int index = 0;
+	int next = 0;
+	for (const auto& location : locations)
+	{
+		const auto& computers = directory.objects(location);
+		for (const auto& computer : computers)
+		{
+			if (index++ == next && keys.count() < count)
+			{
+				keys.append({location.modelId(), computer.modelId()});
+				next = int(qint64(keys.count()) * totalCount / count);
+			}
+		}
+	}
+
+	return keys;
+}
+
+
+
+QString NetworkObjectDirectoryTest::snapshotFileName(const QTemporaryDir& dir)
+{
+	return dir.filePath(QStringLiteral("snapshot.dat"));
+}
+
+
+QTEST_GUILESS_MAIN(NetworkObjectDirectoryTest)
+#include "main.moc"
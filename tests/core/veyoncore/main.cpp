@@ -0,0 +1,172 @@
+/*
+ * main.cpp - benchmarks for VeyonCore startup
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTest>
+
+#include "PlatformFilesystemFunctions.h"
+#include "PlatformPluginInterface.h"
+#include "VeyonCore.h"
+
+class VeyonCoreTest : public QObject
+{
+	Q_OBJECT
+private Q_SLOTS:
+	void initTestCase();
+
+	void identityReused();
+
+	void startup_data();
+	void startup();
+
+private:
+	void removeIdentity();
+	QByteArray readIdentityFile(const QString& fileName) const;
+
+	static QString privateKeyFileName()
+	{
+		return QStringLiteral("TlsHostPrivateKey.pem");
+	}
+
+	static QString certificateFileName()
+	{
+		return QStringLiteral("TlsHostCertificate.pem");
+	}
+
+	QString m_identityPath;
+
+};
+
+
+
+void VeyonCoreTest::initTestCase()
+{
+	// never touch the identity of the user running the tests
+	QStandardPaths::setTestModeEnabled(true);
+
+	VeyonCore core(QCoreApplication::instance(), VeyonCore::Component::CLI, QStringLiteral("Test"));
+
+	m_identityPath = VeyonCore::platform().filesystemFunctions().privateHostDataPath();
+	QVERIFY(m_identityPath.isEmpty() == false);
+
+	// create identity for subsequent processes
+	VeyonCore::tlsConfiguration();
+
+	QVERIFY(readIdentityFile(privateKeyFileName()).isEmpty() == false);
+	QVERIFY(readIdentityFile(certificateFileName()).isEmpty() == false);
+}
+
+
+
+void VeyonCoreTest::identityReused()
+{
+	const auto privateKey = readIdentityFile(privateKeyFileName());
+	const auto certificate = readIdentityFile(certificateFileName());
+
+	{
+		VeyonCore core(QCoreApplication::instance(), VeyonCore::Component::Server, QStringLiteral("Test"));
+		VeyonCore::tlsConfiguration();
+	}
+
+	QCOMPARE(readIdentityFile(privateKeyFileName()), privateKey);
+	QCOMPARE(readIdentityFile(certificateFileName()), certificate);
+}
+
+
+
+void VeyonCoreTest::startup_data()
+{
+	QTest::addColumn<VeyonCore::Component>("component");
+	QTest::addColumn<bool>("persistedIdentity");
+
+	const QVector<QPair<const char*, VeyonCore::Component>> components{
+		{ "service", VeyonCore::Component::Service },
+		{ "server", VeyonCore::Component::Server },
+		{ "worker", VeyonCore::Component::Worker },
+		{ "master", VeyonCore::Component::Master },
+		{ "cli", VeyonCore::Component::CLI },
+		{ "configurator", VeyonCore::Component::Configurator }
+	};
+
+	for (const auto& component : components)
+	{
+		QTest::addRow("%s, persisted identity", component.first) << component.second << true;
+		QTest::addRow("%s, new identity", component.first) << component.second << false;
+	}
+}
+
+
+
+void VeyonCoreTest::startup()
+{
+	QFETCH(VeyonCore::Component, component);
+	QFETCH(bool, persistedIdentity);
+
+	if (persistedIdentity == false &&
+		m_identityPath.startsWith(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)) == false)
+	{
+		QSKIP("identity is not stored in a test location (e.g. when running as root)");
+	}
+
+	// construct core and initialize the TLS configuration like the first TLS connection of a component would
+	QBENCHMARK {
+		if (persistedIdentity == false)
+		{
+			removeIdentity();
+		}
+
+		VeyonCore core(QCoreApplication::instance(), component, QStringLiteral("Test"));
+		VeyonCore::tlsConfiguration();
+	}
+
+	QVERIFY(readIdentityFile(privateKeyFileName()).isEmpty() == false);
+	QVERIFY(readIdentityFile(certificateFileName()).isEmpty() == false);
+}
+
+
+
+void VeyonCoreTest::removeIdentity()
+{
+	QFile::remove(QDir(m_identityPath).absoluteFilePath(privateKeyFileName()));
+	QFile::remove(QDir(m_identityPath).absoluteFilePath(certificateFileName()));
+}
+
+
+
+QByteArray VeyonCoreTest::readIdentityFile(const QString& fileName) const
+{
+	QFile file(QDir(m_identityPath).absoluteFilePath(fileName));
+	if (file.open(QFile::ReadOnly) == false)
+	{
+		return {};
+	}
+
+	return file.readAll();
+}
+
+
+QTEST_GUILESS_MAIN(VeyonCoreTest)
+#include "main.moc"
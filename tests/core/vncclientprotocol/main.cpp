@@ -0,0 +1,238 @@
+/*
+ * main.cpp - benchmark for VncClientProtocol
+ *
+ * Copyright (c) 2024 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QBuffer>
+#include <QtEndian>
+#include <QTest>
+
+#include "VncClientProtocol.h"
+
+class VncClientProtocolTest : public VncClientProtocol
+{
+public:
+	VncClientProtocolTest(QIODevice* socket) :
+		VncClientProtocol(socket, {})
+	{
+	}
+
+	void init(char state)
+	{
+		setState(State(state));
+	}
+
+};
+
+
+class VncClientProtocolBenchmark : public QObject
+{
+	Q_OBJECT
+private Q_SLOTS:
+	void initTestCase();
+	void cleanupTestCase();
+
+	void receiveFramebufferUpdate_data();
+	void receiveFramebufferUpdate();
+
+private:
+	static constexpr int FramebufferWidth = 1024;
+	static constexpr int FramebufferHeight = 768;
+	static constexpr int BytesPerPixel = 4;
+
+	static QByteArray serverInitMessage();
+	static QByteArray framebufferUpdateMessage();
+	static void appendRectHeader(QByteArray& message, int x, int y, int w, int h, int32_t encoding);
+
+	// feeds data in segments of given size like it arrives from a socket and returns number of
+	// received messages
+	static int feed(VncClientProtocolTest& protocol, QBuffer& buffer, const QByteArray& data, int segmentSize);
+
+	VeyonCore* m_core{nullptr};
+
+};
+
+
+
+void VncClientProtocolBenchmark::initTestCase()
+{
+	m_core = new VeyonCore(QCoreApplication::instance(), VeyonCore::Component::CLI, QStringLiteral("Test"));
+}
+
+
+
+void VncClientProtocolBenchmark::cleanupTestCase()
+{
+	delete m_core;
+}
+
+
+
+void VncClientProtocolBenchmark::receiveFramebufferUpdate_data()
+{
+	QTest::addColumn<int>("segmentSize");
+
+	QTest::newRow("complete") << 0;
+	QTest::newRow("64 KiB") << 64*1024;
+	QTest::newRow("MSS") << 1448;
+	QTest::newRow("64 bytes") << 64;
+}
+
+
+
+void VncClientProtocolBenchmark::receiveFramebufferUpdate()
+{
+	QFETCH(int, segmentSize);
+
+	const auto message = framebufferUpdateMessage();
+
+	QBuffer buffer;
+	buffer.open(QIODevice::ReadWrite);
+
+	VncClientProtocolTest protocol(&buffer);
+	protocol.init(char(VncClientProtocol::State::FramebufferInit));
+
+	buffer.write(serverInitMessage());
+	buffer.seek(0);
+	QVERIFY(protocol.read());
+	QCOMPARE(protocol.state(), VncClientProtocol::State::Running);
+
+	// segmented data has to result in exactly the same message as complete data
+	QCOMPARE(feed(protocol, buffer, message, segmentSize), 1);
+	QCOMPARE(protocol.lastMessage(), message);
+	QCOMPARE(protocol.lastUpdatedRect(), QRect(0, 0, FramebufferWidth, FramebufferHeight));
+
+	QBENCHMARK {
+		feed(protocol, buffer, message, segmentSize);
+	}
+}
+
+
+
+QByteArray VncClientProtocolBenchmark::serverInitMessage()
+{
+	rfbServerInitMsg message{};
+	message.framebufferWidth = qToBigEndian<uint16_t>(FramebufferWidth);
+	message.framebufferHeight = qToBigEndian<uint16_t>(FramebufferHeight);
+	message.format.bitsPerPixel = BytesPerPixel * 8;
+	message.format.depth = 24;
+	message.format.trueColour = 1;
+	message.format.redMax = qToBigEndian<uint16_t>(255);
+	message.format.greenMax = qToBigEndian<uint16_t>(255);
+	message.format.blueMax = qToBigEndian<uint16_t>(255);
+	message.format.redShift = 16;
+	message.format.greenShift = 8;
+	message.format.blueShift = 0;
+	message.nameLength = 0;
+
+	return QByteArray(reinterpret_cast<const char *>(&message), sz_rfbServerInitMsg);
+}
+
+
+
+QByteArray VncClientProtocolBenchmark::framebufferUpdateMessage()
+{
+	static constexpr int RectSize = 64;
+	static constexpr int HextileAreaWidth = 256;
+	static constexpr int TileSize = 16;
+
+	const auto rawRectCount = ((FramebufferWidth - HextileAreaWidth) / RectSize) * (FramebufferHeight / RectSize);
+	const auto hextileRectCount = FramebufferHeight / HextileAreaWidth;
+
+	QByteArray message;
+
+	rfbFramebufferUpdateMsg header{};
+	header.type = rfbFramebufferUpdate;
+	header.nRects = qToBigEndian<uint16_t>(rawRectCount + hextileRectCount);
+	message.append(reinterpret_cast<const char *>(&header), sz_rfbFramebufferUpdateMsg);
+
+	for (int y = 0; y < FramebufferHeight; y += RectSize)
+	{
+		for (int x = 0; x < FramebufferWidth - HextileAreaWidth; x += RectSize)
+		{
+			appendRectHeader(message, x, y, RectSize, RectSize, rfbEncodingRaw);
+			message.append(QByteArray(RectSize * RectSize * BytesPerPixel, char(x ^ y)));
+		}
+	}
+
+	// hextile rects consisting of raw tiles to exercise resuming within rects
+	for (int y = 0; y < FramebufferHeight; y += HextileAreaWidth)
+	{
+		appendRectHeader(message, FramebufferWidth - HextileAreaWidth, y, HextileAreaWidth, HextileAreaWidth, rfbEncodingHextile);
+		for (int tile = 0; tile < (HextileAreaWidth / TileSize) * (HextileAreaWidth / TileSize); ++tile)
+		{
+			message.append(char(rfbHextileRaw));
+			message.append(QByteArray(TileSize * TileSize * BytesPerPixel, char(tile)));
+		}
+	}
+
+	return message;
+}
+
+
+
+void VncClientProtocolBenchmark::appendRectHeader(QByteArray& message, int x, int y, int w, int h, int32_t encoding)
+{
+	rfbFramebufferUpdateRectHeader rectHeader{};
+	rectHeader.r.x = qToBigEndian<uint16_t>(x);
+	rectHeader.r.y = qToBigEndian<uint16_t>(y);
+	rectHeader.r.w = qToBigEndian<uint16_t>(w);
+	rectHeader.r.h = qToBigEndian<uint16_t>(h);
+	rectHeader.encoding = qToBigEndian<uint32_t>(encoding);
+
+	message.append(reinterpret_cast<const char *>(&rectHeader), sz_rfbFramebufferUpdateRectHeader);
+}
+
+
+
+int VncClientProtocolBenchmark::feed(VncClientProtocolTest& protocol, QBuffer& buffer, const QByteArray& data, int segmentSize)
+{
+	if (segmentSize <= 0)
+	{
+		segmentSize = data.size();
+	}
+
+	// start with an empty buffer so repeated runs don't accumulate data
+	buffer.close();
+	buffer.setData({});
+	buffer.open(QIODevice::ReadWrite);
+
+	int messageCount = 0;
+
+	for (int offset = 0; offset < data.size(); offset += segmentSize)
+	{
+		const auto pos = buffer.pos();
+		buffer.write(data.constData() + offset, qMin(segmentSize, data.size() - offset));
+		buffer.seek(pos);
+
+		while (protocol.receiveMessage())
+		{
+			++messageCount;
+		}
+	}
+
+	return messageCount;
+}
+
+
+QTEST_GUILESS_MAIN(VncClientProtocolBenchmark)
+#include "main.moc"
@@ -30,21 +30,43 @@ extern "C" int LLVMFuzzerTestOneInput(const char *data, size_t size)
 
 	VncClientProtocolTest protocol(&buffer);
 
-	const auto mode = data[0];
+	static constexpr uint8_t SegmentedFeedingFlag = 0x80;
+
+	const auto mode = uint8_t(data[0]);
 	const auto state = data[1];
 
 	protocol.init(state);
 
-	buffer.write(QByteArray::fromRawData(data+2, size-2));
-	buffer.seek(0);
+	const auto payload = QByteArray::fromRawData(data+2, int(size-2));
 
-	if(mode)
+	if(mode & SegmentedFeedingFlag)
 	{
-		protocol.read();
+		// feed data in segments to exercise resuming partially parsed messages
+		const auto segmentSize = int(mode & ~SegmentedFeedingFlag) + 1;
+		for(int offset = 0; offset < payload.size() && buffer.isOpen(); offset += segmentSize)
+		{
+			const auto pos = buffer.pos();
+			buffer.write(payload.mid(offset, segmentSize));
+			buffer.seek(pos);
+
+			while(protocol.receiveMessage())
+			{
+			}
+		}
 	}
 	else
 	{
-		protocol.receiveMessage();
+		buffer.write(payload);
+		buffer.seek(0);
+
+		if(mode)
+		{
+			protocol.read();
+		}
+		else
+		{
+			protocol.receiveMessage();
+		}
 	}
 
 	return 0;
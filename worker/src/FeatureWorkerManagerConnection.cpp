@@ -25,33 +25,70 @@
 #include <QCoreApplication>
 #include <QHostAddress>
 
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
 #include "FeatureManager.h"
+#include "FeatureWorkerManager.h"
 #include "FeatureWorkerManagerConnection.h"
 #include "VeyonConfiguration.h"
 
 
 FeatureWorkerManagerConnection::FeatureWorkerManagerConnection( VeyonWorkerInterface& worker,
 																Feature::Uid featureUid,
+																const QString& idleWorkerToken,
 																QObject* parent ) :
 	QObject( parent ),
 	m_worker( worker ),
 	m_port(VeyonCore::config().featureWorkerManagerPort() + VeyonCore::sessionId()),
-	m_socket( this ),
-	m_featureUid( featureUid )
+	m_useLocalSocket( FeatureWorkerManager::isLocalSocketEnabled() ),
+	m_localSocket( this ),
+	m_tcpSocket( this ),
+	m_featureUid( featureUid ),
+	m_idleWorkerToken( idleWorkerToken )
 {
 	connect( &m_connectTimer, &QTimer::timeout, this, &FeatureWorkerManagerConnection::tryConnection );
 
-	connect( &m_socket, &QTcpSocket::connected,
+	connect( &m_localSocket, &QLocalSocket::connected, this, [this]() {
+		// the name of the local socket could have been taken by another user before
+		// FeatureWorkerManager was started
+		if( isTrustedLocalServer() == false )
+		{
+			vWarning() << "local socket not owned by FeatureWorkerManager, falling back to TCP";
+			m_useLocalSocket = false;
+			m_localSocket.abort();
+			tryConnection();
+			return;
+		}
+		sendInitMessage();
+	} );
+	connect( &m_tcpSocket, &QTcpSocket::connected,
 			 this, &FeatureWorkerManagerConnection::sendInitMessage );
 
-	connect(&m_socket, &QTcpSocket::disconnected, this,
-			[=]() {
-		vDebug() << "lost connection to FeatureWorkerManager – exiting";
-		QCoreApplication::instance()->exit(0);
-	}, Qt::QueuedConnection);
+	// ignore the local socket once we've fallen back to TCP
+	connect( &m_localSocket, &QLocalSocket::disconnected, this, [this]() {
+		if( m_useLocalSocket )
+		{
+			exitAfterDisconnect();
+		}
+	}, Qt::QueuedConnection );
+	connect( &m_tcpSocket, &QTcpSocket::disconnected, this, [this]() {
+		if( m_useLocalSocket == false )
+		{
+			exitAfterDisconnect();
+		}
+	}, Qt::QueuedConnection );
 
-	connect( &m_socket, &QTcpSocket::readyRead,
+	connect( &m_localSocket, &QLocalSocket::readyRead,
 			 this, &FeatureWorkerManagerConnection::receiveMessage );
+	connect( &m_tcpSocket, &QTcpSocket::readyRead,
+			 this, &FeatureWorkerManagerConnection::receiveMessage );
+
+#if defined(Q_OS_LINUX) && QT_VERSION >= QT_VERSION_CHECK(6, 2, 0)
+	m_localSocket.setSocketOptions( FeatureWorkerManager::LocalSocketOptions );
+#endif
 
 	tryConnection();
 }
@@ -62,20 +99,83 @@ bool FeatureWorkerManagerConnection::sendMessage( const FeatureMessage& message
 {
 	vDebug() << message;
 
-	return message.send( &m_socket );
+	return message.send( socket() );
+}
+
+
+
+void FeatureWorkerManagerConnection::setFeatureUid( Feature::Uid featureUid )
+{
+	const auto wasIdle = m_featureUid.isNull();
+
+	m_featureUid = featureUid;
+
+	// let FeatureWorkerManager know we're now serving the assigned feature
+	if( wasIdle && isConnected() )
+	{
+		sendInitMessage();
+	}
+}
+
+
+
+bool FeatureWorkerManagerConnection::isConnected() const
+{
+	return m_useLocalSocket ? m_localSocket.state() == QLocalSocket::ConnectedState :
+							  m_tcpSocket.state() == QTcpSocket::ConnectedState;
+}
+
+
+
+bool FeatureWorkerManagerConnection::isTrustedLocalServer()
+{
+#ifdef Q_OS_LINUX
+	struct ucred credentials{};
+	socklen_t length = sizeof(credentials);
+	if( getsockopt( int( m_localSocket.socketDescriptor() ), SOL_SOCKET, SO_PEERCRED, &credentials, &length ) != 0 )
+	{
+		return false;
+	}
+
+	// FeatureWorkerManager runs as root when started by the service
+	return credentials.uid == 0 || credentials.uid == getuid();
+#else
+	return true;
+#endif
 }
 
 
 
 void FeatureWorkerManagerConnection::tryConnection()
 {
-	if( m_socket.state() != QTcpSocket::ConnectedState )
+	if( isConnected() )
+	{
+		return;
+	}
+
+	if( m_useLocalSocket )
+	{
+		vDebug() << "connecting to FeatureWorkerManager at" << FeatureWorkerManager::localServerName();
+
+		m_localSocket.connectToServer( FeatureWorkerManager::localServerName() );
+
+		// connection attempts to local sockets fail immediately e.g. if the server
+		// has disabled the local socket or is too old - fall back to TCP then
+		if( m_localSocket.state() == QLocalSocket::UnconnectedState )
+		{
+			vDebug() << "local socket not available, falling back to TCP:" << m_localSocket.errorString();
+			m_useLocalSocket = false;
+		}
+	}
+
+	if( m_useLocalSocket == false )
 	{
 		vDebug() << "connecting to FeatureWorkerManager at port" << m_port;
 
-		m_socket.connectToHost(QHostAddress::LocalHost, m_port);
-		m_connectTimer.start(ConnectTimeout);
+		m_tcpSocket.connectToHost(QHostAddress::LocalHost, m_port);
 	}
+
+	m_connectTimer.start(ConnectTimeout);
 }
 
 
@@ -86,20 +186,46 @@ void FeatureWorkerManagerConnection::sendInitMessage()
 
 	m_connectTimer.stop();
 
-	FeatureMessage( m_featureUid, FeatureMessage::InitCommand ).send( &m_socket );
+	FeatureMessage message( m_featureUid, FeatureMessage::InitCommand );
+
+	// idle workers are identified through the token they've been started with and their process ID
+	if( m_featureUid.isNull() )
+	{
+		message.addArgument( FeatureWorkerManager::Argument::ProcessId, QCoreApplication::applicationPid() );
+		message.addArgument( FeatureWorkerManager::Argument::IdleWorkerToken, m_idleWorkerToken );
+	}
+
+	message.send( socket() );
 }
 
 
 
 void FeatureWorkerManagerConnection::receiveMessage()
 {
-	FeatureMessage featureMessage;
-
-	while( featureMessage.isReadyForReceive( &m_socket ) )
-	{
-		if( featureMessage.receive( &m_socket ) )
+	const auto success = FeatureMessage::receiveAll( socket(), [this]( const FeatureMessage& featureMessage ) {
+		if( m_featureUid.isNull() )
 		{
-			VeyonCore::featureManager().handleFeatureMessage( m_worker, featureMessage );
+			if( featureMessage.command() == FeatureMessage::AssignFeatureCommand )
+			{
+				// handled synchronously so that subsequent messages already get processed by the assigned feature
+				Q_EMIT featureAssigned( featureMessage.argument( FeatureWorkerManager::Argument::FeatureUid ).toUuid() );
+			}
+			return;
 		}
+
+		VeyonCore::featureManager().handleFeatureMessage( m_worker, featureMessage );
+	} );
+
+	if( success == false )
+	{
+		vWarning() << "received invalid message from FeatureWorkerManager";
 	}
 }
+
+
+
+void FeatureWorkerManagerConnection::exitAfterDisconnect()
+{
+	vDebug() << "lost connection to FeatureWorkerManager – exiting";
+	QCoreApplication::instance()->exit(0);
+}
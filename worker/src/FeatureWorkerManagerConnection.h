@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <QLocalSocket>
 #include <QTcpSocket>
 #include <QTimer>
 
@@ -39,22 +40,40 @@ class FeatureWorkerManagerConnection : public QObject
 public:
 	FeatureWorkerManagerConnection( VeyonWorkerInterface& worker,
 									Feature::Uid featureUid,
+									const QString& idleWorkerToken,
 									QObject* parent = nullptr );
 
 
 	bool sendMessage( const FeatureMessage& message );
 
+	void setFeatureUid( Feature::Uid featureUid );
+
+Q_SIGNALS:
+	void featureAssigned( Feature::Uid featureUid );
+
 private:
 	static constexpr auto ConnectTimeout = 3000;
 
+	QIODevice* socket()
+	{
+		return m_useLocalSocket ? static_cast<QIODevice *>( &m_localSocket ) : &m_tcpSocket;
+	}
+
+	bool isConnected() const;
+	bool isTrustedLocalServer();
+
 	void tryConnection();
 	void sendInitMessage();
 	void receiveMessage();
+	void exitAfterDisconnect();
 
 	VeyonWorkerInterface& m_worker;
 	const int m_port;
-	QTcpSocket m_socket;
+	bool m_useLocalSocket;
+	QLocalSocket m_localSocket;
+	QTcpSocket m_tcpSocket;
 	Feature::Uid m_featureUid;
+	const QString m_idleWorkerToken;
 	QTimer m_connectTimer{this};
 
 } ;
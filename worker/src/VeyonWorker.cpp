@@ -30,35 +30,32 @@
 #include "VeyonWorker.h"
 
 
-VeyonWorker::VeyonWorker( QUuid featureUid, QObject* parent ) :
+VeyonWorker::VeyonWorker( QUuid featureUid, const QString& idleWorkerToken, QObject* parent ) :
 	QObject( parent ),
 	m_core( QCoreApplication::instance(),
 			VeyonCore::Component::Worker,
-			QStringLiteral( "FeatureWorker-" ) + VeyonCore::formattedUuid( featureUid ) )
+			featureUid.isNull() ? QStringLiteral( "FeatureWorker" ) :
+								  QStringLiteral( "FeatureWorker-" ) + VeyonCore::formattedUuid( featureUid ) )
 {
-	const Feature* workerFeature = nullptr;
-
-	for( const auto& feature : VeyonCore::featureManager().features() )
+	if( featureUid.isNull() == false && assignFeature( featureUid ) == false )
 	{
-		if( feature.uid() == featureUid )
-		{
-			workerFeature = &feature;
-		}
+		qFatal( "Could not run worker for specified feature" );
 	}
 
-	if( workerFeature == nullptr )
-	{
-		qFatal( "Could not find specified feature" );
-	}
+	m_workerManagerConnection = new FeatureWorkerManagerConnection(*this, featureUid, idleWorkerToken);
 
-	if( VeyonCore::config().disabledFeatures().contains( featureUid.toString() ) )
+	connect( m_workerManagerConnection, &FeatureWorkerManagerConnection::featureAssigned, this,
+			 [this]( Feature::Uid assignedFeatureUid ) {
+				 if( assignFeature( assignedFeatureUid ) == false )
+				 {
+					 QCoreApplication::exit( 1 );
+				 }
+			 } );
+
+	if( featureUid.isNull() )
 	{
-		qFatal( "Specified feature is disabled by configuration!" );
+		vInfo() << "Running idle worker";
 	}
-
-	m_workerManagerConnection = new FeatureWorkerManagerConnection(*this, featureUid);
-
-	vInfo() << "Running worker for feature" << workerFeature->name();
 }
 
 
@@ -80,3 +77,31 @@ bool VeyonWorker::sendFeatureMessageReply( const FeatureMessage& reply )
 	return m_workerManagerConnection &&
 			m_workerManagerConnection->sendMessage( reply );
 }
+
+
+
+bool VeyonWorker::assignFeature( Feature::Uid featureUid )
+{
+	const auto& workerFeature = VeyonCore::featureManager().feature( featureUid );
+
+	if( featureUid.isNull() || workerFeature.uid() != featureUid )
+	{
+		vCritical() << "Could not find specified feature" << featureUid;
+		return false;
+	}
+
+	if( VeyonCore::config().disabledFeatures().contains( featureUid.toString() ) )
+	{
+		vCritical() << "Specified feature is disabled by configuration!";
+		return false;
+	}
+
+	if( m_workerManagerConnection )
+	{
+		m_workerManagerConnection->setFeatureUid( featureUid );
+	}
+
+	vInfo() << "Running worker for feature" << workerFeature.name();
+
+	return true;
+}
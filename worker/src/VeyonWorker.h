@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include "Feature.h"
 #include "VeyonCore.h"
 #include "VeyonWorkerInterface.h"
 
@@ -33,11 +34,13 @@ class VeyonWorker : public QObject, VeyonWorkerInterface
 {
 	Q_OBJECT
 public:
-	explicit VeyonWorker( QUuid featureUid, QObject* parent = nullptr );
+	VeyonWorker( QUuid featureUid, const QString& idleWorkerToken, QObject* parent = nullptr );
 	~VeyonWorker() override;
 
 	bool sendFeatureMessageReply( const FeatureMessage& reply ) override;
 
+	bool assignFeature( Feature::Uid featureUid );
+
 	VeyonCore& core()
 	{
 		return m_core;
@@ -26,6 +26,7 @@
 #include <QIcon>
 
 #include "Feature.h"
+#include "FeatureWorkerManager.h"
 #include "VeyonWorker.h"
 
 
@@ -43,13 +44,23 @@ int main( int argc, char **argv )
 		qFatal( "Not enough arguments (feature)" );
 	}
 
+	// idle workers are started without a feature and get one assigned later on
+	const auto isIdleWorker = arguments[1] == FeatureWorkerManager::idleWorkerArgument();
+
 	const auto featureUid = Feature::Uid{arguments[1]};
-	if( featureUid.isNull() )
+	if( featureUid.isNull() && isIdleWorker == false )
 	{
 		qFatal( "Invalid feature UID given" );
 	}
 
-	VeyonWorker worker( featureUid );
+	// idle workers have to present the token they've been started with when registering - don't pass
+	// it on to any programs started by the worker
+	const auto idleWorkerToken = isIdleWorker ?
+									 qEnvironmentVariable( FeatureWorkerManager::IdleWorkerTokenEnvironmentVariable ) :
+									 QString{};
+	qunsetenv( FeatureWorkerManager::IdleWorkerTokenEnvironmentVariable );
+
+	VeyonWorker worker( featureUid, idleWorkerToken );
 
 	return worker.core().exec();
 }